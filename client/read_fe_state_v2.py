@@ -2,7 +2,11 @@
 """
 Read front-end state via EnvelopeV2 without changing configuration.
 
-Queries:
+By default the whole state comes back from one MT2_READ_FULL_FE_STATE_REQ
+(consistent snapshot, AFE register shadow included). --per-field falls back to
+the individual read requests below, for servers without it.
+
+Per-field queries:
   - All channel trims
   - All channel offsets
   - AFE VGAIN (attenuators) per AFE
@@ -86,6 +90,7 @@ def parse_args() -> argparse.Namespace:
     ap.add_argument("--afe-count", type=int, default=5, help="Number of AFEs to query (default 5)")
     ap.add_argument("--skip-bias-monitor", action="store_true", help="Skip bias voltage monitor reads")
     ap.add_argument("--json", action="store_true", help="Emit the FE state snapshot as JSON only")
+    ap.add_argument("--per-field", action="store_true", help="Use one request per value instead of MT2_READ_FULL_FE_STATE_REQ")
     ap.add_argument("--afe-reg", nargs=2, action="append", metavar=("AFE", "REG"), help="Read specific AFE register (board index, reg addr). Can be repeated.")
     return ap.parse_args()
 
@@ -110,6 +115,48 @@ def do_op(
     return resp
 
 
+def read_full(sock: zmq.Socket, args: argparse.Namespace, *, verbose: bool = True) -> dict:
+    resp = do_op(
+        sock,
+        pb_high.ReadFullFeStateRequest(),
+        pb_high.MT2_READ_FULL_FE_STATE_REQ,
+        pb_high.MT2_READ_FULL_FE_STATE_RESP,
+        pb_high.ReadFullFeStateResponse,
+        "READ_FULL_FE_STATE",
+        verbose=verbose,
+    )
+    if not resp.success:
+        raise RuntimeError(f"READ_FULL_FE_STATE failed: {resp.message}")
+
+    afe_ids = list(range(min(args.afe_count, len(resp.attenuations))))
+    config = {
+        "sequence": resp.sequence,
+        "channel_analog_conf": {
+            "ids": list(range(40)),
+            "gains": [1] * 40,
+            "offsets": list(resp.offsets),
+            "trims": list(resp.trims),
+        },
+        "afes": {
+            "ids": afe_ids,
+            "attenuators": [resp.attenuations[a] for a in afe_ids],
+            "v_biases": [resp.bias_voltages[a] for a in afe_ids],
+            "bias_monitors_mV": [
+                None if args.skip_bias_monitor else round(resp.bias_monitor_v[a] * 1000.0) for a in afe_ids
+            ],
+        },
+        "bias_ctrl": resp.bias_control,
+        "afe_registers": {
+            str(image.afe): {f"0x{reg:02X}": val for reg, val in zip(image.registers, image.values)}
+            for image in resp.afe_registers
+        },
+    }
+    if verbose:
+        print("\n=== FE STATE SNAPSHOT (read-only) ===")
+        print(json.dumps(config, indent=2))
+    return config
+
+
 def read_all(sock: zmq.Socket, args: argparse.Namespace, *, verbose: bool = True) -> dict:
     # Trims (all channels)
     trim_all = do_op(
@@ -249,6 +296,9 @@ if __name__ == "__main__":
 
     if not args.json:
         print(f"Connected to {endpoint} route={args.route}")
-    snapshot = read_all(sock, args, verbose=(not args.json))
+    if args.per_field or args.afe_reg:
+        snapshot = read_all(sock, args, verbose=(not args.json))
+    else:
+        snapshot = read_full(sock, args, verbose=(not args.json))
     if args.json:
         print(json.dumps(snapshot, indent=2, sort_keys=True))
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+import argparse
+import os
+import sys
+import time
+import zmq
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), '..')))
+from srcs.protobuf import daphneV3_high_level_confs_pb2 as pb_high
+
+
+TOPICS = {
+    b"rails": pb_high.TelemetryRails,
+    b"vbias": pb_high.TelemetryVbias,
+    b"hdmezz": pb_high.TelemetryHDMezz,
+    b"triggers": pb_high.TelemetryTriggers,
+}
+
+
+def describe(topic, msg):
+    if topic == b"rails":
+        return (f"3V3PDS={msg.v_3v3pds:.3f} 1V8PDS={msg.v_1v8pds:.3f} 3V3A={msg.v_3v3a:.3f} "
+                f"1V8A={msg.v_1v8a:.3f} -5VA={msg.v_n5va:.3f}")
+    if topic == b"vbias":
+        return " ".join(f"AFE{afe}={v:.3f}" for afe, v in enumerate(msg.v_bias))
+    if topic == b"hdmezz":
+        parts = []
+        for r in msg.hdmezz:
+            if not r.enabled:
+                continue
+            alert = " ALERT" if (r.alert_5v or r.alert_3v3) else ""
+            parts.append(f"AFE{r.afe} 5V={r.voltage_5v:.3f}V/{r.current_5v:.3f}A "
+                         f"3V3={r.voltage_3v3:.3f}V/{r.current_3v3:.3f}A{alert}")
+        return "; ".join(parts) if parts else "no enabled blocks"
+    if topic == b"triggers":
+        total = sum(msg.record_rate_hz)
+        busiest = max(range(len(msg.record_rate_hz)), key=lambda ch: msg.record_rate_hz[ch], default=0)
+        return (f"total={total:.1f} Hz busiest=ch{busiest} "
+                f"({msg.record_rate_hz[busiest] if msg.record_rate_hz else 0.0:.1f} Hz)")
+    return ""
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Print the monitoring telemetry published by daphneServer.")
+    ap.add_argument("--ip", default="127.0.0.1", help="Server IP (default 127.0.0.1)")
+    ap.add_argument("--port", type=int, default=9877, help="Telemetry port (--telemetry-bind, default 9877)")
+    ap.add_argument("--topics", default="rails,vbias,hdmezz,triggers",
+                    help="Comma-separated topics to subscribe to")
+    args = ap.parse_args()
+
+    ctx = zmq.Context()
+    sock = ctx.socket(zmq.SUB)
+    sock.connect(f"tcp://{args.ip}:{args.port}")
+    for topic in args.topics.split(','):
+        topic = topic.strip().encode()
+        if topic not in TOPICS:
+            ap.error(f"unknown topic {topic.decode()!r}")
+        sock.setsockopt(zmq.SUBSCRIBE, topic)
+
+    last_sequence = {}
+    try:
+        while True:
+            frames = sock.recv_multipart()
+            if len(frames) != 2:
+                continue
+            topic, payload = frames
+            # Subscriptions match prefixes; keep only exact topics.
+            if topic not in TOPICS:
+                continue
+            msg = TOPICS[topic]()
+            msg.ParseFromString(payload)
+            gap = ""
+            previous = last_sequence.get(topic)
+            if previous is not None and msg.sequence <= previous:
+                gap = " (server restarted)"
+            elif previous is not None and msg.sequence != previous + 1:
+                gap = f" (missed {msg.sequence - previous - 1})"
+            last_sequence[topic] = msg.sequence
+            stamp = time.strftime("%H:%M:%S", time.localtime(msg.timestamp_ns / 1e9))
+            print(f"{stamp} {topic.decode():8s} #{msg.sequence}{gap} {describe(topic, msg)}", flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close(0)
+        ctx.term()
+
+
+if __name__ == "__main__":
+    main()
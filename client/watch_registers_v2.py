@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+Watch FPGA register fields via MT2_WATCH_REGISTERS_REQ instead of polling them.
+
+The server polls the fields and sends only changes (and periodic keepalives).
+Fields are given as REG or REG.FIELD with an optional deadband, e.g.
+
+  watch_registers_v2.py endpointStatus.FSM_STATUS endpointClockStatus \
+      frontendStatus.DELAYCTRL_READY fanReadSpeed_0.SPEED:20
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import sys
+import time
+
+import zmq
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), '..')))
+
+from configure_fe_min_v2 import next_ids, ns_to_iso  # type: ignore
+from srcs.protobuf import daphneV3_high_level_confs_pb2 as pb_high
+
+
+def build_envelope(payload: bytes, msg_type: int) -> pb_high.ControlEnvelopeV2:
+    env = pb_high.ControlEnvelopeV2()
+    env.version = 2
+    env.dir = pb_high.DIR_REQUEST
+    env.type = msg_type
+    env.payload = payload
+    env.task_id, env.msg_id = next_ids()
+    env.timestamp_ns = time.time_ns()
+    return env
+
+
+def parse_field(spec: str) -> pb_high.WatchedField:
+    field = pb_high.WatchedField()
+    spec, _, deadband = spec.partition(":")
+    field.reg, _, field.field = spec.partition(".")
+    if deadband:
+        field.deadband = int(deadband, 0)
+    return field
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Watch register fields (V2, on-change notifications).")
+    ap.add_argument("fields", nargs="+", help="REG or REG.FIELD, optionally :DEADBAND")
+    ap.add_argument("--ip", default="127.0.0.1", help="Server IP (default 127.0.0.1)")
+    ap.add_argument("--port", type=int, default=9876, help="Server port (default 9876)")
+    ap.add_argument("--period-ms", type=int, default=100, help="Server poll period (default 100 ms)")
+    ap.add_argument("--keepalive-ms", type=int, default=10000, help="Keepalive period (default 10 s)")
+    ap.add_argument("--hex", action="store_true", help="Print values in hex")
+    args = ap.parse_args()
+
+    req = pb_high.WatchRegistersRequest()
+    for spec in args.fields:
+        req.fields.append(parse_field(spec))
+    req.period_ms = args.period_ms
+    req.keepalive_ms = args.keepalive_ms
+    names = [f.reg + ("." + f.field if f.field else "") for f in req.fields]
+
+    ctx = zmq.Context()
+    sock = ctx.socket(zmq.DEALER)
+    sock.setsockopt(zmq.LINGER, 0)
+    sock.connect(f"tcp://{args.ip}:{args.port}")
+    env = build_envelope(req.SerializeToString(), pb_high.MT2_WATCH_REGISTERS_REQ)
+    sock.send(env.SerializeToString())
+
+    # Keepalives arrive every keepalive period; missing several means the server is gone.
+    poller = zmq.Poller()
+    poller.register(sock, zmq.POLLIN)
+    timeout_ms = 3 * args.keepalive_ms
+    subscription_id = 0
+    try:
+        while True:
+            if not poller.poll(timeout_ms):
+                print(f"No message for {timeout_ms} ms; giving up.", file=sys.stderr)
+                return 1
+            rep = pb_high.ControlEnvelopeV2()
+            rep.ParseFromString(sock.recv_multipart()[-1])
+            if rep.type != pb_high.MT2_WATCH_REGISTERS_RESP or rep.correl_id != env.msg_id:
+                continue
+            resp = pb_high.WatchRegistersResponse()
+            resp.ParseFromString(rep.payload)
+            if not resp.success:
+                print(f"Watch failed: {resp.message}", file=sys.stderr)
+                return 1
+            if not subscription_id:
+                subscription_id = resp.subscription_id
+                print(resp.message)
+            for v in resp.values:
+                value = f"0x{v.value:08X}" if args.hex else str(v.value)
+                print(f"{ns_to_iso(v.timestamp_ns)} {names[v.index]} = {value}", flush=True)
+            if resp.is_final:
+                print(resp.message)
+                return 0
+    except KeyboardInterrupt:
+        if subscription_id:
+            unwatch = pb_high.UnwatchRegistersRequest(subscription_id=subscription_id)
+            sock.send(build_envelope(unwatch.SerializeToString(), pb_high.MT2_UNWATCH_REGISTERS_REQ).SerializeToString())
+        return 0
+    finally:
+        sock.close(0)
+        ctx.term()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -7,6 +7,9 @@ Afe::~Afe(){}
 
 uint32_t Afe::setReset(const uint32_t& reset){
 
+	if(reset){
+		this->invalidateShadow();
+	}
 	uint32_t value = this->spi->getFpgaReg()->setBits("afeGlobalControl", "RESET", reset);
 	return value;
 }
@@ -21,6 +24,7 @@ uint32_t Afe::doReset(){
 
 uint32_t Afe::setPowerState(const uint32_t& powerstate){
 
+	this->invalidateShadow();
 	uint32_t value = this->spi->getFpgaReg()->setBits("afeGlobalControl", "POWERSTATE", powerstate);
 	std::this_thread::sleep_for(std::chrono::microseconds(5000));
 	return value;
@@ -33,18 +37,14 @@ uint32_t Afe::getPowerState(){
 
 uint32_t Afe::setRegister(const uint32_t& afe, const uint32_t& register_, const uint32_t& value){
 
-	if(std::find(this->register_list.begin(), this->register_list.end(), register_) == this->register_list.end()){
-		throw std::invalid_argument("Register address " + std::to_string(register_) + " not found in AFE register list.");
-		return 0;
-	}
+	this->checkRegister(afe, register_);
 
 	uint32_t value_ = (register_ & 0xff) << 16 | (value & 0xFFFF);
-	std::string regString = "afeControl_" + std::to_string(afe);
-	this->spi->setData(regString, value_);
-	this->spi->setData(regString, 0x000002);
-	this->spi->setData(regString, value_ & 0xFF0000);
-	uint32_t readValue = this->spi->getData(regString) & 0xFFFF;
-	this->spi->setData(regString, 0x000000);
+	this->spi->setAfeData(afe, value_);
+	this->spi->setAfeData(afe, 0x000002);
+	this->spi->setAfeData(afe, value_ & 0xFF0000);
+	uint32_t readValue = this->spi->getAfeData(afe) & 0xFFFF;
+	this->spi->setAfeData(afe, 0x000000);
 	if(readValue != (value_ & 0xFFFF)){
 		std::cout << "Read value different than written value (AFE: " << afe
 		     << ", REG: 0x" << std::hex << register_
@@ -52,22 +52,131 @@ uint32_t Afe::setRegister(const uint32_t& afe, const uint32_t& register_, const
 		     << ", R: 0x" << readValue
 		     << ")" << std::endl;
 	}
+	if(register_ == 0){
+		if(value & 0x1){ // software reset: every register is back at its default
+			this->invalidateShadow(afe);
+		}
+	}else{
+		this->storeShadow(afe, register_, readValue);
+	}
 	return readValue;
 }
 
 uint32_t Afe::getRegister(const uint32_t& afe, const uint32_t& register_){
 
+	this->checkRegister(afe, register_);
+
+	this->spi->setAfeData(afe, 0x000002);
+	this->spi->setAfeData(afe, register_ << 16);
+	uint32_t value_ = this->spi->getAfeData(afe) & 0xFFFF;
+	this->spi->setAfeData(afe, 0x000000);
+	if(register_ != 0){
+		this->storeShadow(afe, register_, value_);
+	}
+	return value_;
+}
+
+void Afe::checkRegister(const uint32_t& afe, const uint32_t& register_) const{
+
+	if(afe >= this->shadow.size()){
+		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
+	}
 	if(std::find(this->register_list.begin(), this->register_list.end(), register_) == this->register_list.end()){
 		throw std::invalid_argument("Register address " + std::to_string(register_) + " not found in AFE register list.");
-		return 0;
 	}
+}
 
-	std::string regString = "afeControl_" + std::to_string(afe);
-	this->spi->setData(regString, 0x000002);
-	this->spi->setData(regString, register_ << 16);
-	uint32_t value_ = this->spi->getData(regString) & 0xFFFF;
-	this->spi->setData(regString, 0x000000);
-	return value_;
+void Afe::storeShadow(const uint32_t& afe, const uint32_t& register_, const uint32_t& value){
+
+	std::lock_guard<std::mutex> lock(this->shadowMutex);
+	this->shadow[afe][register_] = value;
+}
+
+std::optional<uint32_t> Afe::findShadowRegister(const uint32_t& afe, const uint32_t& register_){
+
+	this->checkRegister(afe, register_);
+	std::lock_guard<std::mutex> lock(this->shadowMutex);
+	auto it = this->shadow[afe].find(register_);
+	if(it == this->shadow[afe].end()){
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+uint32_t Afe::getShadowRegister(const uint32_t& afe, const uint32_t& register_){
+
+	std::optional<uint32_t> value = this->findShadowRegister(afe, register_);
+	if(value){
+		return *value;
+	}
+	return this->getRegister(afe, register_);
+}
+
+void Afe::invalidateShadow(){
+
+	std::lock_guard<std::mutex> lock(this->shadowMutex);
+	for(auto& image : this->shadow){
+		image.clear();
+	}
+}
+
+void Afe::invalidateShadow(const uint32_t& afe){
+
+	if(afe >= this->shadow.size()){
+		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
+	}
+	std::lock_guard<std::mutex> lock(this->shadowMutex);
+	this->shadow[afe].clear();
+}
+
+std::vector<Afe::RegisterMismatch> Afe::verifyAfe(const uint32_t& afe, uint32_t* registersChecked){
+
+	std::vector<Afe::RegisterMismatch> mismatches;
+	uint32_t checked = 0;
+	for(const auto& register_ : this->register_list){
+		if(register_ == 0){
+			continue;
+		}
+		std::optional<uint32_t> shadowValue = this->findShadowRegister(afe, register_);
+		uint32_t hardwareValue = this->getRegister(afe, register_); // refreshes the image
+		checked++;
+		if(!shadowValue || *shadowValue != hardwareValue){
+			mismatches.push_back({register_, shadowValue, hardwareValue});
+		}
+	}
+	if(registersChecked){
+		*registersChecked = checked;
+	}
+	return mismatches;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> Afe::getShadowImage(const uint32_t& afe){
+
+	if(afe >= this->shadow.size()){
+		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
+	}
+	std::vector<std::pair<uint32_t, uint32_t>> image;
+	{
+		std::lock_guard<std::mutex> lock(this->shadowMutex);
+		image.assign(this->shadow[afe].begin(), this->shadow[afe].end());
+	}
+	std::sort(image.begin(), image.end());
+	return image;
+}
+
+std::vector<Afe::RegisterMismatch> Afe::writeImage(const uint32_t& afe, const std::vector<std::pair<uint32_t, uint32_t>>& image){
+
+	std::vector<Afe::RegisterMismatch> mismatches;
+	for(const auto& reg_ : image){
+		if(reg_.first == 0){
+			continue; // reset/readout control, never part of an image
+		}
+		const uint32_t readBack = this->setRegister(afe, reg_.first, reg_.second);
+		if(readBack != reg_.second){
+			mismatches.push_back({reg_.first, reg_.second, readBack});
+		}
+	}
+	return mismatches;
 }
 
 uint32_t Afe::initAFE(const uint32_t& afe, const std::unordered_map<uint32_t, uint32_t> &regDict){
@@ -80,57 +189,53 @@ uint32_t Afe::initAFE(const uint32_t& afe, const std::unordered_map<uint32_t, ui
 	return value_;
 }
 
-uint32_t Afe::setAFEFunction(const uint32_t& afe, const std::string& functionName, const uint16_t& value){
-    
-	auto available_options_it = this->afeFunctionAvailableOptionsDict.find(functionName);
-	if (available_options_it == this->afeFunctionAvailableOptionsDict.end()) {
-		throw std::invalid_argument("AFE function name " + functionName + " not found in the AFE options dictionary.");
-		return 0;
-	}
-
-	const auto& available_options = available_options_it->second;
-	int len_options = available_options.size();
-	if(len_options == 2){
-		if(value >= available_options[0] && value <= available_options[1]){
-			//std::cout << "Value is in range." << std::endl;
-		}else{
-			throw std::invalid_argument("Invalid value " + std::to_string(value) + " for AFE function name " + functionName + 
-			                            ".\nThe expected range is " + std::to_string(available_options[0]) + " - " + std::to_string(available_options[1]));
-			return 0;
-		}
-	}else{
-		if(std::find(available_options.begin(), available_options.end(), static_cast<uint16_t>(value)) == available_options.end()){
+afe_definitions::AfeFunction Afe::findFunction(const std::string& functionName){
+
+	const auto id = afe_definitions::findAfeFunction(functionName);
+	if(!id){
+		throw std::invalid_argument("AFE function name " + functionName + " not found in the AFE functions dictionary.");
+	}
+	return *id;
+}
+
+void Afe::validateFunctionValue(const afe_definitions::AfeFunctionInfo& info, const uint16_t& value){
+
+	if(info.optionBits != 0){
+		if(value >= 32 || (info.optionBits & (1u << value)) == 0){
 			std::string options_list = "\n";
-			for(const auto &option_ : available_options){
-				options_list = options_list + std::to_string(option_) + "\n";
+			for(uint32_t option_ = 0; option_ < 32; option_++){
+				if(info.optionBits & (1u << option_)){
+					options_list = options_list + std::to_string(option_) + "\n";
+				}
 			}
-			throw std::invalid_argument("Invalid option " + std::to_string(value) + " for AFE function name " + functionName + 
+			throw std::invalid_argument("Invalid option " + std::to_string(value) + " for AFE function name " + info.name + 
 			                            ".\nThe expected option list is: " + options_list);
-			return 0;
 		}
+	}else if(value < info.minValue || value > info.maxValue){
+		throw std::invalid_argument("Invalid value " + std::to_string(value) + " for AFE function name " + info.name + 
+		                            ".\nThe expected range is " + std::to_string(info.minValue) + " - " + std::to_string(info.maxValue));
 	}
+}
 
-	auto afe_funct_it = this->afeFunctionDict.find(functionName);
-	if (afe_funct_it == this->afeFunctionDict.end()) {
-		throw std::invalid_argument("AFE function name " + functionName + " not found in the AFE functions dictionary.");
-		return 0;
-	}
-
-	const Afe::BitField& bit_field = afe_funct_it->second;
-	const auto& registerAddr = bit_field.begin()->first;
-	const auto& msb_pos = bit_field.begin()->second.first;
-	const auto& lsb_pos = bit_field.begin()->second.second;
-	uint32_t mask = ((1 << (msb_pos - lsb_pos + 1)) - 1) << lsb_pos;
-	uint32_t registerValue = this->getRegister(afe, registerAddr);
-	registerValue = (registerValue & (~mask)); // Clear the bits
-	registerValue |= ((value << lsb_pos) & mask); // Set the new value
-	this->setRegister(afe, registerAddr, registerValue);
-	registerValue = this->getRegister(afe, registerAddr);
+uint32_t Afe::setAFEFunction(const uint32_t& afe, const std::string& functionName, const uint16_t& value){
+
+	return this->setAFEFunction(afe, Afe::findFunction(functionName), value);
+}
+
+uint32_t Afe::setAFEFunction(const uint32_t& afe, const afe_definitions::AfeFunction& function, const uint16_t& value){
+
+	const auto& info = afe_definitions::afeFunctionInfo(function);
+	this->validateFunctionValue(info, value);
+
+	uint32_t registerValue = this->getShadowRegister(afe, info.registerAddr);
+	registerValue = (registerValue & (~static_cast<uint32_t>(info.mask))); // Clear the bits
+	registerValue |= ((static_cast<uint32_t>(value) << info.lsb) & info.mask); // Set the new value
+	registerValue = this->setRegister(afe, info.registerAddr, registerValue); // read-back
 	// get the written bits to check if they are correct
-	uint32_t checkValue = (registerValue & mask) >> lsb_pos;
+	uint32_t checkValue = (registerValue & info.mask) >> info.lsb;
 	if(checkValue != value){
 		std::cerr << "Written value different than read value (AFE: " << afe
-		     << ", REG: " << registerAddr
+		     << ", REG: " << static_cast<uint32_t>(info.registerAddr)
 		     << ", W: " << value
 		     << ", R: " << checkValue
 		     << ")" << std::endl;
@@ -138,39 +243,83 @@ uint32_t Afe::setAFEFunction(const uint32_t& afe, const std::string& functionNam
 	return checkValue;
 }
 
-uint32_t Afe::getAFEFunction(const uint32_t& afe, const std::string& functionName){
+std::vector<uint32_t> Afe::applyFunctions(const uint32_t& afe, const std::vector<std::pair<afe_definitions::AfeFunction, uint16_t>>& functions){
 
-	auto afe_funct_it = this->afeFunctionDict.find(functionName);
-	if (afe_funct_it == this->afeFunctionDict.end()) {
-		throw std::invalid_argument("AFE function name " + functionName + " not found in the AFE functions dictionary.");
-		return 0;
+	// Validate everything before touching the chip.
+	std::vector<const afe_definitions::AfeFunctionInfo*> fields;
+	fields.reserve(functions.size());
+	for(const auto& function : functions){
+		const auto& info = afe_definitions::afeFunctionInfo(function.first);
+		this->validateFunctionValue(info, function.second);
+		fields.push_back(&info);
 	}
 
-	const Afe::BitField& bit_field = afe_funct_it->second;
-	const auto& registerAddr = bit_field.begin()->first;
-	const auto& msb_pos = bit_field.begin()->second.first;
-	const auto& lsb_pos = bit_field.begin()->second.second;
-	uint32_t mask = ((1 << (msb_pos - lsb_pos + 1)) - 1) << lsb_pos;
-	uint32_t registerValue = this->getRegister(afe, registerAddr);
-	uint32_t value = (registerValue & mask) >> lsb_pos;
+	// Merge into one image per register (later functions win on overlapping bits).
+	std::map<uint32_t, std::pair<uint32_t, uint32_t>> images; // reg -> {mask, bits}
+	for(size_t i = 0; i < functions.size(); i++){
+		auto& image = images[fields[i]->registerAddr];
+		image.first |= fields[i]->mask;
+		image.second = (image.second & ~static_cast<uint32_t>(fields[i]->mask)) | ((static_cast<uint32_t>(functions[i].second) << fields[i]->lsb) & fields[i]->mask);
+	}
 
-	return value;
+	// One read-modify-write per register, merged on the shadow image; setRegister reads the value back.
+	std::map<uint32_t, uint32_t> readBack;
+	for(const auto& image : images){
+		const uint32_t registerAddr = image.first;
+		const uint32_t mask = image.second.first;
+		uint32_t registerValue = (mask == 0xFFFF) ? 0 : this->getShadowRegister(afe, registerAddr);
+		registerValue = (registerValue & ~mask) | image.second.second;
+		readBack[registerAddr] = this->setRegister(afe, registerAddr, registerValue);
+	}
+
+	std::vector<uint32_t> values;
+	values.reserve(functions.size());
+	for(size_t i = 0; i < functions.size(); i++){
+		const uint32_t checkValue = (readBack[fields[i]->registerAddr] & fields[i]->mask) >> fields[i]->lsb;
+		if(checkValue != functions[i].second){
+			std::cerr << "Written value different than read value (AFE: " << afe
+			     << ", REG: " << static_cast<uint32_t>(fields[i]->registerAddr)
+			     << ", W: " << functions[i].second
+			     << ", R: " << checkValue
+			     << ")" << std::endl;
+		}
+		values.push_back(checkValue);
+	}
+	return values;
 }
 
-void Afe::updateAfeRegDict(const uint32_t& afe, std::unordered_map<uint32_t, uint32_t> &dict, const std::string& functionName){
+std::vector<uint32_t> Afe::applyFunctions(const uint32_t& afe, const std::vector<std::pair<std::string, uint16_t>>& functions){
 
-	auto afe_funct_it = this->afeFunctionDict.find(functionName);
-	if (afe_funct_it == this->afeFunctionDict.end()) {
-		throw std::invalid_argument("AFE function name " + functionName + " not found in the AFE functions dictionary.");
+	std::vector<std::pair<afe_definitions::AfeFunction, uint16_t>> resolved;
+	resolved.reserve(functions.size());
+	for(const auto& function : functions){
+		resolved.emplace_back(Afe::findFunction(function.first), function.second);
 	}
+	return this->applyFunctions(afe, resolved);
+}
+
+uint32_t Afe::getAFEFunction(const uint32_t& afe, const std::string& functionName){
+
+	return this->getAFEFunction(afe, Afe::findFunction(functionName));
+}
 
-	const Afe::BitField& bit_field = afe_funct_it->second;
-	const auto& registerAddr = bit_field.begin()->first;
-	uint32_t registerValue = this->getRegister(afe, registerAddr);
+uint32_t Afe::getAFEFunction(const uint32_t& afe, const afe_definitions::AfeFunction& function){
 
-	auto regDict_it = dict.find(registerAddr);
+	const auto& info = afe_definitions::afeFunctionInfo(function);
+	uint32_t registerValue = this->getShadowRegister(afe, info.registerAddr);
+	uint32_t value = (registerValue & info.mask) >> info.lsb;
+
+	return value;
+}
+
+void Afe::updateAfeRegDict(const uint32_t& afe, std::unordered_map<uint32_t, uint32_t> &dict, const std::string& functionName){
+
+	const auto& info = afe_definitions::afeFunctionInfo(Afe::findFunction(functionName));
+	uint32_t registerValue = this->getShadowRegister(afe, info.registerAddr);
+
+	auto regDict_it = dict.find(info.registerAddr);
 	if (regDict_it == dict.end()) {
-		throw std::invalid_argument("Internal Error: AFE function name " + functionName + " has an invalid register address: "+ std::to_string(registerAddr) +".");
+		throw std::invalid_argument("Internal Error: AFE function name " + functionName + " has an invalid register address: "+ std::to_string(info.registerAddr) +".");
 	}
 	regDict_it->second = registerValue;
 
@@ -178,23 +327,14 @@ void Afe::updateAfeRegDict(const uint32_t& afe, std::unordered_map<uint32_t, uin
 
 uint32_t Afe::getAFEFunctionValueFromRegDict(const uint32_t& afe, std::unordered_map<uint32_t, uint32_t> &dict, const std::string& functionName){
 
-	auto afe_funct_it = this->afeFunctionDict.find(functionName);
-	if (afe_funct_it == this->afeFunctionDict.end()) {
-		throw std::invalid_argument("AFE function name " + functionName + " not found in the AFE functions dictionary.");
-	}
+	const auto& info = afe_definitions::afeFunctionInfo(Afe::findFunction(functionName));
 
-	const Afe::BitField& bit_field = afe_funct_it->second;
-	const auto& registerAddr = bit_field.begin()->first;
-	const auto& msb_pos = bit_field.begin()->second.first;
-	const auto& lsb_pos = bit_field.begin()->second.second;
-	uint32_t mask = ((1 << (msb_pos - lsb_pos + 1)) - 1) << lsb_pos;
-
-	auto regDict_it = dict.find(registerAddr);
+	auto regDict_it = dict.find(info.registerAddr);
 	if (regDict_it == dict.end()) {
-		throw std::invalid_argument("Internal Error: AFE function name " + functionName + " has an invalid register address: "+ std::to_string(registerAddr) +".");
+		throw std::invalid_argument("Internal Error: AFE function name " + functionName + " has an invalid register address: "+ std::to_string(info.registerAddr) +".");
 	}
 	uint32_t registerValue = regDict_it->second;
-	uint32_t value = (registerValue & mask) >> lsb_pos;
+	uint32_t value = (registerValue & info.mask) >> info.lsb;
 
 	return value;
-}
\ No newline at end of file
+}
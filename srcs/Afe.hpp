@@ -11,7 +11,11 @@
 #include <chrono>
 #include <thread>
 #include <unordered_map>
+#include <map>
 #include <algorithm>
+#include <array>
+#include <mutex>
+#include <optional>
 
 #include "Spi.hpp"
 #include "defines.hpp"
@@ -24,7 +28,11 @@ public:
     // Destructor
     ~Afe();
 
-    using BitField = std::unordered_map<uint32_t, std::pair<int, int>>;
+    struct RegisterMismatch {
+        uint32_t registerAddr;
+        std::optional<uint32_t> shadowValue;   // nullopt: register was not in the image
+        uint32_t hardwareValue;
+    };
     
     uint32_t setReset(const uint32_t& reset);
     uint32_t doReset();
@@ -32,20 +40,48 @@ public:
     uint32_t getPowerState();
     uint32_t setRegister(const uint32_t& afe, const uint32_t& register_, const uint32_t& value);
     uint32_t getRegister(const uint32_t& afe, const uint32_t& register_);
+    // Register image kept from every write (with its read-back) and read. A register
+    // missing from the image is read from the chip once. Resets and power-state
+    // changes drop the image. Register 0 (reset/readout enable) is never shadowed.
+    uint32_t getShadowRegister(const uint32_t& afe, const uint32_t& register_);
+    std::optional<uint32_t> findShadowRegister(const uint32_t& afe, const uint32_t& register_);
+    void invalidateShadow();
+    void invalidateShadow(const uint32_t& afe);
+    // Audit: re-reads every listed register from the chip, refreshes the image and
+    // returns the registers whose image differed. registersChecked gets the count read.
+    std::vector<RegisterMismatch> verifyAfe(const uint32_t& afe, uint32_t* registersChecked = nullptr);
+    // Shadow contents of one AFE as {register, value}, sorted by register.
+    std::vector<std::pair<uint32_t, uint32_t>> getShadowImage(const uint32_t& afe);
+    // Writes a saved image back (each write is read back into the shadow) and
+    // returns the registers whose read-back differs from the saved value.
+    std::vector<RegisterMismatch> writeImage(const uint32_t& afe, const std::vector<std::pair<uint32_t, uint32_t>>& image);
     uint32_t initAFE(const uint32_t& afe, const std::unordered_map<uint32_t, uint32_t> &regDict);
+    // The enum overloads index afe_definitions::afeFunctionTable directly; the string
+    // overloads look the name up once and forward to them.
+    uint32_t setAFEFunction(const uint32_t& afe, const afe_definitions::AfeFunction& function, const uint16_t& value);
     uint32_t setAFEFunction(const uint32_t& afe, const std::string& functionName, const uint16_t& value);
+    uint32_t getAFEFunction(const uint32_t& afe, const afe_definitions::AfeFunction& function);
     uint32_t getAFEFunction(const uint32_t& afe, const std::string& functionName);
+    // Programs several functions at once: every touched register is merged locally and
+    // written once (with its read-back). Returns the read-back value of each function.
+    std::vector<uint32_t> applyFunctions(const uint32_t& afe, const std::vector<std::pair<afe_definitions::AfeFunction, uint16_t>>& functions);
+    std::vector<uint32_t> applyFunctions(const uint32_t& afe, const std::vector<std::pair<std::string, uint16_t>>& functions);
     void updateAfeRegDict(const uint32_t& afe, std::unordered_map<uint32_t, uint32_t> &dict, const std::string& functionName);
     uint32_t getAFEFunctionValueFromRegDict(const uint32_t& afe, std::unordered_map<uint32_t, uint32_t> &dict, const std::string& functionName);
     void setRegisterList(const std::vector<uint32_t> reg_list) {this->register_list = reg_list;}
+    // Throws std::invalid_argument when value is outside the function's range or option list.
+    static void validateFunctionValue(const afe_definitions::AfeFunctionInfo& info, const uint16_t& value);
 
 private:
     std::unique_ptr<Spi> spi;
-    
+
+    static afe_definitions::AfeFunction findFunction(const std::string& functionName);
+    void checkRegister(const uint32_t& afe, const uint32_t& register_) const;
+    void storeShadow(const uint32_t& afe, const uint32_t& register_, const uint32_t& value);
+
     std::vector<uint32_t> register_list;
-    // {FUNCTION_NAME, {REGISTER_ADDR, {BITH, BITL}}}
-    const std::unordered_map<std::string, Afe::BitField> afeFunctionDict = afe_definitions::afeFunctionDict;
-    const std::unordered_map<std::string, std::vector<uint16_t>> afeFunctionAvailableOptionsDict = afe_definitions::afeFunctionAvailableOptionsDict;
+    std::mutex shadowMutex;
+    std::array<std::unordered_map<uint32_t, uint32_t>, 5> shadow;
 };
 
 #endif // AFE_HPP
\ No newline at end of file
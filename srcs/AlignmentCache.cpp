@@ -0,0 +1,141 @@
+#include "AlignmentCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+AlignmentCache::AlignmentCache(const std::string& path, const size_t& maxEntries)
+	: path_(path), maxEntries_(maxEntries > 0 ? maxEntries : 1){
+
+	this->load();
+}
+
+AlignmentCache::~AlignmentCache(){}
+
+std::optional<AlignmentCacheEntry> AlignmentCache::lookup(const AlignmentCacheKey& key) const{
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	for(const auto& entry : this->entries_){
+		if(entry.key == key){
+			return entry;
+		}
+	}
+	return std::nullopt;
+}
+
+bool AlignmentCache::store(const AlignmentCacheEntry& entry){
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	auto it = std::find_if(this->entries_.begin(), this->entries_.end(),
+	                       [&](const AlignmentCacheEntry& e) { return e.key == entry.key; });
+	if(it != this->entries_.end()){
+		*it = entry;
+	}else{
+		if(this->entries_.size() >= this->maxEntries_){
+			auto oldest = std::min_element(this->entries_.begin(), this->entries_.end(),
+			                               [](const AlignmentCacheEntry& a, const AlignmentCacheEntry& b) {
+				                               return a.timestamp_ns < b.timestamp_ns;
+			                               });
+			this->entries_.erase(oldest);
+		}
+		this->entries_.push_back(entry);
+	}
+	return this->save();
+}
+
+bool AlignmentCache::invalidate(const AlignmentCacheKey& key){
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	const size_t before = this->entries_.size();
+	this->entries_.erase(std::remove_if(this->entries_.begin(), this->entries_.end(),
+	                                    [&](const AlignmentCacheEntry& e) { return e.key == key; }),
+	                     this->entries_.end());
+	if(this->entries_.size() == before){
+		return true;
+	}
+	return this->save();
+}
+
+const std::string& AlignmentCache::getPath() const{
+
+	return this->path_;
+}
+
+int32_t AlignmentCache::temperatureBand(const double& temperature_C, const double& bandWidth_C){
+
+	if(!std::isfinite(temperature_C) || !(bandWidth_C > 0.0)){
+		return AlignmentCacheKey::kUnknownTemperatureBand;
+	}
+	return static_cast<int32_t>(std::floor(temperature_C / bandWidth_C));
+}
+
+void AlignmentCache::load(){
+
+	std::ifstream in(this->path_);
+	if(!in){
+		return;
+	}
+	std::string line;
+	if(!std::getline(in, line) || line != kHeader){
+		std::cerr << "Warning: ignoring alignment cache " << this->path_ << " (unknown format)" << std::endl;
+		return;
+	}
+	while(std::getline(in, line)){
+		if(line.empty() || line[0] == '#'){
+			continue;
+		}
+		std::istringstream is(line);
+		AlignmentCacheEntry entry;
+		is >> std::hex >> entry.key.git >> std::dec >> entry.key.slot >> entry.key.crate >> entry.key.temperatureBand;
+		for(auto& d : entry.delay){
+			is >> d;
+		}
+		for(auto& b : entry.bitslip){
+			is >> b;
+		}
+		is >> entry.timestamp_ns;
+		if(!is){
+			continue;
+		}
+		if(this->entries_.size() < this->maxEntries_){
+			this->entries_.push_back(entry);
+		}
+	}
+}
+
+bool AlignmentCache::save() const{
+
+	const std::string tmpPath = this->path_ + ".tmp";
+	{
+		std::ofstream out(tmpPath, std::ios::trunc);
+		if(!out){
+			std::cerr << "Warning: cannot write alignment cache " << tmpPath << std::endl;
+			return false;
+		}
+		out << kHeader << "\n";
+		out << "# git slot crate temp_band delay[0..4] bitslip[0..4] timestamp_ns\n";
+		for(const auto& entry : this->entries_){
+			out << std::hex << entry.key.git << std::dec << " " << entry.key.slot << " " << entry.key.crate
+			    << " " << entry.key.temperatureBand;
+			for(const auto d : entry.delay){
+				out << " " << d;
+			}
+			for(const auto b : entry.bitslip){
+				out << " " << b;
+			}
+			out << " " << entry.timestamp_ns << "\n";
+		}
+		if(!out.flush()){
+			std::cerr << "Warning: failed writing alignment cache " << tmpPath << std::endl;
+			return false;
+		}
+	}
+	if(std::rename(tmpPath.c_str(), this->path_.c_str()) != 0){
+		std::cerr << "Warning: cannot replace alignment cache " << this->path_ << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,69 @@
+#ifndef ALIGNMENTCACHE_HPP
+#define ALIGNMENTCACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Identifies the conditions an alignment result is valid for: firmware build
+// (GIT register), board position (idSlot/idCrate) and board temperature band.
+struct AlignmentCacheKey {
+    static constexpr int32_t kUnknownTemperatureBand = std::numeric_limits<int32_t>::min();
+
+    uint32_t git = 0;
+    uint32_t slot = 0;
+    uint32_t crate = 0;
+    int32_t temperatureBand = kUnknownTemperatureBand;
+
+    bool operator==(const AlignmentCacheKey& other) const noexcept {
+        return git == other.git && slot == other.slot && crate == other.crate &&
+               temperatureBand == other.temperatureBand;
+    }
+};
+
+// Last good DELAY/BITSLIP per frontend (PL) AFE for one key.
+struct AlignmentCacheEntry {
+    AlignmentCacheKey key;
+    std::array<uint32_t, 5> delay{};
+    std::array<uint32_t, 5> bitslip{};
+    uint64_t timestamp_ns = 0;
+};
+
+// Small persistent store of good alignments, one text line per key. The file
+// is rewritten (tmp + rename) on every store so a crash never leaves it torn.
+class AlignmentCache {
+public:
+    // Constructor
+    explicit AlignmentCache(const std::string& path, const size_t& maxEntries = 64);
+
+    // Destructor
+    ~AlignmentCache();
+
+    std::optional<AlignmentCacheEntry> lookup(const AlignmentCacheKey& key) const;
+    // Inserts or replaces the entry for entry.key and saves the file.
+    bool store(const AlignmentCacheEntry& entry);
+    // Drops the entry for key (e.g. after it failed verification) and saves the file.
+    bool invalidate(const AlignmentCacheKey& key);
+    const std::string& getPath() const;
+
+    // Temperature bands are bandWidth_C wide; NaN maps to the unknown band.
+    static int32_t temperatureBand(const double& temperature_C, const double& bandWidth_C = 10.0);
+
+private:
+    static constexpr const char* kHeader = "# daphne alignment cache v1";
+
+    std::string path_;
+    size_t maxEntries_;
+    mutable std::mutex mutex_;
+    std::vector<AlignmentCacheEntry> entries_;
+
+    void load();
+    bool save() const;
+};
+
+#endif // ALIGNMENTCACHE_HPP
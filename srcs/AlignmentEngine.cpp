@@ -0,0 +1,299 @@
+#include "AlignmentEngine.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+HardwareAlignmentProbe::HardwareAlignmentProbe(FrontEnd& frontend, SpyBuffer& spyBuffer,
+                                               std::chrono::microseconds settle)
+	: frontend(frontend), spyBuffer(spyBuffer), settle(settle){}
+
+void HardwareAlignmentProbe::setDelay(const uint32_t& afe, const uint32_t& delay){
+
+	this->frontend.setDelay(static_cast<uint8_t>(afe), delay);
+}
+
+uint32_t HardwareAlignmentProbe::getDelay(const uint32_t& afe){
+
+	return this->frontend.getDelay(static_cast<uint8_t>(afe));
+}
+
+void HardwareAlignmentProbe::setBitslip(const uint32_t& afe, const uint32_t& bitslip){
+
+	this->frontend.setBitslip(static_cast<uint8_t>(afe), bitslip);
+}
+
+uint32_t HardwareAlignmentProbe::getBitslip(const uint32_t& afe){
+
+	return this->frontend.getBitslip(static_cast<uint8_t>(afe));
+}
+
+std::array<uint32_t, AlignmentProbe::kAfes> HardwareAlignmentProbe::snapshot(){
+
+	this->frontend.doTrigger();
+	std::this_thread::sleep_for(this->settle);
+	std::array<uint32_t, kAfes> words{};
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		words[afe] = this->spyBuffer.getFrameClock(afe, 0);
+	}
+	return words;
+}
+
+std::optional<std::pair<uint32_t, uint32_t>> AlignmentEngine::longestIdenticalSubsequenceIndices(const std::vector<uint32_t>& nums){
+
+	if(nums.empty()){
+		return std::nullopt;
+	}
+
+	uint32_t maxLength = 1;
+	uint32_t maxStartIndex = 0;
+	uint32_t currentLength = 1;
+	uint32_t currentStartIndex = 0;
+
+	for(uint32_t i = 1; i < nums.size(); i++){
+
+		if(nums[i] == nums[i - 1]){
+
+			currentLength += 1;
+		}else{
+
+			if(currentLength > maxLength){
+
+				maxLength = currentLength;
+				maxStartIndex = currentStartIndex;
+			}
+
+			currentLength = 1;
+			currentStartIndex = i;
+		}
+	}
+
+	if(currentLength > maxLength){
+
+		maxLength = currentLength;
+		maxStartIndex = currentStartIndex;
+	}
+
+	return std::make_pair(maxStartIndex, maxStartIndex + maxLength - 1);
+}
+
+AlignmentEngine::AlignmentEngine(AlignmentProbe& probe,
+                                 const uint32_t& delayTaps,
+                                 const uint32_t& coarseStep,
+                                 const uint32_t& bitslipTaps)
+	: probe(probe), delayTaps(delayTaps), coarseStep(coarseStep), bitslipTaps(bitslipTaps){
+
+	if(delayTaps == 0 || coarseStep == 0 || bitslipTaps == 0){
+		throw std::invalid_argument("AlignmentEngine: taps and coarse step must be non-zero");
+	}
+}
+
+uint32_t AlignmentEngine::getTriggerCount() const{
+
+	return this->triggerCount;
+}
+
+std::array<uint32_t, AlignmentProbe::kAfes> AlignmentEngine::snapshot(){
+
+	this->triggerCount++;
+	return this->probe.snapshot();
+}
+
+std::array<std::vector<uint32_t>, AlignmentProbe::kAfes> AlignmentEngine::scanDelays(
+	const std::array<std::vector<uint32_t>, AlignmentProbe::kAfes>& taps){
+
+	size_t steps = 0;
+	for(const auto& t : taps){
+		steps = std::max(steps, t.size());
+	}
+
+	std::array<std::vector<uint32_t>, AlignmentProbe::kAfes> words;
+	for(uint32_t afe = 0; afe < AlignmentProbe::kAfes; afe++){
+		words[afe].reserve(taps[afe].size());
+	}
+	for(size_t i = 0; i < steps; i++){
+		for(uint32_t afe = 0; afe < AlignmentProbe::kAfes; afe++){
+			if(i < taps[afe].size()){
+				this->probe.setDelay(afe, taps[afe][i]);
+			}
+		}
+		const std::array<uint32_t, AlignmentProbe::kAfes> snap = this->snapshot();
+		for(uint32_t afe = 0; afe < AlignmentProbe::kAfes; afe++){
+			if(i < taps[afe].size()){
+				words[afe].push_back(snap[afe]);
+			}
+		}
+	}
+	return words;
+}
+
+std::array<AfeAlignment, AlignmentProbe::kAfes> AlignmentEngine::align(){
+
+	constexpr uint32_t kTarget32 = 0x00FF00FFu;
+	constexpr uint32_t kAfes = AlignmentProbe::kAfes;
+	const uint32_t maxTap = this->delayTaps - 1;
+	std::array<AfeAlignment, kAfes> result{};
+
+	// Coarse pass, always including the last tap so the scan range is closed.
+	std::vector<uint32_t> coarseTaps;
+	for(uint32_t tap = 0; tap < this->delayTaps; tap += this->coarseStep){
+		coarseTaps.push_back(tap);
+	}
+	if(coarseTaps.back() != maxTap){
+		coarseTaps.push_back(maxTap);
+	}
+	const uint32_t nCoarse = static_cast<uint32_t>(coarseTaps.size());
+
+	std::array<std::vector<uint32_t>, kAfes> taps;
+	taps.fill(coarseTaps);
+	const std::array<std::vector<uint32_t>, kAfes> coarse = this->scanDelays(taps);
+
+	// Candidate coarse runs: any run whose widest possible extent (up to the
+	// neighbouring coarse samples) is not shorter than the best guaranteed width.
+	std::array<std::vector<Run>, kAfes> candidates;
+	std::array<std::vector<uint32_t>, kAfes> fineTaps;
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		std::vector<Run> runs;
+		uint32_t runFirst = 0;
+		for(uint32_t k = 1; k <= nCoarse; k++){
+			if(k == nCoarse || coarse[afe][k] != coarse[afe][k - 1]){
+				runs.push_back(Run{runFirst, k - 1});
+				runFirst = k;
+			}
+		}
+
+		uint32_t guaranteed = 0;
+		bool anyPair = false;
+		for(const Run& run : runs){
+			guaranteed = std::max(guaranteed, coarseTaps[run.last] - coarseTaps[run.first] + 1);
+			anyPair = anyPair || run.last > run.first;
+		}
+
+		if(!anyPair){
+			// Eye narrower than the coarse step (or no stable eye at all): scan every tap.
+			result[afe].fullScan = true;
+			for(uint32_t tap = 0; tap <= maxTap; tap++){
+				fineTaps[afe].push_back(tap);
+			}
+			continue;
+		}
+
+		for(const Run& run : runs){
+			const uint32_t lo = run.first == 0 ? 0 : coarseTaps[run.first - 1] + 1;
+			const uint32_t hi = run.last == nCoarse - 1 ? maxTap : coarseTaps[run.last + 1] - 1;
+			if(hi - lo + 1 < guaranteed){
+				continue;
+			}
+			candidates[afe].push_back(run);
+			for(uint32_t tap = lo; tap < coarseTaps[run.first]; tap++){
+				fineTaps[afe].push_back(tap);
+			}
+			for(uint32_t tap = coarseTaps[run.last] + 1; tap <= hi; tap++){
+				fineTaps[afe].push_back(tap);
+			}
+		}
+	}
+
+	const std::array<std::vector<uint32_t>, kAfes> fine = this->scanDelays(fineTaps);
+
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		AfeAlignment& out = result[afe];
+		std::vector<uint32_t> words(this->delayTaps, 0);
+		for(uint32_t k = 0; k < nCoarse; k++){
+			words[coarseTaps[k]] = coarse[afe][k];
+		}
+		for(size_t i = 0; i < fineTaps[afe].size(); i++){
+			words[fineTaps[afe][i]] = fine[afe][i];
+		}
+
+		uint32_t bestStart = 0;
+		uint32_t bestEnd = 0;
+		uint32_t bestLength = 0;
+		if(out.fullScan){
+			const auto window = AlignmentEngine::longestIdenticalSubsequenceIndices(words);
+			bestStart = window->first;
+			bestEnd = window->second;
+			bestLength = bestEnd - bestStart + 1;
+		}else{
+			for(const Run& run : candidates[afe]){
+				const uint32_t value = coarse[afe][run.first];
+				const uint32_t lo = run.first == 0 ? 0 : coarseTaps[run.first - 1] + 1;
+				const uint32_t hi = run.last == nCoarse - 1 ? maxTap : coarseTaps[run.last + 1] - 1;
+				uint32_t start = coarseTaps[run.first];
+				uint32_t end = coarseTaps[run.last];
+				while(start > lo && words[start - 1] == value){
+					start--;
+				}
+				while(end < hi && words[end + 1] == value){
+					end++;
+				}
+				// Candidates are visited in tap order, so '>' keeps the first on ties.
+				if(end - start + 1 > bestLength){
+					bestLength = end - start + 1;
+					bestStart = start;
+					bestEnd = end;
+				}
+			}
+		}
+
+		out.eyeFound = bestLength > 0;
+		out.eyeStart = bestStart;
+		out.eyeEnd = bestEnd;
+		out.eyeWord = words[bestStart];
+		out.delay = bestStart + (bestEnd - bestStart) / 2;
+		this->probe.setDelay(afe, out.delay);
+
+		std::ostringstream os;
+		os << "  DELAY_SCAN window " << bestStart << ".." << bestEnd
+		   << " (len=" << bestLength << "), sample=0, word=0x" << std::hex << out.eyeWord
+		   << std::dec << ", best=" << out.delay
+		   << (out.fullScan ? " [full scan]" : "") << "\n";
+		out.report = os.str();
+	}
+
+	// Bitslip: same tap on all AFEs per step, first exact match wins.
+	std::array<uint32_t, kAfes> initialBitslip{};
+	std::array<std::vector<uint32_t>, kAfes> bitslipWords;
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		initialBitslip[afe] = this->probe.getBitslip(afe);
+	}
+	for(uint32_t bitslip = 0; bitslip < this->bitslipTaps; bitslip++){
+		for(uint32_t afe = 0; afe < kAfes; afe++){
+			this->probe.setBitslip(afe, bitslip);
+		}
+		const std::array<uint32_t, kAfes> snap = this->snapshot();
+		for(uint32_t afe = 0; afe < kAfes; afe++){
+			bitslipWords[afe].push_back(snap[afe]);
+			if(!result[afe].matched && snap[afe] == kTarget32){
+				result[afe].matched = true;
+				result[afe].bitslip = bitslip;
+			}
+		}
+	}
+
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		AfeAlignment& out = result[afe];
+		if(!out.matched){
+			out.bitslip = initialBitslip[afe];
+			std::cerr << "Warning: AlignmentEngine could not find expected pattern for AFE "
+			          << afe << "; restoring bitslip to " << initialBitslip[afe] << std::endl;
+		}
+		this->probe.setBitslip(afe, out.bitslip);
+
+		std::ostringstream os;
+		os << "  BITSLIP_SCAN (sample=0, expect 0x00FF00FF):";
+		for(size_t i = 0; i < bitslipWords[afe].size(); i++){
+			os << " [" << i << "]=0x" << std::hex << std::uppercase << bitslipWords[afe][i];
+		}
+		os << std::dec << "\n  chosen=" << out.bitslip << " (initial " << initialBitslip[afe] << ")\n";
+		out.report += os.str();
+	}
+
+	const std::array<uint32_t, kAfes> finalWords = this->snapshot();
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		result[afe].word = finalWords[afe];
+	}
+	return result;
+}
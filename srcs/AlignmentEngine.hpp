@@ -0,0 +1,107 @@
+#ifndef ALIGNMENTENGINE_HPP
+#define ALIGNMENTENGINE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FrontEnd.hpp"
+#include "SpyBuffer.hpp"
+
+// Frontend access used by AlignmentEngine. All five AFEs are driven together:
+// each has its own frontendDelay_<n>/frontendBitslip_<n> register and one
+// snapshot returns every frame clock, so a scan step costs a single trigger.
+class AlignmentProbe {
+public:
+    static constexpr uint32_t kAfes = 5;
+
+    virtual ~AlignmentProbe() = default;
+    virtual void setDelay(const uint32_t& afe, const uint32_t& delay) = 0;
+    virtual uint32_t getDelay(const uint32_t& afe) = 0;
+    virtual void setBitslip(const uint32_t& afe, const uint32_t& bitslip) = 0;
+    virtual uint32_t getBitslip(const uint32_t& afe) = 0;
+    // Triggers one snapshot and returns the frame-clock word (sample 0) of every AFE.
+    virtual std::array<uint32_t, kAfes> snapshot() = 0;
+};
+
+// AlignmentProbe on the real FrontEnd/SpyBuffer. The spy buffer has no
+// capture-done flag, so each snapshot waits a fixed settle time after the
+// trigger before reading (1 ms, as before): reads that merely agree could
+// still be the previous capture.
+class HardwareAlignmentProbe : public AlignmentProbe {
+public:
+    HardwareAlignmentProbe(FrontEnd& frontend, SpyBuffer& spyBuffer,
+                           std::chrono::microseconds settle = std::chrono::microseconds(1000));
+
+    void setDelay(const uint32_t& afe, const uint32_t& delay) override;
+    uint32_t getDelay(const uint32_t& afe) override;
+    void setBitslip(const uint32_t& afe, const uint32_t& bitslip) override;
+    uint32_t getBitslip(const uint32_t& afe) override;
+    std::array<uint32_t, kAfes> snapshot() override;
+
+private:
+    FrontEnd& frontend;
+    SpyBuffer& spyBuffer;
+    std::chrono::microseconds settle;
+};
+
+struct AfeAlignment {
+    bool eyeFound = false;
+    bool fullScan = false;       // coarse scan found no eye; all taps were scanned
+    uint32_t eyeStart = 0;
+    uint32_t eyeEnd = 0;
+    uint32_t eyeWord = 0;
+    uint32_t delay = 0;
+    uint32_t bitslip = 0;
+    bool matched = false;        // bitslip scan found 0x00FF00FF
+    uint32_t word = 0;           // frame clock after applying delay/bitslip
+    std::string report;
+};
+
+// Parallel coarse-to-fine alignment of all five AFEs.
+//
+// The delay eye is defined exactly as in Daphne::setBestDelay: the longest run
+// of identical frame-clock words over taps 0..delayTaps-1 (first one on ties),
+// centre = first + (last - first) / 2. A coarse pass samples every coarseStep
+// taps; every coarse run that could still be the longest then has its two
+// edge gaps fine-scanned to find the exact run bounds. This matches the full
+// scan as long as the word does not change and change back between two equal
+// coarse samples; AFEs where no two consecutive coarse samples agree fall back
+// to a full scan.
+class AlignmentEngine {
+public:
+    explicit AlignmentEngine(AlignmentProbe& probe,
+                             const uint32_t& delayTaps = 512,
+                             const uint32_t& coarseStep = 16,
+                             const uint32_t& bitslipTaps = 16);
+
+    std::array<AfeAlignment, AlignmentProbe::kAfes> align();
+    uint32_t getTriggerCount() const;
+
+    // Full-scan rule of Daphne::setBestDelay: {first, last} index of the
+    // longest run of identical words, first one on ties.
+    static std::optional<std::pair<uint32_t, uint32_t>> longestIdenticalSubsequenceIndices(const std::vector<uint32_t>& nums);
+
+private:
+    struct Run {
+        uint32_t first;   // coarse indices
+        uint32_t last;
+    };
+
+    AlignmentProbe& probe;
+    uint32_t delayTaps;
+    uint32_t coarseStep;
+    uint32_t bitslipTaps;
+    uint32_t triggerCount = 0;
+
+    std::array<uint32_t, AlignmentProbe::kAfes> snapshot();
+    // Sets each AFE to its own tap list entry per step; returns words[afe][i] for taps[afe][i].
+    std::array<std::vector<uint32_t>, AlignmentProbe::kAfes> scanDelays(
+        const std::array<std::vector<uint32_t>, AlignmentProbe::kAfes>& taps);
+};
+
+#endif // ALIGNMENTENGINE_HPP
@@ -0,0 +1,371 @@
+#include "BoardState.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+constexpr char kMagic[8] = {'D', 'P', 'H', 'N', 'S', 'T', 'A', 'T'};
+
+enum Section : uint16_t {
+	kDaphneState = 1,
+	kAfeFunctions = 2,
+	kAfeRegisters = 3,
+	kFrontend = 4,
+	kTrigger = 5,
+	kHdMezz = 6,
+	kTriggerConfig = 7,
+};
+
+uint32_t crc32(const char* data, const size_t& length){
+
+	uint32_t crc = 0xFFFFFFFFu;
+	for(size_t i = 0; i < length; i++){
+		crc ^= static_cast<uint8_t>(data[i]);
+		for(int bit = 0; bit < 8; bit++){
+			crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+		}
+	}
+	return ~crc;
+}
+
+class Writer {
+public:
+	void u8(const uint8_t& v){ this->out.push_back(static_cast<char>(v)); }
+	void u16(const uint16_t& v){ this->le(v, 2); }
+	void u32(const uint32_t& v){ this->le(v, 4); }
+	void u64(const uint64_t& v){ this->le(v, 8); }
+	void f64(const double& v){
+
+		uint64_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		this->u64(bits);
+	}
+	// Starts a section; end() patches its length.
+	size_t begin(const Section& tag){
+
+		this->u16(tag);
+		this->u32(0);
+		return this->out.size();
+	}
+	void end(const size_t& start){
+
+		const uint32_t length = static_cast<uint32_t>(this->out.size() - start);
+		for(int i = 0; i < 4; i++){
+			this->out[start - 4 + i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+		}
+	}
+	template <size_t N>
+	void optionals(const std::array<std::optional<uint32_t>, N>& values){
+
+		static_assert(N <= 64, "presence mask is 64 bits");
+		uint64_t present = 0;
+		for(size_t i = 0; i < N; i++){
+			if(values[i]){
+				present |= 1ULL << i;
+			}
+		}
+		this->u64(present);
+		for(const auto& value : values){
+			if(value){
+				this->u32(*value);
+			}
+		}
+	}
+
+	std::string out;
+
+private:
+	void le(const uint64_t& v, const int& bytes){
+
+		for(int i = 0; i < bytes; i++){
+			this->out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+		}
+	}
+};
+
+class Reader {
+public:
+	Reader(const std::string& data, const size_t& pos, const size_t& end)
+		: data(data), pos(pos), end(end){}
+
+	uint8_t u8(){ return static_cast<uint8_t>(this->le(1)); }
+	uint16_t u16(){ return static_cast<uint16_t>(this->le(2)); }
+	uint32_t u32(){ return static_cast<uint32_t>(this->le(4)); }
+	uint64_t u64(){ return this->le(8); }
+	double f64(){
+
+		const uint64_t bits = this->u64();
+		double v;
+		std::memcpy(&v, &bits, sizeof(v));
+		return v;
+	}
+	template <size_t N>
+	void optionals(std::array<std::optional<uint32_t>, N>& values){
+
+		const uint64_t present = this->u64();
+		for(size_t i = 0; i < N; i++){
+			values[i] = (present & (1ULL << i)) ? std::optional<uint32_t>(this->u32()) : std::nullopt;
+		}
+	}
+	size_t position() const{ return this->pos; }
+	void skip(const size_t& bytes){
+
+		this->need(bytes);
+		this->pos += bytes;
+	}
+
+private:
+	const std::string& data;
+	size_t pos;
+	size_t end;
+
+	void need(const size_t& bytes) const{
+
+		if(this->pos + bytes > this->end){
+			throw std::runtime_error("Board state file truncated.");
+		}
+	}
+	uint64_t le(const int& bytes){
+
+		this->need(bytes);
+		uint64_t v = 0;
+		for(int i = 0; i < bytes; i++){
+			v |= static_cast<uint64_t>(static_cast<uint8_t>(this->data[this->pos + i])) << (8 * i);
+		}
+		this->pos += bytes;
+		return v;
+	}
+};
+}
+
+std::string BoardStateFile::serialize(const BoardStateSnapshot& snapshot){
+
+	Writer w;
+	w.out.append(kMagic, sizeof(kMagic));
+	w.u32(kVersion);
+	w.u64(snapshot.timestamp_ns);
+
+	size_t section = w.begin(kDaphneState);
+	w.optionals(snapshot.afeAttenuation);
+	w.optionals(snapshot.biasVoltage);
+	w.optionals(snapshot.channelTrim);
+	w.optionals(snapshot.channelOffset);
+	w.u8(snapshot.biasControl ? 1 : 0);
+	w.u32(snapshot.biasControl.value_or(0));
+	w.end(section);
+
+	section = w.begin(kAfeFunctions);
+	w.u32(static_cast<uint32_t>(snapshot.afeFunctions.size()));
+	for(const auto& function : snapshot.afeFunctions){
+		w.u8(function.afe);
+		w.u8(function.function);
+		w.u16(function.value);
+	}
+	w.end(section);
+
+	section = w.begin(kAfeRegisters);
+	w.u32(snapshot.afePowerState);
+	for(const auto& image : snapshot.afeRegisters){
+		w.u16(static_cast<uint16_t>(image.size()));
+		for(const auto& reg_ : image){
+			w.u16(static_cast<uint16_t>(reg_.first));
+			w.u16(static_cast<uint16_t>(reg_.second));
+		}
+	}
+	w.end(section);
+
+	section = w.begin(kFrontend);
+	for(size_t afe = 0; afe < BoardStateSnapshot::kAfes; afe++){
+		w.u16(static_cast<uint16_t>(snapshot.delay[afe]));
+		w.u16(static_cast<uint16_t>(snapshot.bitslip[afe]));
+	}
+	w.end(section);
+
+	section = w.begin(kTrigger);
+	for(const auto threshold : snapshot.triggerThreshold){
+		w.u32(threshold);
+	}
+	w.u32(snapshot.triggerMaskLow);
+	w.u32(snapshot.triggerMaskHigh);
+	w.end(section);
+
+	if(snapshot.triggerConfig){
+		section = w.begin(kTriggerConfig);
+		w.u64(snapshot.triggerConfig->fullConfig);
+		for(const auto template_ : snapshot.triggerConfig->matchingTemplates){
+			w.u32(template_);
+		}
+		w.end(section);
+	}
+
+	if(snapshot.hdMezz){
+		section = w.begin(kHdMezz);
+		for(const auto& block : *snapshot.hdMezz){
+			w.u8((block.enabled ? 1 : 0) | (block.power5V ? 2 : 0) | (block.power3V3 ? 4 : 0));
+			w.f64(block.rShunt5V);
+			w.f64(block.rShunt3V3);
+			w.f64(block.maxCurrentScale5V);
+			w.f64(block.maxCurrentScale3V3);
+			w.f64(block.maxCurrentShutdown5V);
+			w.f64(block.maxCurrentShutdown3V3);
+		}
+		w.end(section);
+	}
+
+	w.u32(crc32(w.out.data(), w.out.size()));
+	return w.out;
+}
+
+BoardStateSnapshot BoardStateFile::deserialize(const std::string& data){
+
+	const size_t headerSize = sizeof(kMagic) + 4 + 8;
+	if(data.size() < headerSize + 4 || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0){
+		throw std::runtime_error("Not a board state file.");
+	}
+	const size_t body = data.size() - 4;
+	if(Reader(data, body, data.size()).u32() != crc32(data.data(), body)){
+		throw std::runtime_error("Board state file checksum mismatch.");
+	}
+
+	Reader header(data, sizeof(kMagic), body);
+	const uint32_t version = header.u32();
+	if(version != kVersion){
+		throw std::runtime_error("Unsupported board state file version " + std::to_string(version) + ".");
+	}
+	BoardStateSnapshot snapshot;
+	snapshot.timestamp_ns = header.u64();
+
+	size_t pos = headerSize;
+	while(pos < body){
+		Reader tag(data, pos, body);
+		const uint16_t section = tag.u16();
+		const uint32_t length = tag.u32();
+		const size_t start = tag.position();
+		tag.skip(length);
+		Reader r(data, start, start + length);
+		switch(section){
+			case kDaphneState:
+				r.optionals(snapshot.afeAttenuation);
+				r.optionals(snapshot.biasVoltage);
+				r.optionals(snapshot.channelTrim);
+				r.optionals(snapshot.channelOffset);
+				{
+					const bool present = r.u8() != 0;
+					const uint32_t biasControl = r.u32();
+					if(present){
+						snapshot.biasControl = biasControl;
+					}
+				}
+				break;
+			case kAfeFunctions:{
+				const uint32_t count = r.u32();
+				for(uint32_t i = 0; i < count; i++){
+					BoardStateSnapshot::AfeFunctionValue function;
+					function.afe = r.u8();
+					function.function = r.u8();
+					function.value = r.u16();
+					snapshot.afeFunctions.push_back(function);
+				}
+				break;
+			}
+			case kAfeRegisters:
+				snapshot.afePowerState = r.u32();
+				for(auto& image : snapshot.afeRegisters){
+					const uint16_t count = r.u16();
+					for(uint16_t i = 0; i < count; i++){
+						const uint32_t register_ = r.u16();
+						image.emplace_back(register_, r.u16());
+					}
+				}
+				break;
+			case kFrontend:
+				for(size_t afe = 0; afe < BoardStateSnapshot::kAfes; afe++){
+					snapshot.delay[afe] = r.u16();
+					snapshot.bitslip[afe] = r.u16();
+				}
+				break;
+			case kTrigger:
+				for(auto& threshold : snapshot.triggerThreshold){
+					threshold = r.u32();
+				}
+				snapshot.triggerMaskLow = r.u32();
+				snapshot.triggerMaskHigh = r.u32();
+				break;
+			case kHdMezz:{
+				std::array<BoardStateSnapshot::HdMezzBlock, BoardStateSnapshot::kAfes> blocks{};
+				for(auto& block : blocks){
+					const uint8_t flags = r.u8();
+					block.enabled = (flags & 1) != 0;
+					block.power5V = (flags & 2) != 0;
+					block.power3V3 = (flags & 4) != 0;
+					block.rShunt5V = r.f64();
+					block.rShunt3V3 = r.f64();
+					block.maxCurrentScale5V = r.f64();
+					block.maxCurrentScale3V3 = r.f64();
+					block.maxCurrentShutdown5V = r.f64();
+					block.maxCurrentShutdown3V3 = r.f64();
+				}
+				snapshot.hdMezz = blocks;
+				break;
+			}
+			case kTriggerConfig:{
+				BoardStateSnapshot::TriggerConfig config;
+				config.fullConfig = r.u64();
+				for(auto& template_ : config.matchingTemplates){
+					template_ = r.u32();
+				}
+				snapshot.triggerConfig = config;
+				break;
+			}
+			default:
+				break; // newer section, skipped
+		}
+		pos = start + length;
+	}
+	return snapshot;
+}
+
+bool BoardStateFile::save(const std::string& path, const BoardStateSnapshot& snapshot, std::string& error, size_t* bytes){
+
+	const std::string data = BoardStateFile::serialize(snapshot);
+	const std::string tmpPath = path + ".tmp";
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		if(!out){
+			error = "cannot write " + tmpPath;
+			return false;
+		}
+		out.write(data.data(), static_cast<std::streamsize>(data.size()));
+		if(!out.flush()){
+			error = "failed writing " + tmpPath;
+			return false;
+		}
+	}
+	if(std::rename(tmpPath.c_str(), path.c_str()) != 0){
+		error = "cannot replace " + path;
+		return false;
+	}
+	if(bytes){
+		*bytes = data.size();
+	}
+	return true;
+}
+
+std::optional<BoardStateSnapshot> BoardStateFile::load(const std::string& path, std::string& error){
+
+	std::ifstream in(path, std::ios::binary);
+	if(!in){
+		error = "cannot open " + path;
+		return std::nullopt;
+	}
+	const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	try{
+		return BoardStateFile::deserialize(data);
+	}catch(const std::exception& e){
+		error = path + ": " + e.what();
+		return std::nullopt;
+	}
+}
@@ -0,0 +1,86 @@
+#ifndef BOARDSTATE_HPP
+#define BOARDSTATE_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Everything needed to bring a board back to its programmed state after a
+// daphneServer restart. AFE indices are frontend (PL) numbers; values that were
+// never programmed are left empty and are not restored.
+struct BoardStateSnapshot {
+    static constexpr uint32_t kAfes = 5;
+    static constexpr uint32_t kChannels = 40;
+
+    struct AfeFunctionValue {
+        uint8_t afe = 0;
+        uint8_t function = 0;   // afe_definitions::AfeFunction
+        uint16_t value = 0;
+    };
+
+    struct TriggerConfig {
+        uint64_t fullConfig = 0;                      // selfTriggerFullConfigHIGH:Low
+        std::array<uint32_t, 16> matchingTemplates{};  // matchingTriggerTemplate_0..15
+    };
+
+    struct HdMezzBlock {
+        bool enabled = false;
+        bool power5V = false;
+        bool power3V3 = false;
+        double rShunt5V = 0.0;
+        double rShunt3V3 = 0.0;
+        double maxCurrentScale5V = 0.0;
+        double maxCurrentScale3V3 = 0.0;
+        double maxCurrentShutdown5V = 0.0;
+        double maxCurrentShutdown3V3 = 0.0;
+    };
+
+    uint64_t timestamp_ns = 0;
+
+    // Programmed values kept by Daphne.
+    std::array<std::optional<uint32_t>, kAfes> afeAttenuation{};
+    std::array<std::optional<uint32_t>, kAfes> biasVoltage{};
+    std::array<std::optional<uint32_t>, kChannels> channelTrim{};
+    std::array<std::optional<uint32_t>, kChannels> channelOffset{};
+    std::optional<uint32_t> biasControl;
+    std::vector<AfeFunctionValue> afeFunctions;
+
+    // AFE5808 register shadows, {register, value} sorted by register.
+    uint32_t afePowerState = 0;
+    std::array<std::vector<std::pair<uint32_t, uint32_t>>, kAfes> afeRegisters{};
+
+    // Frontend alignment.
+    std::array<uint32_t, kAfes> delay{};
+    std::array<uint32_t, kAfes> bitslip{};
+
+    // Self-trigger thresholds and enable masks.
+    std::array<uint32_t, kChannels> triggerThreshold{};
+    uint32_t triggerMaskLow = 0;
+    uint32_t triggerMaskHigh = 0;
+    // Empty in files written before it was saved; then left as it is.
+    std::optional<TriggerConfig> triggerConfig;
+
+    // Empty when the HD mezzanine driver was unavailable.
+    std::optional<std::array<HdMezzBlock, kAfes>> hdMezz;
+};
+
+// Compact binary snapshot file: magic, format version, then tagged sections
+// (tag, length, payload) in little-endian order and a CRC-32 of everything
+// before it. Readers skip sections they do not know, so new sections can be
+// added without a version bump. Files are written tmp + rename.
+class BoardStateFile {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    static std::string serialize(const BoardStateSnapshot& snapshot);
+    // Throws std::runtime_error on a bad magic, version, length or checksum.
+    static BoardStateSnapshot deserialize(const std::string& data);
+
+    static bool save(const std::string& path, const BoardStateSnapshot& snapshot, std::string& error, size_t* bytes = nullptr);
+    static std::optional<BoardStateSnapshot> load(const std::string& path, std::string& error);
+};
+
+#endif // BOARDSTATE_HPP
@@ -0,0 +1,221 @@
+#include "CompletionWaiter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+constexpr uint64_t kFallbackTimeoutNs = 10000000;   // until enough samples exist (former fixed 10 ms)
+constexpr uint64_t kMinSamples = 64;                // completions before the p99 timeout is used
+constexpr uint64_t kRefreshEvery = 64;              // completions between percentile refreshes
+constexpr uint64_t kTimeoutP99Factor = 16;
+constexpr uint64_t kTimeoutFloorNs = 1000000;
+constexpr uint64_t kTimeoutCeilingNs = 100000000;
+constexpr uint64_t kDefaultSpinNs = 20000;
+constexpr uint64_t kMinSpinNs = 2000;
+constexpr uint64_t kMaxSpinNs = 50000;
+constexpr uint64_t kFirstSleepUs = 10;
+constexpr uint64_t kMaxSleepUs = 1000;
+
+inline void cpuRelax(){
+
+#if defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+size_t bucketOf(uint64_t ns){
+
+	size_t bucket = 0;
+	while(ns > 1 && bucket < CompletionWaiter::kBuckets - 1){
+		ns >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+// Upper edge of the bucket holding the q-quantile; 0 without samples.
+uint64_t percentileNs(const std::array<uint64_t, CompletionWaiter::kBuckets>& histogram, const uint64_t& count, const double& q){
+
+	if(count == 0){
+		return 0;
+	}
+	const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.999999));
+	uint64_t cumulative = 0;
+	for(size_t i = 0; i < histogram.size(); i++){
+		cumulative += histogram[i];
+		if(cumulative >= rank){
+			return 1ULL << (i + 1);
+		}
+	}
+	return 1ULL << histogram.size();
+}
+}
+
+struct CompletionWaiter::Channel {
+	std::string device;
+	std::string regName;
+	uint32_t mask = 0;
+	std::atomic<uint64_t> timeoutNs{kFallbackTimeoutNs};
+	std::atomic<uint64_t> spinNs{kDefaultSpinNs};
+
+	mutable std::mutex mutex;
+	std::array<uint64_t, CompletionWaiter::kBuckets> histogram{};
+	uint64_t completions = 0;
+	uint64_t timeouts = 0;
+	uint64_t max_ns = 0;
+
+	void record(const uint64_t& ns){
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->histogram[bucketOf(ns)]++;
+		this->completions++;
+		this->max_ns = std::max(this->max_ns, ns);
+		if(this->completions >= kMinSamples && this->completions % kRefreshEvery == 0){
+			const uint64_t p99 = percentileNs(this->histogram, this->completions, 0.99);
+			this->timeoutNs.store(std::clamp(kTimeoutP99Factor * p99, kTimeoutFloorNs, kTimeoutCeilingNs));
+			this->spinNs.store(std::clamp(p99, kMinSpinNs, kMaxSpinNs));
+		}
+	}
+};
+
+struct CompletionWaiter::Registry {
+	std::mutex mutex;   // serialises registration only
+	std::array<std::atomic<Channel*>, kMaxDevices> channels{};
+	std::atomic<size_t> count{0};
+};
+
+CompletionWaiter::Registry& CompletionWaiter::registry(){
+
+	// Never destroyed: waiters may be used from threads that outlive static teardown.
+	static Registry* instance = new Registry();
+	return *instance;
+}
+
+CompletionWaiter::CompletionWaiter(const std::string& device, FpgaReg& fpgaReg, const std::string& regName, const std::string& bitName)
+	: busyRegister(fpgaReg.getRegisterPointer(regName, bitName, 0)),
+	busyMask(fpgaReg.getBitMask(regName, bitName)),
+	channel(nullptr){
+
+	if(this->busyRegister == nullptr){
+		throw std::invalid_argument("Busy register " + regName + "." + bitName + " not found.");
+	}
+
+	Registry& reg = CompletionWaiter::registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	const size_t count = reg.count.load();
+	for(size_t i = 0; i < count; i++){
+		Channel* existing = reg.channels[i].load();
+		if(existing->device == device){
+			if(existing->regName != regName || existing->mask != this->busyMask){
+				throw std::invalid_argument("Busy device " + device + " already registered with a different bit field.");
+			}
+			this->channel = existing;
+			return;
+		}
+	}
+	if(count >= kMaxDevices){
+		throw std::runtime_error("Too many busy devices registered.");
+	}
+	Channel* created = new Channel();   // lives for the rest of the process, like the registry
+	created->device = device;
+	created->regName = regName;
+	created->mask = this->busyMask;
+	reg.channels[count].store(created);
+	reg.count.store(count + 1);
+	this->channel = created;
+}
+
+CompletionWaiter::~CompletionWaiter(){}
+
+bool CompletionWaiter::isBusy() const{
+
+	return (*this->busyRegister & this->busyMask) != 0;
+}
+
+bool CompletionWaiter::poll(const double& timeout, uint64_t& elapsed_ns) const{
+
+	const uint64_t limitNs = (timeout > 0.0) ? static_cast<uint64_t>(timeout * 1e9) : this->channel->timeoutNs.load();
+	const uint64_t spinNs = this->channel->spinNs.load();
+	const auto t0 = std::chrono::steady_clock::now();
+	uint64_t sleepUs = kFirstSleepUs;
+
+	while(true){
+		const bool busy = this->isBusy();
+		elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+		if(!busy){
+			return true;
+		}
+		if(elapsed_ns > limitNs){
+			// Re-check once: the thread may just have been descheduled past the limit.
+			return !this->isBusy();
+		}
+		if(elapsed_ns < spinNs){
+			cpuRelax();
+		}else{
+			std::this_thread::sleep_for(std::chrono::microseconds(sleepUs));
+			sleepUs = std::min(2 * sleepUs, kMaxSleepUs);
+		}
+	}
+}
+
+bool CompletionWaiter::waitIdle(const double& timeout){
+
+	uint64_t elapsed_ns = 0;
+	if(!this->poll(timeout, elapsed_ns)){
+		std::lock_guard<std::mutex> lock(this->channel->mutex);
+		this->channel->timeouts++;
+		return false;
+	}
+	return true;
+}
+
+bool CompletionWaiter::waitComplete(const double& timeout){
+
+	uint64_t elapsed_ns = 0;
+	if(!this->poll(timeout, elapsed_ns)){
+		std::lock_guard<std::mutex> lock(this->channel->mutex);
+		this->channel->timeouts++;
+		return false;
+	}
+	this->channel->record(elapsed_ns);
+	return true;
+}
+
+CompletionWaiter::Stats CompletionWaiter::collect(const Channel& channel){
+
+	Stats stats;
+	stats.device = channel.device;
+	stats.timeout_ns = channel.timeoutNs.load();
+	{
+		std::lock_guard<std::mutex> lock(channel.mutex);
+		stats.completions = channel.completions;
+		stats.timeouts = channel.timeouts;
+		stats.max_ns = channel.max_ns;
+		stats.histogram = channel.histogram;
+	}
+	stats.p50_ns = percentileNs(stats.histogram, stats.completions, 0.50);
+	stats.p99_ns = percentileNs(stats.histogram, stats.completions, 0.99);
+	return stats;
+}
+
+CompletionWaiter::Stats CompletionWaiter::getStats() const{
+
+	return CompletionWaiter::collect(*this->channel);
+}
+
+std::vector<CompletionWaiter::Stats> CompletionWaiter::getAllStats(){
+
+	Registry& reg = CompletionWaiter::registry();
+	std::vector<Stats> all;
+	const size_t count = reg.count.load();
+	for(size_t i = 0; i < count; i++){
+		all.push_back(CompletionWaiter::collect(*reg.channels[i].load()));
+	}
+	return all;
+}
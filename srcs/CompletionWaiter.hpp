@@ -0,0 +1,63 @@
+#ifndef COMPLETIONWAITER_HPP
+#define COMPLETIONWAITER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FpgaReg.hpp"
+
+// Waits for a memory-mapped busy bit to clear. It spins briefly on a register
+// pointer resolved once at construction, then backs off exponentially.
+// Completion times are kept in a per-device log2 histogram. Once enough samples
+// exist, the timeout follows the measured p99 instead of a fixed value.
+// State is shared per device name across the process, so separate Spi/Dac
+// instances driving the same bus see one histogram.
+class CompletionWaiter {
+public:
+    static constexpr size_t kBuckets = 32;   // bucket i: [2^i, 2^(i+1)) ns
+    static constexpr size_t kMaxDevices = 16;
+
+    struct Stats {
+        std::string device;
+        uint64_t completions = 0;
+        uint64_t timeouts = 0;
+        uint64_t p50_ns = 0;
+        uint64_t p99_ns = 0;
+        uint64_t max_ns = 0;
+        uint64_t timeout_ns = 0;
+        std::array<uint64_t, kBuckets> histogram{};
+    };
+
+    // Constructor. fpgaReg must outlive the waiter (the register pointer is cached).
+    CompletionWaiter(const std::string& device, FpgaReg& fpgaReg, const std::string& regName, const std::string& bitName);
+
+    // Destructor
+    ~CompletionWaiter();
+
+    bool isBusy() const;
+    // Before a transaction: waits for the busy bits to clear. Raw register
+    // writes can start the engine behind Spi/Dac, so the bits are always read.
+    // A timeout <= 0 uses the adaptive timeout.
+    bool waitIdle(const double& timeout = 0.0);
+    // After a transaction: waits for it and records the completion time.
+    bool waitComplete(const double& timeout = 0.0);
+
+    Stats getStats() const;
+    static std::vector<Stats> getAllStats();
+
+private:
+    struct Channel;
+    struct Registry;
+
+    const volatile uint32_t* busyRegister;
+    uint32_t busyMask;
+    Channel* channel;
+
+    static Registry& registry();
+    static Stats collect(const Channel& channel);
+    bool poll(const double& timeout, uint64_t& elapsed_ns) const;
+};
+
+#endif // COMPLETIONWAITER_HPP
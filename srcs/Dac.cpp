@@ -2,7 +2,9 @@
 
 Dac::Dac()
 	: spi(std::make_unique<Spi>()){
-   
+
+	this->busy = std::make_unique<CompletionWaiter>("dac_gain_bias", *this->spi->getFpgaReg(), "dacGainBiasControl", "BUSY");
+
 	std::unordered_map<uint32_t, uint32_t> channelValues = {
         {0, 0},
         {1, 0},
@@ -31,26 +33,13 @@ Dac::~Dac(){}
 
 bool Dac::isBusy(){
 
-	return this->spi->getFpgaReg()->getBits("dacGainBiasControl", "BUSY");
+	return this->busy->isBusy();
 }
 
 bool Dac::waitNotBusy(const double& timeout){
 
-	auto t0 = std::chrono::high_resolution_clock::now();
-
-	while(true){
-		if(!this->isBusy()){
-			break;
-		}
-
-		std::this_thread::sleep_for(std::chrono::microseconds(10));
-
-		auto t1 = std::chrono::high_resolution_clock::now();
-		std::chrono::duration<double> elapsed = t1 - t0;
-
-		if(elapsed.count() > timeout){
-			throw std::runtime_error("Timeout while waiting DAC write");
-		}
+	if(!this->busy->waitIdle(timeout)){
+		throw std::runtime_error("Timeout while waiting DAC write");
 	}
 	return 0;
 }
@@ -64,12 +53,13 @@ uint32_t Dac::triggerWrite(){
 uint32_t Dac::setDacGeneral(const std::string& chip, const uint32_t& channel, const bool& gain, const bool& buffer, const uint32_t& value){
 
 	this->waitNotBusy();
-	this->spi->getFpgaReg()->setBits("dacGainBias" + chip, "CHANNEL", (uint32_t)channel);
-    this->spi->getFpgaReg()->setBits("dacGainBias" + chip, "GAIN", (uint32_t)gain);
-    this->spi->getFpgaReg()->setBits("dacGainBias" + chip, "BUFFER", (uint32_t)buffer);
-    uint32_t returnedValue = this->spi->getFpgaReg()->setBits("dacGainBias" + chip, "DATA", value);
+	// CHANNEL[15:14] GAIN[13] BUFFER[12] DATA[11:0], written as one word instead of four read-modify-writes.
+	uint32_t word = (channel & 0x3) << 14 | (uint32_t)gain << 13 | (uint32_t)buffer << 12 | (value & 0xFFF);
+	uint32_t returnedValue = this->spi->getFpgaReg()->writeRegister("dacGainBias" + chip, word) & 0xFFF;
 	this->triggerWrite();
-	this->waitNotBusy();
+	if(!this->busy->waitComplete()){
+		throw std::runtime_error("Timeout while waiting DAC write");
+	}
 	return returnedValue;
 }
 
@@ -143,6 +133,18 @@ uint32_t Dac::setDacOffset(const uint32_t& afe, const uint32_t& ch, const uint32
 	return this->updateCurrentRegister(register_, ch, value, gain, buffer);
 }
 
+uint32_t Dac::setTrims(const uint32_t& afe, const std::array<uint32_t, 8>& values, const bool& gain, const bool& buffer, const uint8_t& channelMask){
+
+	std::string register_ = "afeDacTrim_" + std::to_string(afe);
+	return this->updateRegisterPairs(register_, values, gain, buffer, channelMask);
+}
+
+uint32_t Dac::setOffsets(const uint32_t& afe, const std::array<uint32_t, 8>& values, const bool& gain, const bool& buffer, const uint8_t& channelMask){
+
+	std::string register_ = "afeDacOffset_" + std::to_string(afe);
+	return this->updateRegisterPairs(register_, values, gain, buffer, channelMask);
+}
+
 uint32_t Dac::setDacTrimOffset(const std::string& what, const uint32_t& afe,const uint32_t& channelH,const uint32_t& valueH,const uint32_t& channelL,const uint32_t& valueL, const bool& gain, const bool& buffer){
 
 	std::string register_ = "afeDac" + what + "_" + std::to_string(afe);
@@ -197,3 +199,36 @@ uint32_t Dac::updateCurrentRegister(const std::string& reg_name, const uint32_t&
 	return this->spi->setData(reg_name, dataToWrite);
 }
 
+uint32_t Dac::updateRegisterPairs(const std::string& reg_name, const std::array<uint32_t, 8>& values, const bool& gain, const bool& buffer, const uint8_t& channelMask){
+
+	const auto &register_values_it = this->channelValues.find(reg_name);
+	if (register_values_it == this->channelValues.end()) {
+		throw std::invalid_argument("Register " + reg_name + " not found in the DAC register values dictionary.");
+	}
+	auto &register_channel_values_dict = register_values_it->second;
+
+	uint32_t writes = 0;
+	for(const auto &chMap : this->CHANNEL_MAPPING){
+		if(std::get<0>(chMap.second) != "L"){
+			continue;
+		}
+		const uint32_t chL = chMap.first;
+		const uint32_t chH = this->findCompanionChannelValue(chL);
+		const bool writeL = (channelMask >> chL) & 0x1;
+		const bool writeH = (channelMask >> chH) & 0x1;
+		if(!writeL && !writeH){
+			continue;
+		}
+		const uint32_t chipCh = std::get<1>(chMap.second);
+		if(writeL){
+			register_channel_values_dict[chL] = (chipCh & 0x3) << 14 | (uint32_t)gain << 13 | (uint32_t)buffer << 12 | (values[chL] & 0xFFF);
+		}
+		if(writeH){
+			register_channel_values_dict[chH] = (chipCh & 0x3) << 14 | (uint32_t)gain << 13 | (uint32_t)buffer << 12 | (values[chH] & 0xFFF);
+		}
+		uint32_t dataToWrite = (register_channel_values_dict[chH] & 0xFFFF) << 16 | (register_channel_values_dict[chL] & 0xFFFF);
+		this->spi->setData(reg_name, dataToWrite);
+		writes++;
+	}
+	return writes;
+}
@@ -14,6 +14,7 @@
 #include <exception>
 #include <map>
 #include <tuple>
+#include <array>
 
 #include "Spi.hpp"
 
@@ -32,12 +33,18 @@ public:
     uint32_t setDacOffset(const uint32_t& afe,const uint32_t& ch,const uint32_t& value, const bool& gain, const bool& buffer);
     uint32_t setDacTrimOffset(const std::string& what, const uint32_t& afe,const uint32_t& channelH,const uint32_t& valueH,const uint32_t& channelL,const uint32_t& valueL, const bool& gain = false, const bool& buffer = false);
     uint32_t setBiasEnable(const bool &enable);
+    // Bulk per-AFE programming: one SPI write per H/L channel pair (4 instead of 8).
+    // Channels outside channelMask keep their last programmed value; pairs with no
+    // masked channel are not written. Returns the number of SPI writes.
+    uint32_t setTrims(const uint32_t& afe, const std::array<uint32_t, 8>& values, const bool& gain = false, const bool& buffer = false, const uint8_t& channelMask = 0xFF);
+    uint32_t setOffsets(const uint32_t& afe, const std::array<uint32_t, 8>& values, const bool& gain = false, const bool& buffer = false, const uint8_t& channelMask = 0xFF);
 
 private:
     using TupleEntry_GainBias = std::tuple<std::string, uint32_t, bool, bool>;
     using TupleEntry_ChMapping = std::tuple<std::string, uint32_t>;
 
     std::unique_ptr<Spi> spi;
+    std::unique_ptr<CompletionWaiter> busy;
 
     std::unordered_map<std::string, std::unordered_map<uint32_t, uint32_t>> channelValues;
     // This mapping has to be verified!!!!
@@ -67,12 +74,13 @@ private:
     };
 
     bool isBusy();
-    bool waitNotBusy(const double& timeout = 0.01);
+    bool waitNotBusy(const double& timeout = 0.0);
     uint32_t triggerWrite();
     uint32_t setDacGeneral(const std::string& chip, const uint32_t& channel, const bool& gain = false, const bool& buffer = false, const uint32_t& value = 0);
     uint32_t setDacGainBias(const std::string& what, const uint32_t& afe, const uint32_t& value);
     uint32_t findCompanionChannelValue(const uint32_t& ch);
     uint32_t updateCurrentRegister(const std::string& reg_name, const uint32_t& ch, const uint32_t& value, const bool& gain, const bool& buffer);
+    uint32_t updateRegisterPairs(const std::string& reg_name, const std::array<uint32_t, 8>& values, const bool& gain, const bool& buffer, const uint8_t& channelMask);
 };
 
 #endif // DACTRIMOFFSET_HPP
\ No newline at end of file
@@ -5,9 +5,15 @@
 
 Daphne::Daphne()
 	: afe(std::make_unique<Afe>()),
+	  spiScheduler(std::make_unique<SpiScheduler>(*afe)),
 	  dac(std::make_unique<Dac>()),
 	  frontend(std::make_unique<FrontEnd>()),
-	  spyBuffer(std::make_unique<SpyBuffer>())
+	  spyBuffer(std::make_unique<SpyBuffer>()),
+	  triggerBlock(std::make_unique<TriggerBlock>()),
+	  monitoringHistory(std::make_unique<MonitoringHistory>()),
+	  monitoringSeries(std::make_unique<MonitoringSeries>()),
+	  i2c1Bus(std::make_unique<I2CBusExecutor>("i2c-1")),
+	  i2c2Bus(std::make_unique<I2CBusExecutor>("i2c-2"))
 	{
 		this->initRegDictHistory();
 
@@ -48,18 +54,8 @@ Daphne::Daphne()
 			std::cerr << "Warning: ADS7138 (0x17) unavailable: " << e.what() << std::endl;
 			ads7138driver_addr_0x17.reset();
 		}
-		this->isI2C_1_device_configuring.store(false);
-		this->isI2C_2_device_configuring.store(false);
-		this->user_vbias_voltage_request.store(false);
-		this->is_vbias_voltage_monitor_reading.store(false);
-		for(size_t i = 0; i < 5; i++){
-			this->HDMezz_5V_voltage[i].store(0.0);
-			this->HDMezz_5V_current[i].store(0.0);
-			this->HDMezz_3V3_voltage[i].store(0.0);
-			this->HDMezz_3V3_current[i].store(0.0);
-			this->HDMezz_5V_power[i].store(0.0);
-			this->HDMezz_3V3_power[i].store(0.0);
-		}
+		this->activeClientAcquisitions.store(0);
+		this->last_client_acquisition_ns.store(0);
 	}
 
 Daphne::~Daphne(){}
@@ -69,6 +65,11 @@ Afe* Daphne::getAfe(){
 	return this->afe.get();
 }
 
+SpiScheduler* Daphne::getSpiScheduler(){
+
+	return this->spiScheduler.get();
+}
+
 Dac* Daphne::getDac(){
 
 	return this->dac.get();
@@ -84,6 +85,11 @@ SpyBuffer* Daphne::getSpyBuffer(){
 	return this->spyBuffer.get();
 }
 
+TriggerBlock* Daphne::getTriggerBlock(){
+
+	return this->triggerBlock.get();
+}
+
 I2CMezzDrivers::HDMezzDriver* Daphne::getHDMezzDriver(){
 
 	return this->hdmezzdriver.get();
@@ -107,42 +113,49 @@ CurrentMonitorDrivers::CurrentMonitor* Daphne::getCurrentMonitorDriver(){
 	return this->current_monitor.get();
 }
 
-std::optional<std::pair<uint32_t, uint32_t>> Daphne::longestIdenticalSubsequenceIndices(const std::vector<uint32_t>& nums){
+I2CBusExecutor* Daphne::getI2C1Bus(){
 
-	if(nums.empty()){
-		return std::nullopt;
-	}
+	return this->i2c1Bus.get();
+}
 
-	uint32_t maxLength = 1;
-	uint32_t maxStartIndex = 0;
-	uint32_t currentLength = 1;
-	uint32_t currentStartIndex = 0;
+I2CBusExecutor* Daphne::getI2C2Bus(){
 
-	for(int i = 1; i < nums.size(); i++){
+	return this->i2c2Bus.get();
+}
 
-		if(nums[i] == nums[i - 1]){
+MonitoringHistory* Daphne::getMonitoringHistory(){
 
-			currentLength += 1;
-		}else{
+	return this->monitoringHistory.get();
+}
 
-			if(currentLength > maxLength){
+MonitoringSeries* Daphne::getMonitoringSeries(){
 
-				maxLength = currentLength;
-                maxStartIndex = currentStartIndex;
-			}
+	return this->monitoringSeries.get();
+}
 
-			currentLength = 1;
-            currentStartIndex = i;
-		}
-	}
+AlignmentCache* Daphne::getAlignmentCache(){
 
-	if(currentLength > maxLength){
+	return this->alignmentCache.get();
+}
 
-		maxLength = currentLength;
-        maxStartIndex = currentStartIndex;
-	}
+void Daphne::enableAlignmentCache(const std::string& path){
+
+	this->alignmentCache = std::make_unique<AlignmentCache>(path);
+}
+
+AlignmentCacheKey Daphne::getAlignmentCacheKey(const double& temperature_C){
 
-	return std::make_pair(maxStartIndex, maxStartIndex + maxLength - 1);
+	AlignmentCacheKey key;
+	key.git = this->frontend->getFirmwareGit();
+	key.slot = this->frontend->getSlotId();
+	key.crate = this->frontend->getCrateId();
+	key.temperatureBand = AlignmentCache::temperatureBand(temperature_C);
+	return key;
+}
+
+std::optional<std::pair<uint32_t, uint32_t>> Daphne::longestIdenticalSubsequenceIndices(const std::vector<uint32_t>& nums){
+
+	return AlignmentEngine::longestIdenticalSubsequenceIndices(nums);
 }
 
 std::vector<uint32_t> Daphne::scanGeneric(const uint32_t& afe,const std::string& what,const uint32_t& taps, std::function<uint32_t(const uint32_t&, const uint32_t&)> setFunc){
@@ -194,6 +207,76 @@ uint32_t Daphne::setBestDelay(const uint32_t& afe, const size_t& delayTaps, std:
 	return this->frontend->setDelay(afe, bestDelay);
 }
 
+bool Daphne::setBestDelayLocal(const uint32_t& afe, const uint32_t& radius, std::string* debug_out){
+
+	// Incremental variant of setBestDelay: only taps within +/- radius of the
+	// current value are scanned and the window must hold the aligned word itself,
+	// since the bitslip is left untouched.
+	constexpr uint32_t kTarget32 = 0x00FF00FFu;
+	constexpr uint32_t kMaxDelay = 511;
+	const uint32_t currentDelay = this->frontend->getDelay(afe);
+	const uint32_t firstTap = currentDelay > radius ? currentDelay - radius : 0;
+	const uint32_t lastTap = std::min(kMaxDelay, currentDelay + radius);
+
+	std::vector<uint32_t> data = this->scanGeneric( afe,
+												   "delay",
+												    lastTap - firstTap + 1,
+												    [this, firstTap](const uint32_t& a, const uint32_t& b) { return this->frontend->setDelay(a, firstTap + b);}
+												    );
+
+	uint32_t bestStart = 0;
+	uint32_t bestLength = 0;
+	uint32_t runStart = 0;
+	uint32_t runLength = 0;
+	for(uint32_t i = 0; i < data.size(); i++){
+		if(data[i] == kTarget32){
+			if(runLength == 0){
+				runStart = i;
+			}
+			runLength++;
+			if(runLength > bestLength){
+				bestLength = runLength;
+				bestStart = runStart;
+			}
+		}else{
+			runLength = 0;
+		}
+	}
+
+	const bool matched = (bestLength > 0);
+	uint32_t bestDelay = currentDelay;
+	if(matched){
+		bestDelay = firstTap + bestStart + (bestLength - 1) / 2;
+	}else{
+		// No aligned word in range: fall back to the longest stable window so a
+		// following bitslip scan starts from a sane tap.
+		std::optional<std::pair<uint32_t, uint32_t>> window = this->longestIdenticalSubsequenceIndices(data);
+		if(window.has_value()){
+			bestDelay = firstTap + window.value().first + (window.value().second - window.value().first) / 2;
+		}
+	}
+
+	if (debug_out) {
+		std::ostringstream os;
+		os << "  LOCAL_DELAY_SCAN " << firstTap << ".." << lastTap
+		   << " around " << currentDelay;
+		if (matched) {
+			os << ", aligned window " << firstTap + bestStart << ".." << firstTap + bestStart + bestLength - 1
+			   << " (len=" << bestLength << ")";
+			if (bestStart == 0 || bestStart + bestLength == data.size()) {
+				os << " clipped by search range";
+			}
+		} else {
+			os << ", no aligned word in range";
+		}
+		os << ", best=" << bestDelay << "\n";
+		*debug_out = os.str();
+	}
+
+	this->frontend->setDelay(afe, bestDelay);
+	return matched;
+}
+
 template <typename T>
 int Daphne::findIndex(const std::vector<T>& data, const T& target){
 
@@ -250,6 +333,23 @@ uint32_t Daphne::setBestBitslip(const uint32_t& afe, const size_t& bitslipTaps,
 	return value;
 }
 
+std::array<AfeAlignment, 5> Daphne::alignAllAfes(const uint32_t& delayTaps, const uint32_t& bitslipTaps, uint32_t* triggers_out){
+
+	HardwareAlignmentProbe probe(*this->frontend, *this->spyBuffer);
+	AlignmentEngine engine(probe, delayTaps, 16, bitslipTaps);
+	std::array<AfeAlignment, 5> result = engine.align();
+	if (triggers_out) {
+		*triggers_out = engine.getTriggerCount();
+	}
+	return result;
+}
+
+std::array<uint32_t, 5> Daphne::readFrameClocks(){
+
+	HardwareAlignmentProbe probe(*this->frontend, *this->spyBuffer);
+	return probe.snapshot();
+}
+
 double Daphne::calcInputVoltage(const double& value, const double& vGain_mV){
 
 	double gain_dB = 0.0;
@@ -291,32 +391,12 @@ void Daphne::initRegDictHistory() {
 
 	this->afe->setRegisterList(kAfeRegisterList);
 
-	{
-		std::lock_guard<std::mutex> lock(this->state_mutex_);
-		this->state_.clear();
-		this->state_[{StateKey::Kind::kBiasControl, 0, 0}] = 0;
-	}
-}
-
-void Daphne::setAfeRegDictValue(const uint32_t& afe, const uint32_t &regAddr, const uint32_t &regValue) {
-
-	if (afe > 4) {
-		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
-	}
-
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	this->state_[{StateKey::Kind::kAfeReg, afe, regAddr}] = regValue;
+	this->state_.clear();
 }
 
 uint32_t Daphne::getAfeRegDictValue(const uint32_t& afe, const uint32_t &regAddr){
 
-	if (afe > 4) {
-		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
-	}
-
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	auto it = this->state_.find({StateKey::Kind::kAfeReg, afe, regAddr});
-	return (it == this->state_.end()) ? 0u : it->second;
+	return this->afe->getShadowRegister(afe, regAddr);
 }
 
 void Daphne::setAfeAttenuationDictValue(const uint32_t& afe, const uint32_t &attenuation) {
@@ -325,8 +405,7 @@ void Daphne::setAfeAttenuationDictValue(const uint32_t& afe, const uint32_t &att
 		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	this->state_[{StateKey::Kind::kAfeAttenuation, afe, 0}] = attenuation;
+	this->state_.set(DaphneState::Field::kAfeAttenuation, afe, attenuation);
 }
 
 uint32_t Daphne::getAfeAttenuationDictValue(const uint32_t& afe) {
@@ -335,9 +414,7 @@ uint32_t Daphne::getAfeAttenuationDictValue(const uint32_t& afe) {
 		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	auto it = this->state_.find({StateKey::Kind::kAfeAttenuation, afe, 0});
-	return (it == this->state_.end()) ? 0u : it->second;
+	return this->state_.find(DaphneState::Field::kAfeAttenuation, afe).value_or(0u);
 }
 
 void Daphne::setChOffsetDictValue(const uint32_t &ch, const uint32_t &offset) {
@@ -345,8 +422,7 @@ void Daphne::setChOffsetDictValue(const uint32_t &ch, const uint32_t &offset) {
 		throw std::out_of_range("Channel index " + std::to_string(ch) + " out of range. Expected range 0-39.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	this->state_[{StateKey::Kind::kChannelOffset, ch, 0}] = offset;
+	this->state_.set(DaphneState::Field::kChannelOffset, ch, offset);
 }
 
 uint32_t Daphne::getChOffsetDictValue(const uint32_t& ch) {
@@ -355,9 +431,7 @@ uint32_t Daphne::getChOffsetDictValue(const uint32_t& ch) {
 		throw std::out_of_range("Channel index " + std::to_string(ch) + " out of range. Expected range 0-39.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	auto it = this->state_.find({StateKey::Kind::kChannelOffset, ch, 0});
-	return (it == this->state_.end()) ? 0u : it->second;
+	return this->state_.find(DaphneState::Field::kChannelOffset, ch).value_or(0u);
 }
 
 void Daphne::setChTrimDictValue(const uint32_t &ch, const uint32_t &trim) {
@@ -365,8 +439,7 @@ void Daphne::setChTrimDictValue(const uint32_t &ch, const uint32_t &trim) {
 		throw std::out_of_range("Channel index " + std::to_string(ch) + " out of range. Expected range 0-39.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	this->state_[{StateKey::Kind::kChannelTrim, ch, 0}] = trim;
+	this->state_.set(DaphneState::Field::kChannelTrim, ch, trim);
 }
 
 uint32_t Daphne::getChTrimDictValue(const uint32_t& ch) {
@@ -375,9 +448,7 @@ uint32_t Daphne::getChTrimDictValue(const uint32_t& ch) {
 		throw std::out_of_range("Channel index " + std::to_string(ch) + " out of range. Expected range 0-39.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	auto it = this->state_.find({StateKey::Kind::kChannelTrim, ch, 0});
-	return (it == this->state_.end()) ? 0u : it->second;
+	return this->state_.find(DaphneState::Field::kChannelTrim, ch).value_or(0u);
 }
 
 void Daphne::setBiasVoltageDictValue(const uint32_t& afe, const uint32_t &biasVoltage) {
@@ -386,8 +457,7 @@ void Daphne::setBiasVoltageDictValue(const uint32_t& afe, const uint32_t &biasVo
 		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	this->state_[{StateKey::Kind::kBiasVoltage, afe, 0}] = biasVoltage;
+	this->state_.set(DaphneState::Field::kBiasVoltage, afe, biasVoltage);
 }
 
 uint32_t Daphne::getBiasVoltageDictValue(const uint32_t& afe) {
@@ -396,18 +466,86 @@ uint32_t Daphne::getBiasVoltageDictValue(const uint32_t& afe) {
 		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
 	}
 
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	auto it = this->state_.find({StateKey::Kind::kBiasVoltage, afe, 0});
-	return (it == this->state_.end()) ? 0u : it->second;
+	return this->state_.find(DaphneState::Field::kBiasVoltage, afe).value_or(0u);
 }
 
 void Daphne::setBiasControlDictValue(const uint32_t& biasControl) {
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	this->state_[{StateKey::Kind::kBiasControl, 0, 0}] = biasControl;
+	this->state_.set(DaphneState::Field::kBiasControl, 0, biasControl);
 }
 
 uint32_t Daphne::getBiasControlDictValue() {
-	std::lock_guard<std::mutex> lock(this->state_mutex_);
-	auto it = this->state_.find({StateKey::Kind::kBiasControl, 0, 0});
-	return (it == this->state_.end()) ? 0u : it->second;
+	return this->state_.find(DaphneState::Field::kBiasControl, 0).value_or(0u);
+}
+
+void Daphne::setAfeFunctionDictValue(const uint32_t& afe, const afe_definitions::AfeFunction& function, const uint32_t& value) {
+
+	if (afe > 4) {
+		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
+	}
+
+	this->state_.set(DaphneState::Field::kAfeFunction, DaphneState::afeFunctionIndex(afe, function), value);
+}
+
+void Daphne::setAfeFunctionDictValue(const uint32_t& afe, const std::string& functionName, const uint32_t& value) {
+
+	const auto function = afe_definitions::findAfeFunction(functionName);
+	if (!function) {
+		throw std::invalid_argument("AFE function name " + functionName + " not found in the AFE functions dictionary.");
+	}
+	this->setAfeFunctionDictValue(afe, *function, value);
+}
+
+void Daphne::clearAfeFunctionDictValues() {
+	this->state_.clearAfeFunctions();
+}
+
+void Daphne::clearAfeFunctionDictValues(const uint32_t& afe) {
+	this->state_.clearAfeFunctions(afe);
+}
+
+std::optional<uint32_t> Daphne::findAfeAttenuationDictValue(const uint32_t& afe) {
+	return this->state_.find(DaphneState::Field::kAfeAttenuation, afe);
+}
+
+std::optional<uint32_t> Daphne::findChOffsetDictValue(const uint32_t& ch) {
+	return this->state_.find(DaphneState::Field::kChannelOffset, ch);
+}
+
+std::optional<uint32_t> Daphne::findChTrimDictValue(const uint32_t& ch) {
+	return this->state_.find(DaphneState::Field::kChannelTrim, ch);
+}
+
+std::optional<uint32_t> Daphne::findBiasVoltageDictValue(const uint32_t& afe) {
+	return this->state_.find(DaphneState::Field::kBiasVoltage, afe);
+}
+
+std::optional<uint32_t> Daphne::findBiasControlDictValue() {
+	return this->state_.find(DaphneState::Field::kBiasControl, 0);
+}
+
+std::optional<uint32_t> Daphne::findAfeFunctionDictValue(const uint32_t& afe, const afe_definitions::AfeFunction& function) {
+	if (afe > 4) {
+		return std::nullopt;
+	}
+	return this->state_.find(DaphneState::Field::kAfeFunction, DaphneState::afeFunctionIndex(afe, function));
+}
+
+std::optional<uint32_t> Daphne::findAfeFunctionDictValue(const uint32_t& afe, const std::string& functionName) {
+	const auto function = afe_definitions::findAfeFunction(functionName);
+	if (!function) {
+		return std::nullopt;
+	}
+	return this->findAfeFunctionDictValue(afe, *function);
+}
+
+DaphneState::Snapshot Daphne::getStateSnapshot() {
+	return this->state_.snapshot();
+}
+
+MonitoringSnapshot Daphne::getMonitoringSnapshot(uint64_t* sequence_out) {
+	return this->monitoringSnapshot_.load(sequence_out);
+}
+
+void Daphne::updateMonitoringSnapshot(const std::function<void(MonitoringSnapshot&)>& fn) {
+	this->monitoringSnapshot_.update(fn);
 }
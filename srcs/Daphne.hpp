@@ -27,6 +27,16 @@
 #include "SpyBuffer.hpp"
 #include "DaphneI2CDrivers.hpp"
 #include "DaphneSpiDrivers.hpp"
+#include "MonitoringHistory.hpp"
+#include "MonitoringSeries.hpp"
+#include "I2CBusExecutor.hpp"
+#include "AlignmentEngine.hpp"
+#include "AlignmentCache.hpp"
+#include "SpiScheduler.hpp"
+#include "TriggerBlock.hpp"
+#include "DaphneState.hpp"
+#include "MonitoringSnapshot.hpp"
+#include "SeqlockCell.hpp"
 
 class Daphne {
 public:
@@ -38,22 +48,39 @@ public:
     ~Daphne();
 
     Afe* getAfe();
+    SpiScheduler* getSpiScheduler();
     Dac* getDac();
     FrontEnd* getFrontEnd();
     SpyBuffer* getSpyBuffer();
+    TriggerBlock* getTriggerBlock();
     I2CMezzDrivers::HDMezzDriver* getHDMezzDriver();
     I2CRegulatorsDrivers::PJT004A0X43_SRZ_Driver* getRegulatorsDriver();
     I2CADCsDrivers::ADS7138_Driver* getADS7138_Driver_addr_0x10();
     I2CADCsDrivers::ADS7138_Driver* getADS7138_Driver_addr_0x17();
     CurrentMonitorDrivers::CurrentMonitor* getCurrentMonitorDriver();
+    // Every transaction on /dev/i2c-1 (ADS7138 ADCs) and /dev/i2c-2 (HD
+    // mezzanines, regulators) goes through the bus's executor.
+    I2CBusExecutor* getI2C1Bus();
+    I2CBusExecutor* getI2C2Bus();
+    MonitoringHistory* getMonitoringHistory();
+    MonitoringSeries* getMonitoringSeries();
+    // nullptr until enableAlignmentCache() is called.
+    AlignmentCache* getAlignmentCache();
+    void enableAlignmentCache(const std::string& path);
+    AlignmentCacheKey getAlignmentCacheKey(const double& temperature_C);
 
     std::optional<std::pair<uint32_t, uint32_t>> longestIdenticalSubsequenceIndices(const std::vector<uint32_t>& nums);
     std::vector<uint32_t> scanGeneric(const uint32_t& afe,const std::string& what,const uint32_t& taps, std::function<uint32_t(const uint32_t&, const uint32_t&)> setFunc);
     uint32_t setBestDelay(const uint32_t& afe, const size_t& delayTaps = 512, std::string* debug_out = nullptr);
+    bool setBestDelayLocal(const uint32_t& afe, const uint32_t& radius, std::string* debug_out = nullptr);
     uint32_t setBestBitslip(const uint32_t& afe, const size_t& bitslipTaps = 16, std::string* debug_out = nullptr, bool* matched_out = nullptr);
+    // Aligns all five AFEs at once (delay then bitslip) via AlignmentEngine.
+    std::array<AfeAlignment, 5> alignAllAfes(const uint32_t& delayTaps = 512, const uint32_t& bitslipTaps = 16, uint32_t* triggers_out = nullptr);
+    // One trigger, frame-clock word (sample 0) of every AFE.
+    std::array<uint32_t, 5> readFrameClocks();
     double calcInputVoltage(const double& value, const double& vGain_mV);
     
-    void setAfeRegDictValue(const uint32_t& afe, const uint32_t &regAddr, const uint32_t &regValue);
+    // AFE registers are served from the Afe register shadow (SPI only on a miss).
     uint32_t getAfeRegDictValue(const uint32_t& afe, const uint32_t &regAddr);
     void setAfeAttenuationDictValue(const uint32_t& afe, const uint32_t &attenuation);
     uint32_t getAfeAttenuationDictValue(const uint32_t& afe);
@@ -65,87 +92,61 @@ public:
     uint32_t getBiasVoltageDictValue(const uint32_t& afe);
     void setBiasControlDictValue(const uint32_t& biasControl);
     uint32_t getBiasControlDictValue();
-
-    //Atomic variable to share between threads
-    std::atomic<bool> isI2C_1_device_configuring;
-    std::atomic<bool> isI2C_2_device_configuring;
-    std::mutex i2c_2_mutex;
-    std::atomic<bool> user_vbias_voltage_request;
-    std::atomic<bool> is_vbias_voltage_monitor_reading;
-    //Atomic monitor voltages and currents
-    std::array<std::atomic<bool>, 5> HDMezz_5V_is_powered{false, false, false, false, false};
-    std::array<std::atomic<bool>, 5> HDMezz_3V3_is_powered{false, false, false, false, false};
-    std::array<std::atomic<double>, 5> HDMezz_5V_voltage{0.0, 0.0, 0.0, 0.0, 0.0};
-    std::array<std::atomic<double>, 5> HDMezz_5V_current{0.0, 0.0, 0.0, 0.0, 0.0};
-    std::array<std::atomic<double>, 5> HDMezz_3V3_voltage{0.0, 0.0, 0.0, 0.0, 0.0};
-    std::array<std::atomic<double>, 5> HDMezz_3V3_current{0.0, 0.0, 0.0, 0.0, 0.0};
-    std::array<std::atomic<double>, 5> HDMezz_5V_power{0.0, 0.0, 0.0, 0.0, 0.0};
-    std::array<std::atomic<double>, 5> HDMezz_3V3_power{0.0, 0.0, 0.0, 0.0, 0.0};
-    std::array<std::atomic<bool>, 5>   HDMezz_5V_alert{false, false, false, false, false};
-    std::array<std::atomic<bool>, 5>   HDMezz_3V3_alert{false, false, false, false, false};
-
-    std::atomic<double> _1V8A_voltage;
-    std::atomic<double> _3V3A_voltage;
-    std::atomic<double> _n5VA_voltage;
-
-    std::atomic<double> _3V3PDS_voltage;
-    std::atomic<double> _1V8PDS_voltage;
-    std::atomic<double> _VBIAS_0_voltage;
-    std::atomic<double> _VBIAS_1_voltage;
-    std::atomic<double> _VBIAS_2_voltage;
-    std::atomic<double> _VBIAS_3_voltage;
-    std::atomic<double> _VBIAS_4_voltage;
+    // The string overloads look the function up once and forward to the enum ones.
+    void setAfeFunctionDictValue(const uint32_t& afe, const afe_definitions::AfeFunction& function, const uint32_t& value);
+    void setAfeFunctionDictValue(const uint32_t& afe, const std::string& functionName, const uint32_t& value);
+    // AFE function values are dropped whenever the AFE registers may no longer match
+    // (reset, power state change, raw register write).
+    void clearAfeFunctionDictValues();
+    void clearAfeFunctionDictValues(const uint32_t& afe);
+
+    // Same as the getters above, but empty when the value was never programmed.
+    std::optional<uint32_t> findAfeAttenuationDictValue(const uint32_t& afe);
+    std::optional<uint32_t> findChOffsetDictValue(const uint32_t& ch);
+    std::optional<uint32_t> findChTrimDictValue(const uint32_t& ch);
+    std::optional<uint32_t> findBiasVoltageDictValue(const uint32_t& afe);
+    std::optional<uint32_t> findBiasControlDictValue();
+    std::optional<uint32_t> findAfeFunctionDictValue(const uint32_t& afe, const afe_definitions::AfeFunction& function);
+    std::optional<uint32_t> findAfeFunctionDictValue(const uint32_t& afe, const std::string& functionName);
+    // All DAC values above in one consistent copy, without blocking writers.
+    DaphneState::Snapshot getStateSnapshot();
+
+    // Spy buffer / frontend ownership: client acquisitions (dump, configure, align)
+    // count themselves in before taking the mutex so background snapshots back
+    // off while any of them is running or queued.
+    std::mutex acquisition_mutex;
+    std::atomic<uint32_t> activeClientAcquisitions;
+    std::atomic<uint64_t> last_client_acquisition_ns;
+    // Readings of the I2C monitor threads, published as one value per update.
+    MonitoringSnapshot getMonitoringSnapshot(uint64_t* sequence_out = nullptr);
+    void updateMonitoringSnapshot(const std::function<void(MonitoringSnapshot&)>& fn);
 
 private:
     std::unique_ptr<Afe> afe;
+    std::unique_ptr<SpiScheduler> spiScheduler;
     std::unique_ptr<Dac> dac;
     std::unique_ptr<FrontEnd> frontend;
     std::unique_ptr<SpyBuffer> spyBuffer;
+    std::unique_ptr<TriggerBlock> triggerBlock;
     std::unique_ptr<I2CMezzDrivers::HDMezzDriver> hdmezzdriver;
     std::unique_ptr<I2CRegulatorsDrivers::PJT004A0X43_SRZ_Driver> regulatorsdriver;
     std::unique_ptr<I2CADCsDrivers::ADS7138_Driver> ads7138driver_addr_0x10;
     std::unique_ptr<I2CADCsDrivers::ADS7138_Driver> ads7138driver_addr_0x17;
     std::unique_ptr<CurrentMonitorDrivers::CurrentMonitor> current_monitor;
+    std::unique_ptr<MonitoringHistory> monitoringHistory;
+    std::unique_ptr<MonitoringSeries> monitoringSeries;
+    // After the drivers, so queued work finishes before they are destroyed.
+    std::unique_ptr<I2CBusExecutor> i2c1Bus;
+    std::unique_ptr<I2CBusExecutor> i2c2Bus;
+    std::unique_ptr<AlignmentCache> alignmentCache;
 
     std::unordered_map<std::string, std::vector<double>> AFE_GAIN_LUT = {
         {"VCNTL",{0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2, 1.3, 1.4, 1.5}},
         {"GAIN" ,{36.45, 33.91, 30.78, 27.39, 23.74, 20.69, 17.11, 13.54, 10.27, 6.48, 3.16, -0.35, -2.48, -3.58, -4.01, -4}}
     };
 
-    struct StateKey {
-        enum class Kind : uint8_t {
-            kAfeReg = 1,
-            kAfeAttenuation = 2,
-            kChannelOffset = 3,
-            kChannelTrim = 4,
-            kBiasVoltage = 5,
-            kBiasControl = 6,
-        };
-
-        Kind kind{};
-        uint32_t a = 0;
-        uint32_t b = 0;
-
-        bool operator==(const StateKey& other) const noexcept {
-            return kind == other.kind && a == other.a && b == other.b;
-        }
-    };
-
-    struct StateKeyHash {
-        size_t operator()(const StateKey& k) const noexcept {
-            uint64_t x = (static_cast<uint64_t>(k.a) << 32) ^ static_cast<uint64_t>(k.b);
-            x ^= (static_cast<uint64_t>(k.kind) << 56);
-            x ^= x >> 33;
-            x *= 0xff51afd7ed558ccdULL;
-            x ^= x >> 33;
-            x *= 0xc4ceb9fe1a85ec53ULL;
-            x ^= x >> 33;
-            return static_cast<size_t>(x);
-        }
-    };
-
-    mutable std::mutex state_mutex_;
-    std::unordered_map<StateKey, uint32_t, StateKeyHash> state_;
+    DaphneState state_;
+    SeqlockCell<MonitoringSnapshot> monitoringSnapshot_;
 
     template <typename T>
     int findIndex(const std::vector<T>& data, const T& target);
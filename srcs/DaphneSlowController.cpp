@@ -193,7 +193,6 @@ bool writeAFERegister(const cmd_writeAFEReg &request, Daphne &daphne, std::strin
                        + " written with value " + std::to_string(regValue) 
                        + " for AFE " + std::to_string(afe_definitions::AFE_PL2board_map.at(afeBlock)) + ".";
         response_str += " Returned value: " + std::to_string(returned_value) + ".";
-        daphne.setAfeRegDictValue(afeBlock, regAddr, returned_value);
     } catch (std::exception &e) {
         response_str = "Error writting AFE Register: " + std::string(e.what());
         return false;
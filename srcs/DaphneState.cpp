@@ -0,0 +1,142 @@
+#include "DaphneState.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace {
+constexpr uint64_t kProgrammed = 1ULL << 32;
+
+std::optional<uint32_t> unpack(const uint64_t& slot){
+
+	if(!(slot & kProgrammed)){
+		return std::nullopt;
+	}
+	return static_cast<uint32_t>(slot);
+}
+}
+
+DaphneState::DaphneState(){
+
+	for(auto& slot : this->slots){
+		slot.store(0, std::memory_order_relaxed);
+	}
+}
+
+DaphneState::~DaphneState(){}
+
+uint32_t DaphneState::slotOf(const Field& field, const uint32_t& index){
+
+	switch(field){
+		case Field::kChannelTrim:
+		case Field::kChannelOffset:
+			if(index >= kChannels){
+				return kSlots;
+			}
+			return (field == Field::kChannelTrim ? 0 : kChannels) + index;
+		case Field::kAfeAttenuation:
+		case Field::kBiasVoltage:
+			if(index >= kAfes){
+				return kSlots;
+			}
+			return 2 * kChannels + (field == Field::kAfeAttenuation ? 0 : kAfes) + index;
+		case Field::kBiasControl:
+			return index == 0 ? 2 * kChannels + 2 * kAfes : kSlots;
+		case Field::kAfeFunction:
+			return index < kAfes * kAfeFunctions ? kAfeFunctionBase + index : kSlots;
+	}
+	return kSlots;
+}
+
+void DaphneState::set(const Field& field, const uint32_t& index, const uint32_t& value){
+
+	const uint32_t slot = slotOf(field, index);
+	if(slot == kSlots){
+		throw std::out_of_range("State index " + std::to_string(index) + " out of range.");
+	}
+	std::lock_guard<std::mutex> lock(this->writeMutex);
+	const uint64_t seq = this->sequence.load(std::memory_order_relaxed);
+	this->sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	this->slots[slot].store(kProgrammed | value, std::memory_order_relaxed);
+	this->sequence.store(seq + 2, std::memory_order_release);
+}
+
+std::optional<uint32_t> DaphneState::find(const Field& field, const uint32_t& index) const{
+
+	const uint32_t slot = slotOf(field, index);
+	if(slot == kSlots){
+		return std::nullopt;
+	}
+	return unpack(this->slots[slot].load(std::memory_order_acquire));
+}
+
+void DaphneState::clearSlots(const uint32_t& begin, const uint32_t& end){
+
+	std::lock_guard<std::mutex> lock(this->writeMutex);
+	const uint64_t seq = this->sequence.load(std::memory_order_relaxed);
+	this->sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for(uint32_t i = begin; i < end; i++){
+		this->slots[i].store(0, std::memory_order_relaxed);
+	}
+	this->sequence.store(seq + 2, std::memory_order_release);
+}
+
+void DaphneState::clear(){
+
+	this->clearSlots(0, kSlots);
+}
+
+void DaphneState::clearAfeFunctions(){
+
+	this->clearSlots(kAfeFunctionBase, kSlots);
+}
+
+void DaphneState::clearAfeFunctions(const uint32_t& afe){
+
+	if(afe >= kAfes){
+		return;
+	}
+	const uint32_t begin = kAfeFunctionBase + afe * kAfeFunctions;
+	this->clearSlots(begin, begin + kAfeFunctions);
+}
+
+DaphneState::Snapshot DaphneState::snapshot() const{
+
+	std::array<uint64_t, kSlots> copy;
+	uint64_t before = 0;
+	while(true){
+		before = this->sequence.load(std::memory_order_acquire);
+		if(before & 1){
+			continue;
+		}
+		for(uint32_t i = 0; i < kSlots; i++){
+			copy[i] = this->slots[i].load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(this->sequence.load(std::memory_order_relaxed) == before){
+			break;
+		}
+	}
+
+	Snapshot snapshot;
+	snapshot.sequence = before;
+	for(uint32_t ch = 0; ch < kChannels; ch++){
+		snapshot.trims[ch] = unpack(copy[slotOf(Field::kChannelTrim, ch)]);
+		snapshot.offsets[ch] = unpack(copy[slotOf(Field::kChannelOffset, ch)]);
+	}
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		snapshot.attenuations[afe] = unpack(copy[slotOf(Field::kAfeAttenuation, afe)]);
+		snapshot.biasVoltages[afe] = unpack(copy[slotOf(Field::kBiasVoltage, afe)]);
+		for(uint32_t function = 0; function < kAfeFunctions; function++){
+			snapshot.afeFunctions[afe][function] = unpack(copy[kAfeFunctionBase + afe * kAfeFunctions + function]);
+		}
+	}
+	snapshot.biasControl = unpack(copy[slotOf(Field::kBiasControl, 0)]);
+	return snapshot;
+}
+
+uint64_t DaphneState::getSequence() const{
+
+	return this->sequence.load(std::memory_order_acquire);
+}
@@ -0,0 +1,76 @@
+#ifndef DAPHNESTATE_HPP
+#define DAPHNESTATE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+#include "defines.hpp"
+
+// Programmed DAC values (trims, offsets, AFE attenuations, bias set points and
+// bias control) and AFE function values in one flat array of slots. Each slot packs a "programmed"
+// flag and the value into a single atomic word, so single reads never lock.
+// Writers serialize on a mutex and bump a seqlock counter around each write;
+// snapshot() retries until it has copied every slot without a writer in
+// between, which gives a consistent picture of the whole block.
+class DaphneState {
+public:
+    static constexpr uint32_t kChannels = 40;
+    static constexpr uint32_t kAfes = 5;
+    static constexpr uint32_t kAfeFunctions = static_cast<uint32_t>(afe_definitions::afeFunctionTable.size());
+
+    enum class Field : uint8_t {
+        kChannelTrim,
+        kChannelOffset,
+        kAfeAttenuation,   // indexed by PL AFE
+        kBiasVoltage,      // indexed by PL AFE
+        kBiasControl,      // index 0
+        kAfeFunction,      // indexed by afeFunctionIndex()
+    };
+
+    struct Snapshot {
+        uint64_t sequence = 0;   // even; changes on every write or clear
+        std::array<std::optional<uint32_t>, kChannels> trims{};
+        std::array<std::optional<uint32_t>, kChannels> offsets{};
+        std::array<std::optional<uint32_t>, kAfes> attenuations{};
+        std::array<std::optional<uint32_t>, kAfes> biasVoltages{};
+        std::optional<uint32_t> biasControl;
+        std::array<std::array<std::optional<uint32_t>, kAfeFunctions>, kAfes> afeFunctions{};   // [PL AFE][function]
+    };
+
+    // Constructor
+    DaphneState();
+
+    // Destructor
+    ~DaphneState();
+
+    // set() throws std::out_of_range on a bad index; find() returns nothing.
+    void set(const Field& field, const uint32_t& index, const uint32_t& value);
+    std::optional<uint32_t> find(const Field& field, const uint32_t& index) const;
+    void clear();
+    // Drops the AFE function values of every AFE, or of one PL AFE.
+    void clearAfeFunctions();
+    void clearAfeFunctions(const uint32_t& afe);
+    Snapshot snapshot() const;
+    uint64_t getSequence() const;
+
+    static uint32_t afeFunctionIndex(const uint32_t& afe, const afe_definitions::AfeFunction& function) {
+        return afe * kAfeFunctions + static_cast<uint32_t>(function);
+    }
+
+private:
+    static constexpr uint32_t kAfeFunctionBase = 2 * kChannels + 2 * kAfes + 1;
+    static constexpr uint32_t kSlots = kAfeFunctionBase + kAfes * kAfeFunctions;
+
+    std::mutex writeMutex;
+    std::atomic<uint64_t> sequence{0};
+    std::array<std::atomic<uint64_t>, kSlots> slots{};
+
+    // kSlots for an index outside the field.
+    static uint32_t slotOf(const Field& field, const uint32_t& index);
+    void clearSlots(const uint32_t& begin, const uint32_t& end);
+};
+
+#endif // DAPHNESTATE_HPP
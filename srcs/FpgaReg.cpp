@@ -28,6 +28,18 @@ const uint32_t* FpgaReg::getRegisterPointer(const std::string &regName, const st
 	return this->fpgaMem->getRegisterPointer(regName, bitName, offset_);
 }
 
+uint32_t FpgaReg::getBitMask(const std::string &regName, const std::string &bitName){
+
+	auto field = this->fpgaMem->GetRegister(regName, bitName);
+	int bitRangeH = std::get<1>(field);
+	int bitRangeL = std::get<2>(field);
+	if(bitRangeH < 0 || bitRangeL < 0){
+		throw std::invalid_argument("Bit field " + regName + "." + bitName + " not found.");
+	}
+	uint32_t width = bitRangeH - bitRangeL + 1;
+	return (width == 32) ? 0xFFFFFFFF : ((1U << width) - 1) << bitRangeL;
+}
+
 uint32_t FpgaReg::writeRegister(const std::string &regName, const uint32_t &value){
     std::vector<uint32_t> v(1, value);
     return this->fpgaMem->WriteRegister(regName, v);
@@ -25,6 +25,7 @@ public:
     uint32_t setBits(const std::string &regName, const std::string &bitName, const uint32_t &Data);
     uint32_t getBits(const std::string &regName, const std::string &bitName, const uint32_t &offset = 0);
     const uint32_t* getRegisterPointer(const std::string &regName, const std::string &bitName, const uint32_t &offset);
+    uint32_t getBitMask(const std::string &regName, const std::string &bitName);
     uint32_t getBitsFast(const uint32_t &offset = 0, const bool& bitEndianess = false);
     void getRegisterAndCacheData(const std::string &regName);
     uint32_t writeRegister(const std::string &regName, const uint32_t &value);
@@ -71,6 +71,21 @@ uint32_t FrontEnd::resetDelayCtrlValues(){
 	return 0;
 }
 
+uint32_t FrontEnd::getFirmwareGit(){
+
+	return this->fpgaReg->getBits("GIT", "GIT");
+}
+
+uint32_t FrontEnd::getSlotId(){
+
+	return this->fpgaReg->getBits("idSlot", "ID");
+}
+
+uint32_t FrontEnd::getCrateId(){
+
+	return this->fpgaReg->getBits("idCrate", "ID");
+}
+
 bool FrontEnd::waitForDelayCtrlReady(std::chrono::milliseconds timeout,
                                      std::chrono::milliseconds poll){
     const auto deadline = std::chrono::steady_clock::now() + timeout;
@@ -83,3 +98,8 @@ bool FrontEnd::waitForDelayCtrlReady(std::chrono::milliseconds timeout,
 
     return this->getDelayCtrlReady() != 0;
 }
+
+FpgaReg* FrontEnd::getFpgaReg(){
+
+	return this->fpgaReg.get();
+}
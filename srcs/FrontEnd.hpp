@@ -33,8 +33,15 @@ public:
     uint32_t setBitslip(const uint8_t& afe,const uint32_t& bitslip);
     uint32_t getBitslip(const uint8_t& afe);
     uint32_t resetDelayCtrlValues();
+    // Firmware/board identity, used to key cached alignment results.
+    uint32_t getFirmwareGit();
+    uint32_t getSlotId();
+    uint32_t getCrateId();
     bool waitForDelayCtrlReady(std::chrono::milliseconds timeout = std::chrono::milliseconds(250),
                                std::chrono::milliseconds poll = std::chrono::milliseconds(5));
+    // The frontend's mapping of the register window, shared with server-side
+    // readers (register watch) instead of each opening its own.
+    FpgaReg* getFpgaReg();
 
 private:
     std::unique_ptr<FpgaReg> fpgaReg;
@@ -0,0 +1,146 @@
+#include "I2CBusExecutor.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+uint64_t steadyNs(){
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t bucketOf(uint64_t ns){
+
+	size_t bucket = 0;
+	while(ns > 1 && bucket < I2CBusExecutor::kBuckets - 1){
+		ns >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+// Upper edge of the bucket holding the q-quantile; 0 without samples.
+uint64_t percentileNs(const std::array<uint64_t, I2CBusExecutor::kBuckets>& histogram, const uint64_t& count, const double& q){
+
+	if(count == 0){
+		return 0;
+	}
+	const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.999999));
+	uint64_t cumulative = 0;
+	for(size_t i = 0; i < histogram.size(); i++){
+		cumulative += histogram[i];
+		if(cumulative >= rank){
+			return 1ULL << (i + 1);
+		}
+	}
+	return 1ULL << histogram.size();
+}
+}
+
+I2CBusExecutor::I2CBusExecutor(const std::string& name)
+	: name(name),
+	stopping(false),
+	thread(&I2CBusExecutor::loop, this){}
+
+I2CBusExecutor::~I2CBusExecutor(){
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	if(this->thread.joinable()){
+		this->thread.join();
+	}
+}
+
+const char* I2CBusExecutor::priorityName(const Priority& priority){
+
+	switch(priority){
+		case Priority::kSafety: return "safety";
+		case Priority::kUser: return "user";
+		case Priority::kTelemetry: return "telemetry";
+	}
+	return "unknown";
+}
+
+bool I2CBusExecutor::onBusThread() const{
+
+	return std::this_thread::get_id() == this->thread.get_id();
+}
+
+void I2CBusExecutor::enqueue(const Priority& priority, std::function<bool()> fn){
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		Queue& queue = this->queues[static_cast<size_t>(priority)];
+		queue.jobs.push_back(Job{std::move(fn), steadyNs()});
+		queue.maxDepth = std::max(queue.maxDepth, static_cast<uint32_t>(queue.jobs.size()));
+	}
+	this->wake.notify_one();
+}
+
+void I2CBusExecutor::loop(){
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while(true){
+		Queue* next = nullptr;
+		for(Queue& queue : this->queues){
+			if(!queue.jobs.empty()){
+				next = &queue;
+				break;
+			}
+		}
+		if(next == nullptr){
+			if(this->stopping){
+				return;
+			}
+			this->wake.wait(lock);
+			continue;
+		}
+
+		Job job = std::move(next->jobs.front());
+		next->jobs.pop_front();
+		lock.unlock();
+		const uint64_t started = steadyNs();
+		const bool ok = job.fn();
+		const uint64_t finished = steadyNs();
+		lock.lock();
+
+		const uint64_t wait_ns = started - job.queued_ns;
+		const uint64_t run_ns = finished - started;
+		next->waitHistogram[bucketOf(wait_ns)]++;
+		next->waitMax_ns = std::max(next->waitMax_ns, wait_ns);
+		next->runTotal_ns += run_ns;
+		next->runMax_ns = std::max(next->runMax_ns, run_ns);
+		if(ok){
+			next->completed++;
+		}else{
+			next->failed++;
+		}
+	}
+}
+
+std::array<I2CBusExecutor::QueueStats, I2CBusExecutor::kPriorities> I2CBusExecutor::getStats() const{
+
+	std::array<QueueStats, kPriorities> stats;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for(size_t i = 0; i < kPriorities; i++){
+		const Queue& queue = this->queues[i];
+		QueueStats& out = stats[i];
+		const uint64_t runs = queue.completed + queue.failed;
+		out.priority = I2CBusExecutor::priorityName(static_cast<Priority>(i));
+		out.completed = queue.completed;
+		out.failed = queue.failed;
+		out.depth = static_cast<uint32_t>(queue.jobs.size());
+		out.maxDepth = queue.maxDepth;
+		out.waitP50_ns = percentileNs(queue.waitHistogram, runs, 0.50);
+		out.waitP99_ns = percentileNs(queue.waitHistogram, runs, 0.99);
+		out.waitMax_ns = queue.waitMax_ns;
+		out.runMean_ns = runs > 0 ? queue.runTotal_ns / runs : 0;
+		out.runMax_ns = queue.runMax_ns;
+		out.waitHistogram = queue.waitHistogram;
+	}
+	return stats;
+}
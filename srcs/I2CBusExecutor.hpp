@@ -0,0 +1,119 @@
+#ifndef I2CBUSEXECUTOR_HPP
+#define I2CBUSEXECUTOR_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Runs every transaction on one I2C bus from a single thread. Callers submit a
+// closure that drives the bus's devices and get a future for its result. The
+// thread serves three FIFO queues in strict priority order: safety checks,
+// then user commands, then telemetry. A user command therefore waits for at
+// most the telemetry transaction in progress, not a whole monitor cycle.
+// Queue wait and run times are kept per priority in log2 histograms.
+class I2CBusExecutor {
+public:
+    enum class Priority : uint8_t { kSafety = 0, kUser = 1, kTelemetry = 2 };
+    static constexpr size_t kPriorities = 3;
+    static constexpr size_t kBuckets = 32;   // bucket i: [2^i, 2^(i+1)) ns
+
+    struct QueueStats {
+        std::string priority;
+        uint64_t completed = 0;
+        uint64_t failed = 0;        // closures that threw
+        uint32_t depth = 0;         // queued, not yet started
+        uint32_t maxDepth = 0;
+        uint64_t waitP50_ns = 0;
+        uint64_t waitP99_ns = 0;
+        uint64_t waitMax_ns = 0;
+        uint64_t runMean_ns = 0;
+        uint64_t runMax_ns = 0;
+        std::array<uint64_t, kBuckets> waitHistogram{};
+    };
+
+    // Constructor. Starts the bus thread.
+    explicit I2CBusExecutor(const std::string& name);
+
+    // Destructor. Runs what is still queued, then joins the thread.
+    ~I2CBusExecutor();
+
+    // Queues fn and returns its future; exceptions thrown by fn end up in the
+    // future. Called from the bus thread itself (a closure submitting more
+    // work), fn runs at once so the caller never waits on its own queue.
+    template <typename Fn>
+    auto submit(const Priority& priority, Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>&>> {
+        using Result = std::invoke_result_t<std::decay_t<Fn>&>;
+        auto promise = std::make_shared<std::promise<Result>>();
+        std::future<Result> future = promise->get_future();
+        std::function<bool()> job = [promise, fn = std::forward<Fn>(fn)]() mutable -> bool {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    fn();
+                    promise->set_value();
+                } else {
+                    promise->set_value(fn());
+                }
+                return true;
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+                return false;
+            }
+        };
+        if (this->onBusThread()) {
+            job();
+        } else {
+            this->enqueue(priority, std::move(job));
+        }
+        return future;
+    }
+
+    // submit() and wait for the result; rethrows what fn threw.
+    template <typename Fn>
+    auto run(const Priority& priority, Fn&& fn) -> std::invoke_result_t<std::decay_t<Fn>&> {
+        return this->submit(priority, std::forward<Fn>(fn)).get();
+    }
+
+    const std::string& getName() const { return this->name; }
+    std::array<QueueStats, kPriorities> getStats() const;
+    static const char* priorityName(const Priority& priority);
+
+private:
+    struct Job {
+        std::function<bool()> fn;
+        uint64_t queued_ns = 0;
+    };
+
+    struct Queue {
+        std::deque<Job> jobs;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        uint32_t maxDepth = 0;
+        std::array<uint64_t, kBuckets> waitHistogram{};
+        uint64_t waitMax_ns = 0;
+        uint64_t runTotal_ns = 0;
+        uint64_t runMax_ns = 0;
+    };
+
+    std::string name;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::array<Queue, kPriorities> queues;
+    std::thread thread;   // last: started once the queues exist
+
+    bool onBusThread() const;
+    void enqueue(const Priority& priority, std::function<bool()> fn);
+    void loop();
+};
+
+#endif // I2CBUSEXECUTOR_HPP
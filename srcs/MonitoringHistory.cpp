@@ -0,0 +1,131 @@
+#include "MonitoringHistory.hpp"
+
+#include <chrono>
+
+MonitoringHistory::MonitoringHistory(const size_t& pedestalCapacity, const size_t& triggerCapacity)
+	: pedestal_(pedestalCapacity > 0 ? pedestalCapacity : 1),
+	  trigger_(triggerCapacity > 0 ? triggerCapacity : 1){}
+
+MonitoringHistory::~MonitoringHistory(){}
+
+void MonitoringHistory::pushPedestal(const PedestalRecord& record){
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->pedestal_[this->pedestalHead_] = record;
+	this->pedestalHead_ = (this->pedestalHead_ + 1) % this->pedestal_.size();
+	if(this->pedestalCount_ < this->pedestal_.size()){
+		this->pedestalCount_++;
+	}
+}
+
+std::vector<PedestalRecord> MonitoringHistory::getPedestalHistory(const uint64_t& since_ns) const{
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	std::vector<PedestalRecord> out;
+	out.reserve(this->pedestalCount_);
+	const size_t capacity = this->pedestal_.size();
+	const size_t first = (this->pedestalHead_ + capacity - this->pedestalCount_) % capacity;
+	for(size_t i = 0; i < this->pedestalCount_; i++){
+		const PedestalRecord& record = this->pedestal_[(first + i) % capacity];
+		if(record.timestamp_ns > since_ns){
+			out.push_back(record);
+		}
+	}
+	return out;
+}
+
+size_t MonitoringHistory::getPedestalCapacity() const{
+
+	return this->pedestal_.size();
+}
+
+void MonitoringHistory::pushTriggerSample(const TriggerCounterSample& sample){
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->trigger_[this->triggerHead_] = sample;
+	this->triggerHead_ = (this->triggerHead_ + 1) % this->trigger_.size();
+	if(this->triggerCount_ < this->trigger_.size()){
+		this->triggerCount_++;
+	}
+}
+
+std::vector<TriggerCounterSample> MonitoringHistory::getTriggerHistory(const uint64_t& since_ns, const size_t& maxSamples) const{
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	const size_t capacity = this->trigger_.size();
+	const size_t first = (this->triggerHead_ + capacity - this->triggerCount_) % capacity;
+	// Newest first to find the window start, so only the returned samples are copied.
+	size_t count = 0;
+	while(count < this->triggerCount_ && (maxSamples == 0 || count < maxSamples)){
+		const TriggerCounterSample& sample = this->trigger_[(first + this->triggerCount_ - 1 - count) % capacity];
+		if(sample.timestamp_ns <= since_ns){
+			break;
+		}
+		count++;
+	}
+	std::vector<TriggerCounterSample> out;
+	out.reserve(count);
+	for(size_t i = this->triggerCount_ - count; i < this->triggerCount_; i++){
+		out.push_back(this->trigger_[(first + i) % capacity]);
+	}
+	return out;
+}
+
+bool MonitoringHistory::getLatestTriggerSample(TriggerCounterSample& sample) const{
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	if(this->triggerCount_ == 0){
+		return false;
+	}
+	sample = this->trigger_[(this->triggerHead_ + this->trigger_.size() - 1) % this->trigger_.size()];
+	return true;
+}
+
+size_t MonitoringHistory::getTriggerCapacity() const{
+
+	return this->trigger_.size();
+}
+
+void MonitoringHistory::setFrameClockStatus(const std::array<FrameClockStatus, 5>& status){
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->frameClock_ = status;
+}
+
+std::array<FrameClockStatus, 5> MonitoringHistory::getFrameClockStatus() const{
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	return this->frameClock_;
+}
+
+void MonitoringHistory::pushEvent(const std::string& source, const std::string& message){
+
+	MonitoringEvent event;
+	event.timestamp_ns = MonitoringHistory::nowNs();
+	event.source = source;
+	event.message = message;
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->events_.push_back(std::move(event));
+	while(this->events_.size() > kEventCapacity){
+		this->events_.pop_front();
+	}
+}
+
+std::vector<MonitoringEvent> MonitoringHistory::getEvents(const uint64_t& since_ns) const{
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	std::vector<MonitoringEvent> out;
+	for(const auto& event : this->events_){
+		if(event.timestamp_ns > since_ns){
+			out.push_back(event);
+		}
+	}
+	return out;
+}
+
+uint64_t MonitoringHistory::nowNs(){
+
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
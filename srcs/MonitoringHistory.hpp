@@ -0,0 +1,100 @@
+#ifndef MONITORINGHISTORY_HPP
+#define MONITORINGHISTORY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per-channel baseline figures from one background pedestal snapshot.
+// Channels are indexed by board channel (0..39); timestamps are unix-epoch ns.
+struct PedestalRecord {
+    uint64_t timestamp_ns = 0;
+    std::array<float, 40> mean{};
+    std::array<float, 40> ac_rms{};
+    std::array<float, 40> p2p{};
+};
+
+// Frame-clock lock state of one frontend (PL) AFE as tracked by the watchdog.
+struct FrameClockStatus {
+    uint64_t last_check_ns = 0;
+    uint32_t last_word = 0;
+    uint32_t delay = 0;
+    uint32_t bitslip = 0;
+    bool locked = false;
+    bool armed = false;          // seen locked since start / last failed re-align
+    float lock_quality = 0.0f;   // EWMA of good frame-clock reads
+    uint64_t checks = 0;
+    uint64_t misses = 0;
+    uint32_t realigns = 0;
+    uint32_t realign_failures = 0;
+};
+
+// Self-trigger counters of all 40 channels from one sampler pass. Rates cover
+// the interval since the previous sample and are 0 for the first sample and
+// for a counter that went backwards (block reset). monotonic_ns is the
+// steady_clock time of the read, used for the rate time base.
+struct TriggerCounterSample {
+    uint64_t timestamp_ns = 0;
+    uint64_t monotonic_ns = 0;
+    double interval_s = 0.0;
+    std::array<uint64_t, 40> record{};
+    std::array<uint64_t, 40> busy{};
+    std::array<uint64_t, 40> full{};
+    std::array<float, 40> record_rate{};
+    std::array<float, 40> busy_rate{};
+    std::array<float, 40> full_rate{};
+};
+
+struct MonitoringEvent {
+    uint64_t timestamp_ns = 0;
+    std::string source;
+    std::string message;
+};
+
+// Fixed-size in-memory history filled by the monitoring threads and read by the
+// query handlers. Oldest entries are overwritten once the ring is full.
+class MonitoringHistory {
+public:
+    // Constructor
+    explicit MonitoringHistory(const size_t& pedestalCapacity = 4096, const size_t& triggerCapacity = 3600);
+
+    // Destructor
+    ~MonitoringHistory();
+
+    void pushPedestal(const PedestalRecord& record);
+    // Oldest first, restricted to records newer than since_ns.
+    std::vector<PedestalRecord> getPedestalHistory(const uint64_t& since_ns = 0) const;
+    size_t getPedestalCapacity() const;
+
+    void pushTriggerSample(const TriggerCounterSample& sample);
+    // Oldest first, newer than since_ns; at most the latest maxSamples (0: all).
+    std::vector<TriggerCounterSample> getTriggerHistory(const uint64_t& since_ns = 0, const size_t& maxSamples = 0) const;
+    bool getLatestTriggerSample(TriggerCounterSample& sample) const;
+    size_t getTriggerCapacity() const;
+
+    void setFrameClockStatus(const std::array<FrameClockStatus, 5>& status);
+    std::array<FrameClockStatus, 5> getFrameClockStatus() const;
+
+    void pushEvent(const std::string& source, const std::string& message);
+    std::vector<MonitoringEvent> getEvents(const uint64_t& since_ns = 0) const;
+
+    static uint64_t nowNs();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<PedestalRecord> pedestal_;
+    size_t pedestalHead_ = 0;
+    size_t pedestalCount_ = 0;
+    std::vector<TriggerCounterSample> trigger_;
+    size_t triggerHead_ = 0;
+    size_t triggerCount_ = 0;
+    std::array<FrameClockStatus, 5> frameClock_{};
+    std::deque<MonitoringEvent> events_;
+    static constexpr size_t kEventCapacity = 512;
+};
+
+#endif // MONITORINGHISTORY_HPP
@@ -0,0 +1,208 @@
+#include "MonitoringSeries.hpp"
+
+#include <algorithm>
+
+namespace {
+constexpr size_t kRailMetrics = 5;
+constexpr size_t kBiasMetrics = 5;
+constexpr size_t kHDMezzBlocks = 5;
+constexpr size_t kHDMezzMetrics = 6;
+constexpr size_t kBiasBase = kRailMetrics;
+constexpr size_t kHDMezzBase = kBiasBase + kBiasMetrics;
+constexpr size_t kMetrics = kHDMezzBase + kHDMezzBlocks * kHDMezzMetrics;
+
+std::vector<std::string> buildMetricNames(){
+
+	std::vector<std::string> names = {"v_3v3pds", "v_1v8pds", "v_3v3a", "v_1v8a", "v_n5va"};
+	for(size_t afe = 0; afe < kBiasMetrics; afe++){
+		names.push_back("v_bias." + std::to_string(afe));
+	}
+	const char* rails[kHDMezzMetrics] = {"voltage_5v", "current_5v", "power_5v", "voltage_3v3", "current_3v3", "power_3v3"};
+	for(size_t afe = 0; afe < kHDMezzBlocks; afe++){
+		for(size_t k = 0; k < kHDMezzMetrics; k++){
+			names.push_back("hdmezz." + std::to_string(afe) + "." + rails[k]);
+		}
+	}
+	return names;
+}
+
+MonitoringSeries::Point toPoint(const uint64_t& start_ns, const float& min, const float& max, const double& sum, const uint32_t& count){
+
+	MonitoringSeries::Point point;
+	point.timestamp_ns = start_ns;
+	point.min = min;
+	point.max = max;
+	point.mean = count > 0 ? static_cast<float>(sum / count) : 0.0f;
+	point.count = count;
+	return point;
+}
+}
+
+template <typename T>
+void MonitoringSeries::Ring<T>::push(const T& item){
+
+	this->items[this->head] = item;
+	this->head = (this->head + 1) % this->items.size();
+	if(this->count < this->items.size()){
+		this->count++;
+	}
+}
+
+template <typename T>
+const T& MonitoringSeries::Ring<T>::at(const size_t& i) const{
+
+	const size_t capacity = this->items.size();
+	return this->items[(this->head + capacity - this->count + i) % capacity];
+}
+
+MonitoringSeries::MonitoringSeries(const size_t& rawCapacity, const size_t& secondCapacity, const size_t& minuteCapacity)
+	: series_(kMetrics){
+
+	for(Series& series : this->series_){
+		series.raw.items.resize(rawCapacity > 0 ? rawCapacity : 1);
+		series.second.period_ns = 1000000000ULL;
+		series.second.closed.items.resize(secondCapacity > 0 ? secondCapacity : 1);
+		series.minute.period_ns = 60000000000ULL;
+		series.minute.closed.items.resize(minuteCapacity > 0 ? minuteCapacity : 1);
+	}
+}
+
+MonitoringSeries::~MonitoringSeries(){}
+
+const std::vector<std::string>& MonitoringSeries::getMetricNames(){
+
+	static const std::vector<std::string> names = buildMetricNames();
+	return names;
+}
+
+int MonitoringSeries::findMetric(const std::string& name){
+
+	const std::vector<std::string>& names = getMetricNames();
+	const auto it = std::find(names.begin(), names.end(), name);
+	return it == names.end() ? -1 : static_cast<int>(it - names.begin());
+}
+
+void MonitoringSeries::addToRollup(Rollup& rollup, const uint64_t& timestamp_ns, const float& value){
+
+	const uint64_t start_ns = timestamp_ns - timestamp_ns % rollup.period_ns;
+	if(rollup.open.count > 0 && rollup.open.start_ns != start_ns){
+		rollup.closed.push(rollup.open);
+		rollup.open = Bucket();
+	}
+	Bucket& bucket = rollup.open;
+	if(bucket.count == 0){
+		bucket.start_ns = start_ns;
+		bucket.min = value;
+		bucket.max = value;
+	}else{
+		bucket.min = std::min(bucket.min, value);
+		bucket.max = std::max(bucket.max, value);
+	}
+	bucket.sum += value;
+	bucket.count++;
+}
+
+void MonitoringSeries::push(const size_t& metric, const uint64_t& timestamp_ns, const double& value){
+
+	Series& series = this->series_[metric];
+	const float v = static_cast<float>(value);
+	series.raw.push(Sample{timestamp_ns, v});
+	addToRollup(series.second, timestamp_ns, v);
+	addToRollup(series.minute, timestamp_ns, v);
+}
+
+void MonitoringSeries::recordRails(const MonitoringSnapshot& snapshot){
+
+	const uint64_t t = snapshot.railsCycleNs;
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	this->push(0, t, snapshot.v3V3PDS);
+	this->push(1, t, snapshot.v1V8PDS);
+	this->push(2, t, snapshot.v3V3A);
+	this->push(3, t, snapshot.v1V8A);
+	this->push(4, t, snapshot.vn5VA);
+	for(size_t afe = 0; afe < kBiasMetrics; afe++){
+		this->push(kBiasBase + afe, t, snapshot.vBias[afe]);
+	}
+}
+
+void MonitoringSeries::recordHDMezz(const MonitoringSnapshot& snapshot){
+
+	const uint64_t t = snapshot.hdmezzCycleNs;
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	for(size_t afe = 0; afe < kHDMezzBlocks; afe++){
+		const HDMezzRails& r = snapshot.hdmezz[afe];
+		if(!r.enabled){
+			continue;
+		}
+		const size_t base = kHDMezzBase + afe * kHDMezzMetrics;
+		this->push(base + 0, t, r.voltage5V);
+		this->push(base + 1, t, r.current5V);
+		this->push(base + 2, t, r.power5V);
+		this->push(base + 3, t, r.voltage3V3);
+		this->push(base + 4, t, r.current3V3);
+		this->push(base + 5, t, r.power3V3);
+	}
+}
+
+std::vector<MonitoringSeries::Point> MonitoringSeries::query(const size_t& metric, const Resolution& resolution,
+                                                             const uint64_t& from_ns, const uint64_t& to_ns,
+                                                             const size_t& maxPoints, bool* truncated) const{
+
+	std::vector<Point> out;
+	if(truncated){
+		*truncated = false;
+	}
+	if(metric >= this->series_.size()){
+		return out;
+	}
+	const auto inRange = [&](const uint64_t& t){
+		return t >= from_ns && (to_ns == 0 || t <= to_ns);
+	};
+
+	std::lock_guard<std::mutex> lock(this->mutex_);
+	const Series& series = this->series_[metric];
+	if(resolution == Resolution::kRaw){
+		out.reserve(series.raw.count);
+		for(size_t i = 0; i < series.raw.count; i++){
+			const Sample& sample = series.raw.at(i);
+			if(inRange(sample.timestamp_ns)){
+				out.push_back(toPoint(sample.timestamp_ns, sample.value, sample.value, sample.value, 1));
+			}
+		}
+	}else{
+		const Rollup& rollup = resolution == Resolution::kSecond ? series.second : series.minute;
+		out.reserve(rollup.closed.count + 1);
+		for(size_t i = 0; i < rollup.closed.count; i++){
+			const Bucket& bucket = rollup.closed.at(i);
+			if(inRange(bucket.start_ns)){
+				out.push_back(toPoint(bucket.start_ns, bucket.min, bucket.max, bucket.sum, bucket.count));
+			}
+		}
+		const Bucket& open = rollup.open;
+		if(open.count > 0 && inRange(open.start_ns)){
+			out.push_back(toPoint(open.start_ns, open.min, open.max, open.sum, open.count));
+		}
+	}
+
+	if(maxPoints > 0 && out.size() > maxPoints){
+		out.erase(out.begin(), out.end() - maxPoints);
+		if(truncated){
+			*truncated = true;
+		}
+	}
+	return out;
+}
+
+size_t MonitoringSeries::getCapacity(const Resolution& resolution) const{
+
+	const Series& series = this->series_.front();
+	switch(resolution){
+		case Resolution::kRaw:
+			return series.raw.items.size();
+		case Resolution::kSecond:
+			return series.second.closed.items.size();
+		case Resolution::kMinute:
+			return series.minute.closed.items.size();
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+#ifndef MONITORINGSERIES_HPP
+#define MONITORINGSERIES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "MonitoringSnapshot.hpp"
+
+// Time series of the slow-monitor readings. Every metric of MonitoringSnapshot
+// keeps a ring of full-rate samples plus rings of 1 s and 1 min min/max/mean
+// buckets, so a poller can fetch minutes of history in one request instead of
+// sampling the latest value fast enough to catch transients. All rings are
+// allocated in the constructor; once full, the oldest entries are overwritten.
+class MonitoringSeries {
+public:
+    enum class Resolution : uint8_t {
+        kRaw,
+        kSecond,
+        kMinute,
+    };
+
+    // A raw sample (min == max == mean, count 1) or one rollup bucket, whose
+    // timestamp is the bucket start. Timestamps are unix-epoch ns.
+    struct Point {
+        uint64_t timestamp_ns = 0;
+        float min = 0.0f;
+        float max = 0.0f;
+        float mean = 0.0f;
+        uint32_t count = 0;
+    };
+
+    // Constructor
+    explicit MonitoringSeries(const size_t& rawCapacity = 3000, const size_t& secondCapacity = 3600, const size_t& minuteCapacity = 1440);
+
+    // Destructor
+    ~MonitoringSeries();
+
+    // Append the I2C_1 (rails, bias) or I2C_2 (HD mezzanine) part of a
+    // snapshot, stamped with its cycle time. Disabled HD mezz blocks are skipped.
+    void recordRails(const MonitoringSnapshot& snapshot);
+    void recordHDMezz(const MonitoringSnapshot& snapshot);
+
+    // Metric names in index order, e.g. "v_bias.2" or "hdmezz.0.current_5v".
+    static const std::vector<std::string>& getMetricNames();
+    // -1 for an unknown name.
+    static int findMetric(const std::string& name);
+
+    // Oldest first, timestamps within [from_ns, to_ns] (to_ns 0: no upper
+    // bound). The open bucket of a rollup is included. With more points than
+    // maxPoints (0: no limit) only the newest are kept and *truncated is set.
+    std::vector<Point> query(const size_t& metric, const Resolution& resolution,
+                             const uint64_t& from_ns, const uint64_t& to_ns,
+                             const size_t& maxPoints, bool* truncated = nullptr) const;
+    size_t getCapacity(const Resolution& resolution) const;
+
+private:
+    struct Sample {
+        uint64_t timestamp_ns = 0;
+        float value = 0.0f;
+    };
+
+    struct Bucket {
+        uint64_t start_ns = 0;
+        float min = 0.0f;
+        float max = 0.0f;
+        double sum = 0.0;
+        uint32_t count = 0;
+    };
+
+    template <typename T>
+    struct Ring {
+        std::vector<T> items;
+        size_t head = 0;
+        size_t count = 0;
+
+        void push(const T& item);
+        const T& at(const size_t& i) const;   // 0 is the oldest
+    };
+
+    struct Rollup {
+        uint64_t period_ns = 0;
+        Bucket open;
+        Ring<Bucket> closed;
+    };
+
+    struct Series {
+        Ring<Sample> raw;
+        Rollup second;
+        Rollup minute;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Series> series_;
+
+    // Caller holds mutex_.
+    void push(const size_t& metric, const uint64_t& timestamp_ns, const double& value);
+    static void addToRollup(Rollup& rollup, const uint64_t& timestamp_ns, const float& value);
+};
+
+#endif // MONITORINGSERIES_HPP
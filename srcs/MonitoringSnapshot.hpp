@@ -0,0 +1,44 @@
+#ifndef MONITORINGSNAPSHOT_HPP
+#define MONITORINGSNAPSHOT_HPP
+
+#include <array>
+#include <cstdint>
+
+// Rails of one HD mezzanine block as read by the I2C_2 monitor. Alerts are
+// latched until MT2_CLEAR_HDMEZZ_ALERT_FLAG_REQ.
+struct HDMezzRails {
+    bool enabled = false;
+    bool powered5V = false;
+    bool powered3V3 = false;
+    bool alert5V = false;
+    bool alert3V3 = false;
+    double voltage5V = 0.0;
+    double current5V = 0.0;
+    double power5V = 0.0;
+    double voltage3V3 = 0.0;
+    double current3V3 = 0.0;
+    double power3V3 = 0.0;
+};
+
+// Everything the slow monitor threads publish, as one value. Each thread
+// rewrites its own part per polling cycle; the cycle stamps are unix-epoch ns.
+// Published through Daphne's SeqlockCell, so a read never mixes two cycles
+// of the same thread.
+struct MonitoringSnapshot {
+    // I2C_1: ADS7138 rail and bias monitors.
+    uint64_t railsCycleNs = 0;
+    uint64_t railsCycles = 0;
+    double v3V3PDS = 0.0;
+    double v1V8PDS = 0.0;
+    double v3V3A = 0.0;
+    double v1V8A = 0.0;
+    double vn5VA = 0.0;
+    std::array<double, 5> vBias{};   // board AFE order, V
+
+    // I2C_2: HD mezzanine power monitors.
+    uint64_t hdmezzCycleNs = 0;
+    uint64_t hdmezzCycles = 0;
+    std::array<HDMezzRails, 5> hdmezz{};
+};
+
+#endif // MONITORINGSNAPSHOT_HPP
@@ -0,0 +1,80 @@
+#ifndef SEQLOCKCELL_HPP
+#define SEQLOCKCELL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+// One trivially copyable value published with a sequence lock. Writers
+// serialize on a mutex, apply their change to a private master copy and copy
+// it out as atomic 64-bit words between two sequence bumps; readers copy the
+// words and retry if the sequence moved, so they never block a writer and
+// always see one whole publication.
+template <typename T>
+class SeqlockCell {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqlockCell needs a trivially copyable type");
+
+public:
+    SeqlockCell() {
+        this->publish();
+    }
+
+    // Applies fn to the current value and publishes the result.
+    template <typename Fn>
+    void update(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(this->writeMutex);
+        fn(this->master);
+        this->publish();
+    }
+
+    // The last published value; *sequence_out (optional) counts publications.
+    T load(uint64_t* sequence_out = nullptr) const {
+        std::array<uint64_t, kWords> copy;
+        uint64_t before = 0;
+        while (true) {
+            before = this->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (size_t i = 0; i < kWords; i++) {
+                copy[i] = this->words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (this->sequence.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), copy.data(), sizeof(T));
+        if (sequence_out) {
+            *sequence_out = before / 2;
+        }
+        return value;
+    }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::mutex writeMutex;
+    T master{};
+    std::atomic<uint64_t> sequence{0};
+    std::array<std::atomic<uint64_t>, kWords> words{};
+
+    // Caller holds writeMutex (or is the constructor).
+    void publish() {
+        std::array<uint64_t, kWords> copy{};
+        std::memcpy(copy.data(), &this->master, sizeof(T));
+        const uint64_t seq = this->sequence.load(std::memory_order_relaxed);
+        this->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; i++) {
+            this->words[i].store(copy[i], std::memory_order_relaxed);
+        }
+        this->sequence.store(seq + 2, std::memory_order_release);
+    }
+};
+
+#endif // SEQLOCKCELL_HPP
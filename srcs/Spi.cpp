@@ -1,32 +1,29 @@
 #include "Spi.hpp"
 
+namespace {
+const std::string kAfeControl[5] = {"afeControl_0", "afeControl_1", "afeControl_2", "afeControl_3", "afeControl_4"};
+}
+
 Spi::Spi()
-	: fpgaReg(std::make_unique<FpgaReg>()){}
+	: fpgaReg(std::make_unique<FpgaReg>()){
+
+	this->busy = std::make_unique<CompletionWaiter>("afe_spi", *this->fpgaReg, "afeGlobalControl", "BUSY");
+	this->groupBusy[0] = std::make_unique<CompletionWaiter>("afe_spi_afe0", *this->fpgaReg, "afeGlobalControl", "BUSY_AFE0");
+	this->groupBusy[1] = std::make_unique<CompletionWaiter>("afe_spi_afe12", *this->fpgaReg, "afeGlobalControl", "BUSY_AFE12");
+	this->groupBusy[2] = std::make_unique<CompletionWaiter>("afe_spi_afe34", *this->fpgaReg, "afeGlobalControl", "BUSY_AFE34");
+}
 
 Spi::~Spi(){}
 
 bool Spi::isBusy(){
 
-	return (this->fpgaReg->getBits("afeGlobalControl", "BUSY",0) != 0);
+	return this->busy->isBusy();
 }
 
 bool Spi::waitNotBusy(const double& timeout){
 
-	auto t0 = std::chrono::high_resolution_clock::now();
-
-	while(true){
-		if(!this->isBusy()){
-			break;
-		}
-
-		std::this_thread::sleep_for(std::chrono::microseconds(10));
-
-		auto t1 = std::chrono::high_resolution_clock::now();
-		std::chrono::duration<double> elapsed = t1 - t0;
-
-		if(elapsed.count() > timeout){
-			throw std::runtime_error("Timeout while waiting for SPI transaction");
-		}
+	if(!this->busy->waitIdle(timeout)){
+		throw std::runtime_error("Timeout while waiting for SPI transaction");
 	}
 	return 0;
 }
@@ -35,7 +32,9 @@ uint32_t Spi::setData(const std::string& regName, const uint32_t& value){
 
 	this->waitNotBusy();
 	uint32_t data = this->fpgaReg->setBits(regName, "DATA", value);
-	this->waitNotBusy();
+	if(!this->busy->waitComplete()){
+		throw std::runtime_error("Timeout while waiting for SPI transaction");
+	}
 	return data;
 }
 
@@ -47,6 +46,45 @@ uint32_t Spi::getData(const std::string& regName){
 	return data;
 }
 
+uint32_t Spi::busyGroup(const uint32_t& afe){
+
+	if(afe > 4){
+		throw std::invalid_argument("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
+	}
+	return (afe + 1) / 2;
+}
+
+bool Spi::isGroupBusy(const uint32_t& afe){
+
+	return this->groupBusy[Spi::busyGroup(afe)]->isBusy();
+}
+
+bool Spi::waitGroupNotBusy(const uint32_t& afe, const double& timeout){
+
+	if(!this->groupBusy[Spi::busyGroup(afe)]->waitIdle(timeout)){
+		throw std::runtime_error("Timeout while waiting for SPI transaction on AFE " + std::to_string(afe));
+	}
+	return 0;
+}
+
+uint32_t Spi::setAfeData(const uint32_t& afe, const uint32_t& value){
+
+	this->waitGroupNotBusy(afe);
+	uint32_t data = this->fpgaReg->setBits(kAfeControl[afe], "DATA", value);
+	if(!this->groupBusy[Spi::busyGroup(afe)]->waitComplete()){
+		throw std::runtime_error("Timeout while waiting for SPI transaction on AFE " + std::to_string(afe));
+	}
+	return data;
+}
+
+uint32_t Spi::getAfeData(const uint32_t& afe){
+
+	this->waitGroupNotBusy(afe);
+	uint32_t data = this->fpgaReg->getBits(kAfeControl[afe], "DATA");
+	this->waitGroupNotBusy(afe);
+	return data;
+}
+
 FpgaReg* Spi::getFpgaReg(){
 
 	return this->fpgaReg.get();
@@ -11,7 +11,9 @@
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <array>
 
+#include "CompletionWaiter.hpp"
 #include "FpgaReg.hpp"
 
 class Spi {
@@ -23,13 +25,24 @@ public:
     ~Spi();
 
     bool isBusy();
-    bool waitNotBusy(const double& timeout = 0.01);
+    // A timeout <= 0 uses the adaptive (p99 based) timeout of the busy waiter.
+    bool waitNotBusy(const double& timeout = 0.0);
     uint32_t setData(const std::string& regName, const uint32_t& value);
     uint32_t getData(const std::string& regName);
+    // AFE control channel access that only waits on the busy bit of the SPI group
+    // serving that AFE, so the other groups can be driven at the same time.
+    bool isGroupBusy(const uint32_t& afe);
+    bool waitGroupNotBusy(const uint32_t& afe, const double& timeout = 0.0);
+    uint32_t setAfeData(const uint32_t& afe, const uint32_t& value);
+    uint32_t getAfeData(const uint32_t& afe);
+    // 0: AFE0, 1: AFE1/AFE2, 2: AFE3/AFE4 (frontend/PL numbering).
+    static uint32_t busyGroup(const uint32_t& afe);
     FpgaReg* getFpgaReg();
     
 private:
     std::unique_ptr<FpgaReg> fpgaReg;
+    std::unique_ptr<CompletionWaiter> busy;
+    std::array<std::unique_ptr<CompletionWaiter>, 3> groupBusy;
 };
 
 #endif // SPI_HPP
\ No newline at end of file
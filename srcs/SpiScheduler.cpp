@@ -0,0 +1,92 @@
+#include "SpiScheduler.hpp"
+
+#include <stdexcept>
+
+SpiScheduler::SpiScheduler(Afe& afe)
+	: afe(afe){
+
+	for(uint32_t group = 0; group < kGroups; group++){
+		this->workers_.emplace_back(&SpiScheduler::workerLoop, this, group);
+	}
+}
+
+SpiScheduler::~SpiScheduler(){
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->stop_ = true;
+	}
+	this->cv_.notify_all();
+	for(auto& worker : this->workers_){
+		if(worker.joinable()){
+			worker.join();
+		}
+	}
+}
+
+std::future<uint32_t> SpiScheduler::setRegister(const uint32_t& afe, const uint32_t& register_, const uint32_t& value){
+
+	return this->submit<uint32_t>(afe, [afe, register_, value](Afe& a) { return a.setRegister(afe, register_, value); });
+}
+
+std::future<uint32_t> SpiScheduler::getRegister(const uint32_t& afe, const uint32_t& register_){
+
+	return this->submit<uint32_t>(afe, [afe, register_](Afe& a) { return a.getRegister(afe, register_); });
+}
+
+std::future<std::vector<uint32_t>> SpiScheduler::applyFunctions(const uint32_t& afe, std::vector<std::pair<afe_definitions::AfeFunction, uint16_t>> functions){
+
+	return this->submit<std::vector<uint32_t>>(afe, [afe, functions = std::move(functions)](Afe& a) {
+		return a.applyFunctions(afe, functions);
+	});
+}
+
+void SpiScheduler::enqueue(const uint32_t& afe, std::function<void()> task){
+
+	if(afe >= kAfes){
+		throw std::out_of_range("AFE index " + std::to_string(afe) + " out of range. Expected range 0-4.");
+	}
+	{
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		this->queues_[afe].push_back(std::move(task));
+	}
+	this->cv_.notify_all();
+}
+
+void SpiScheduler::workerLoop(const uint32_t& group){
+
+	// Group g serves AFEs whose Spi::busyGroup() is g: {0}, {1, 2}, {3, 4}.
+	const uint32_t firstAfe = (group == 0) ? 0 : 2 * group - 1;
+	const uint32_t lastAfe = 2 * group;
+	while(true){
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex_);
+			auto pending = [&]() {
+				for(uint32_t afe = firstAfe; afe <= lastAfe; afe++){
+					if(!this->queues_[afe].empty()){
+						return true;
+					}
+				}
+				return false;
+			};
+			this->cv_.wait(lock, [&]() { return this->stop_ || pending(); });
+			if(!pending()){
+				return;
+			}
+			// Round-robin between the AFEs sharing this group.
+			uint32_t afe = this->nextAfe_[group];
+			for(uint32_t i = 0; i <= lastAfe - firstAfe; i++){
+				const uint32_t candidate = firstAfe + (afe - firstAfe + i) % (lastAfe - firstAfe + 1);
+				if(!this->queues_[candidate].empty()){
+					afe = candidate;
+					break;
+				}
+			}
+			task = std::move(this->queues_[afe].front());
+			this->queues_[afe].pop_front();
+			this->nextAfe_[group] = (afe == lastAfe) ? firstAfe : afe + 1;
+		}
+		task();
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef SPISCHEDULER_HPP
+#define SPISCHEDULER_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Afe.hpp"
+
+// Runs AFE SPI work on the three independent SPI busy groups (AFE0, AFE1/2,
+// AFE3/4) at the same time. Every AFE has its own FIFO queue. One worker per
+// group alternates between the queues of its AFEs and only polls that group's
+// busy bit, so a full 5-AFE configuration takes as long as the slowest group.
+// AFE indices are frontend (PL) numbers.
+class SpiScheduler {
+public:
+    static constexpr uint32_t kAfes = 5;
+    static constexpr uint32_t kGroups = 3;
+
+    // Constructor
+    explicit SpiScheduler(Afe& afe);
+
+    // Destructor
+    ~SpiScheduler();
+
+    std::future<uint32_t> setRegister(const uint32_t& afe, const uint32_t& register_, const uint32_t& value);
+    std::future<uint32_t> getRegister(const uint32_t& afe, const uint32_t& register_);
+    std::future<std::vector<uint32_t>> applyFunctions(const uint32_t& afe, std::vector<std::pair<afe_definitions::AfeFunction, uint16_t>> functions);
+
+    // Queues any Afe operation for afe; the future carries its result or exception.
+    template <typename Result>
+    std::future<Result> submit(const uint32_t& afe, std::function<Result(Afe&)> job);
+
+private:
+    Afe& afe;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::array<std::deque<std::function<void()>>, kAfes> queues_;
+    std::array<uint32_t, kGroups> nextAfe_{{0, 1, 3}};   // round-robin cursor per group
+    std::vector<std::thread> workers_;
+
+    void enqueue(const uint32_t& afe, std::function<void()> task);
+    void workerLoop(const uint32_t& group);
+};
+
+template <typename Result>
+std::future<Result> SpiScheduler::submit(const uint32_t& afe, std::function<Result(Afe&)> job){
+    auto task = std::make_shared<std::packaged_task<Result()>>(
+        [this, job = std::move(job)]() { return job(this->afe); });
+    std::future<Result> result = task->get_future();
+    this->enqueue(afe, [task]() { (*task)(); });
+    return result;
+}
+
+#endif // SPISCHEDULER_HPP
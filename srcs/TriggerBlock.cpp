@@ -0,0 +1,231 @@
+#include "TriggerBlock.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "FpgaRegDict.hpp"
+
+namespace {
+constexpr size_t kThresholdSpan = TriggerBlock::kStride * TriggerBlock::kNumChannels;
+constexpr size_t kControlSpan = TriggerBlock::kMatchingTemplate0 + 4 * TriggerBlock::kMatchingTemplates - TriggerBlock::kEnableMaskLow;
+constexpr uint32_t kCounterRetries = 4;
+
+// Union of the bit fields FpgaRegDict defines for a register.
+uint32_t implementedBits(const FpgaRegDict& dict, const std::string& regName){
+
+	const auto& registers = dict.getRegisterMap();
+	const auto it = registers.find(regName);
+	if(it == registers.end()){
+		throw std::invalid_argument("Register " + regName + " not found in FpgaRegDict.");
+	}
+	uint32_t bits = 0;
+	for(const auto& field : it->second.second){
+		const int width = field.second.second - field.second.first + 1;
+		const uint32_t mask = width >= 32 ? 0xFFFFFFFFu : ((1u << width) - 1u);
+		bits |= mask << field.second.first;
+	}
+	return bits;
+}
+
+void checkChannel(const uint32_t& channel){
+
+	if(channel >= TriggerBlock::kNumChannels){
+		throw std::out_of_range("Trigger channel out of range (0..39): " + std::to_string(channel));
+	}
+}
+}
+
+TriggerBlock::TriggerBlock(){
+
+	const FpgaRegDict dict;
+	this->enableMaskLowBits = implementedBits(dict, "triggerEnableLow");
+	this->enableMaskHighBits = implementedBits(dict, "triggerEnableHigh");
+	this->fullConfigLowBits = implementedBits(dict, "selfTriggerFullConfigLow");
+	this->fullConfigHighBits = implementedBits(dict, "selfTriggerFullConfigHIGH");
+	this->matchingTemplateBits = implementedBits(dict, "matchingTriggerTemplate_0");
+}
+
+TriggerBlock::~TriggerBlock(){}
+
+void TriggerBlock::mapMemory(){
+
+	if(!this->thresholdMem){
+		auto mem = std::make_unique<DevMem>(kThresholdBase);
+		mem->map_memory(kThresholdSpan);
+		this->thresholdMem = std::move(mem);
+	}
+	if(!this->controlMem){
+		auto mem = std::make_unique<DevMem>(kEnableMaskLow);
+		mem->map_memory(kControlSpan);
+		this->controlMem = std::move(mem);
+	}
+}
+
+uint32_t TriggerBlock::readControl(const uint64_t& address){
+
+	return this->controlMem->read_u32(address - kEnableMaskLow);
+}
+
+bool TriggerBlock::writeControl(const uint64_t& address, const uint32_t& value, const uint32_t& mask){
+
+	this->controlMem->write_u32(address - kEnableMaskLow, value);
+	return (this->readControl(address) & mask) == (value & mask);
+}
+
+uint64_t TriggerBlock::readPair(const uint64_t& low, const uint64_t& high, const uint32_t& lowMask, const uint32_t& highMask){
+
+	const uint64_t lo = this->readControl(low) & lowMask;
+	const uint64_t hi = this->readControl(high) & highMask;
+	return (hi << 32) | lo;
+}
+
+bool TriggerBlock::writePair(const uint64_t& low, const uint64_t& high, const uint64_t& value,
+                             const uint32_t& lowMask, const uint32_t& highMask){
+
+	const bool lowOk = this->writeControl(low, static_cast<uint32_t>(value & 0xFFFFFFFF), lowMask);
+	const bool highOk = this->writeControl(high, static_cast<uint32_t>(value >> 32), highMask);
+	return lowOk && highOk;
+}
+
+uint32_t TriggerBlock::getThreshold(const uint32_t& channel){
+
+	checkChannel(channel);
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	return this->thresholdMem->read_u32(channel * kStride + kOffThreshold) & kThresholdMask;
+}
+
+std::array<uint32_t, TriggerBlock::kNumChannels> TriggerBlock::getThresholds(){
+
+	std::array<uint32_t, kNumChannels> thresholds{};
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	for(uint32_t ch = 0; ch < kNumChannels; ch++){
+		thresholds[ch] = this->thresholdMem->read_u32(ch * kStride + kOffThreshold) & kThresholdMask;
+	}
+	return thresholds;
+}
+
+std::vector<uint32_t> TriggerBlock::setThresholds(const std::vector<std::pair<uint32_t, uint32_t>>& thresholds){
+
+	for(const auto& threshold : thresholds){
+		checkChannel(threshold.first);
+	}
+	std::vector<uint32_t> mismatches;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	for(const auto& threshold : thresholds){
+		this->thresholdMem->write_u32(threshold.first * kStride + kOffThreshold, threshold.second & kThresholdMask);
+	}
+	for(const auto& threshold : thresholds){
+		const uint32_t readBack = this->thresholdMem->read_u32(threshold.first * kStride + kOffThreshold) & kThresholdMask;
+		if(readBack != (threshold.second & kThresholdMask)){
+			mismatches.push_back(threshold.first);
+		}
+	}
+	return mismatches;
+}
+
+TriggerBlock::Counters TriggerBlock::readCounters(const uint32_t& channel){
+
+	const size_t base = channel * kStride;
+	// A carry between the two reads would pair a stale high word with a
+	// wrapped low word; re-read high and retry until it holds still.
+	auto read64 = [&](const uint32_t& lo, const uint32_t& hi){
+		uint64_t h = this->thresholdMem->read_u32(base + hi);
+		uint64_t l = this->thresholdMem->read_u32(base + lo);
+		for(uint32_t retry = 0; retry < kCounterRetries; retry++){
+			const uint64_t again = this->thresholdMem->read_u32(base + hi);
+			if(again == h){
+				break;
+			}
+			h = again;
+			l = this->thresholdMem->read_u32(base + lo);
+		}
+		return (h << 32) | l;
+	};
+	Counters counters;
+	counters.record = read64(kOffRecordLo, kOffRecordHi);
+	counters.busy = read64(kOffBusyLo, kOffBusyHi);
+	counters.full = read64(kOffFullLo, kOffFullHi);
+	return counters;
+}
+
+TriggerBlock::Counters TriggerBlock::getCounters(const uint32_t& channel){
+
+	checkChannel(channel);
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	return this->readCounters(channel);
+}
+
+std::array<TriggerBlock::Counters, TriggerBlock::kNumChannels> TriggerBlock::getAllCounters(){
+
+	std::array<Counters, kNumChannels> counters;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	for(uint32_t ch = 0; ch < kNumChannels; ch++){
+		counters[ch] = this->readCounters(ch);
+	}
+	return counters;
+}
+
+uint64_t TriggerBlock::getEnableMask(){
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	return this->readPair(kEnableMaskLow, kEnableMaskHigh, this->enableMaskLowBits, this->enableMaskHighBits);
+}
+
+bool TriggerBlock::setEnableMask(const uint64_t& mask){
+
+	if(mask >> kNumChannels){
+		throw std::out_of_range("Trigger enable mask has bits above channel 39.");
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	return this->writePair(kEnableMaskLow, kEnableMaskHigh, mask, this->enableMaskLowBits, this->enableMaskHighBits);
+}
+
+uint64_t TriggerBlock::getFullConfig(){
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	return this->readPair(kFullConfigLow, kFullConfigHigh, this->fullConfigLowBits, this->fullConfigHighBits);
+}
+
+bool TriggerBlock::setFullConfig(const uint64_t& config){
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	return this->writePair(kFullConfigLow, kFullConfigHigh, config, this->fullConfigLowBits, this->fullConfigHighBits);
+}
+
+std::array<uint32_t, TriggerBlock::kMatchingTemplates> TriggerBlock::getMatchingTemplates(){
+
+	std::array<uint32_t, kMatchingTemplates> templates{};
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	for(uint32_t i = 0; i < kMatchingTemplates; i++){
+		templates[i] = this->readControl(kMatchingTemplate0 + 4 * i) & kMatchingTemplateMask;
+	}
+	return templates;
+}
+
+std::vector<uint32_t> TriggerBlock::setMatchingTemplates(const std::vector<std::pair<uint32_t, uint32_t>>& templates){
+
+	for(const auto& template_ : templates){
+		if(template_.first >= kMatchingTemplates){
+			throw std::out_of_range("Matching trigger template out of range (0..15): " + std::to_string(template_.first));
+		}
+	}
+	std::vector<uint32_t> mismatches;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->mapMemory();
+	for(const auto& template_ : templates){
+		if(!this->writeControl(kMatchingTemplate0 + 4 * template_.first, template_.second & kMatchingTemplateMask, this->matchingTemplateBits)){
+			mismatches.push_back(template_.first);
+		}
+	}
+	return mismatches;
+}
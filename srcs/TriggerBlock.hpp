@@ -0,0 +1,94 @@
+#ifndef TRIGGERBLOCK_HPP
+#define TRIGGERBLOCK_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "DevMem.hpp"
+
+// Self-trigger registers behind two persistent /dev/mem mappings, made on
+// first use: the per-channel block at kThresholdBase (threshold plus 64-bit
+// record/busy/full counters, one kStride slot per channel) and the FPGA
+// register window holding the enable masks (triggerEnableLow/High),
+// selfTriggerFullConfigLow/HIGH and matchingTriggerTemplate_0..15.
+// Every setter reads the written registers back and compares the bits of the
+// fields FpgaRegDict defines for them; unimplemented bits read 0. 64-bit
+// counters are read high/low/high and retried if the high word moved.
+class TriggerBlock {
+public:
+    static constexpr uint64_t kThresholdBase = 0xA0010000;
+    static constexpr uint32_t kStride = 0x20;
+    static constexpr uint32_t kNumChannels = 40;
+    static constexpr uint32_t kOffThreshold = 0x00;
+    static constexpr uint32_t kOffRecordLo = 0x04;
+    static constexpr uint32_t kOffRecordHi = 0x08;
+    static constexpr uint32_t kOffBusyLo = 0x0C;
+    static constexpr uint32_t kOffBusyHi = 0x10;
+    static constexpr uint32_t kOffFullLo = 0x14;
+    static constexpr uint32_t kOffFullHi = 0x18;
+    static constexpr uint32_t kThresholdMask = 0x0FFFFFFF;
+
+    // FpgaReg base (0x80000000) + FpgaRegDict offsets.
+    static constexpr uint64_t kEnableMaskLow = 0x94000020;
+    static constexpr uint64_t kEnableMaskHigh = 0x94000024;
+    static constexpr uint64_t kFullConfigLow = 0x94000040;
+    static constexpr uint64_t kFullConfigHigh = 0x94000044;
+    static constexpr uint64_t kMatchingTemplate0 = 0x94000048;
+    static constexpr uint32_t kMatchingTemplates = 16;
+    static constexpr uint32_t kMatchingTemplateMask = 0x0FFFFFFF;
+
+    struct Counters {
+        uint64_t record = 0;
+        uint64_t busy = 0;
+        uint64_t full = 0;
+    };
+
+    // Constructor
+    TriggerBlock();
+
+    // Destructor
+    ~TriggerBlock();
+
+    uint32_t getThreshold(const uint32_t& channel);
+    std::array<uint32_t, kNumChannels> getThresholds();
+    // {channel, threshold}; values are masked to kThresholdMask. Returns the
+    // channels whose read-back differs. Throws std::out_of_range on a bad channel.
+    std::vector<uint32_t> setThresholds(const std::vector<std::pair<uint32_t, uint32_t>>& thresholds);
+    Counters getCounters(const uint32_t& channel);
+    // All channels under one lock, as used by the background sampler.
+    std::array<Counters, kNumChannels> getAllCounters();
+
+    // Bit i enables channel i (0..39), written as one low/high pair.
+    uint64_t getEnableMask();
+    bool setEnableMask(const uint64_t& mask);
+    uint64_t getFullConfig();
+    bool setFullConfig(const uint64_t& config);
+    std::array<uint32_t, kMatchingTemplates> getMatchingTemplates();
+    // {index, value}; returns the indices whose read-back differs.
+    std::vector<uint32_t> setMatchingTemplates(const std::vector<std::pair<uint32_t, uint32_t>>& templates);
+
+private:
+    std::mutex mutex;
+    std::unique_ptr<DevMem> thresholdMem;
+    std::unique_ptr<DevMem> controlMem;
+    // Implemented bits of each control register, from its FpgaRegDict fields.
+    uint32_t enableMaskLowBits;
+    uint32_t enableMaskHighBits;
+    uint32_t fullConfigLowBits;
+    uint32_t fullConfigHighBits;
+    uint32_t matchingTemplateBits;
+
+    void mapMemory();
+    Counters readCounters(const uint32_t& channel);
+    uint32_t readControl(const uint64_t& address);
+    bool writeControl(const uint64_t& address, const uint32_t& value, const uint32_t& mask);
+    uint64_t readPair(const uint64_t& low, const uint64_t& high, const uint32_t& lowMask, const uint32_t& highMask);
+    bool writePair(const uint64_t& low, const uint64_t& high, const uint64_t& value,
+                   const uint32_t& lowMask, const uint32_t& highMask);
+};
+
+#endif // TRIGGERBLOCK_HPP
@@ -0,0 +1,203 @@
+// Drives AlignmentEngine through a simulated frontend and compares it with the
+// per-AFE full scan of Daphne::setBestDelay/setBestBitslip.
+//
+// Each simulated AFE has a fixed delay -> frame-clock table: stable windows,
+// each one holding 0x00FF00FF rotated by its own bit offset, separated by a few
+// taps of noise. Bitslip b rotates the word left by b, so the pattern is found
+// at the bitslip equal to the window's offset.
+//
+//   alignment_bench [trials] [seed]
+//
+// Exit status is non-zero when the engine picks a different delay or bitslip
+// than the full scan in the "wide" case (every window at least one coarse step
+// wide), where both must agree. The "narrow" case is only reported: there, two
+// equal coarse samples can fall in different windows with the same offset,
+// which the coarse pass cannot tell from one wide window (see AlignmentEngine.hpp).
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AlignmentEngine.hpp"
+
+namespace {
+constexpr uint32_t kAfes = AlignmentProbe::kAfes;
+constexpr uint32_t kDelayTaps = 512;
+constexpr uint32_t kBitslipTaps = 16;
+constexpr uint32_t kCoarseStep = 16;
+constexpr uint32_t kTarget32 = 0x00FF00FFu;
+
+uint32_t rotl(const uint32_t& word, const uint32_t& bits){
+
+	const uint32_t n = bits % 32;
+	return n == 0 ? word : (word << n) | (word >> (32 - n));
+}
+
+uint32_t rotr(const uint32_t& word, const uint32_t& bits){
+
+	return rotl(word, 32 - bits % 32);
+}
+
+struct Eye {
+	std::vector<uint32_t> words;   // per delay tap, at bitslip 0
+};
+
+// Windows of minWidth..maxWidth taps separated by 1..6 noisy taps; adjacent
+// windows never share a bit offset.
+Eye makeEye(std::mt19937& rng, const uint32_t& minWidth, const uint32_t& maxWidth){
+
+	std::uniform_int_distribution<uint32_t> width(minWidth, maxWidth);
+	std::uniform_int_distribution<uint32_t> gap(1, 6);
+	std::uniform_int_distribution<uint32_t> offset(0, kBitslipTaps - 1);
+	std::uniform_int_distribution<uint32_t> noise;
+
+	Eye eye;
+	uint32_t previous = kBitslipTaps;
+	while(eye.words.size() < kDelayTaps){
+		uint32_t k = offset(rng);
+		while(k == previous){
+			k = offset(rng);
+		}
+		previous = k;
+		const uint32_t word = rotr(kTarget32, k);
+		for(uint32_t i = width(rng); i > 0 && eye.words.size() < kDelayTaps; i--){
+			eye.words.push_back(word);
+		}
+		for(uint32_t i = gap(rng); i > 0 && eye.words.size() < kDelayTaps; i--){
+			eye.words.push_back(noise(rng));
+		}
+	}
+	return eye;
+}
+
+class SimulatedProbe : public AlignmentProbe {
+public:
+	explicit SimulatedProbe(const std::array<Eye, kAfes>& eyes) : eyes(eyes){}
+
+	void setDelay(const uint32_t& afe, const uint32_t& delay) override { this->delay[afe] = delay; }
+	uint32_t getDelay(const uint32_t& afe) override { return this->delay[afe]; }
+	void setBitslip(const uint32_t& afe, const uint32_t& bitslip) override { this->bitslip[afe] = bitslip; }
+	uint32_t getBitslip(const uint32_t& afe) override { return this->bitslip[afe]; }
+
+	std::array<uint32_t, kAfes> snapshot() override {
+		this->triggers++;
+		std::array<uint32_t, kAfes> words{};
+		for(uint32_t afe = 0; afe < kAfes; afe++){
+			words[afe] = rotl(this->eyes[afe].words[this->delay[afe]], this->bitslip[afe]);
+		}
+		return words;
+	}
+
+	uint32_t triggers = 0;
+
+private:
+	const std::array<Eye, kAfes>& eyes;
+	std::array<uint32_t, kAfes> delay{};
+	std::array<uint32_t, kAfes> bitslip{};
+};
+
+struct Choice {
+	uint32_t delay = 0;
+	uint32_t bitslip = 0;
+	bool matched = false;
+};
+
+// One AFE at a time, every tap, as Daphne::setBestDelay + setBestBitslip do.
+std::array<Choice, kAfes> fullScan(SimulatedProbe& probe){
+
+	std::array<Choice, kAfes> result{};
+	for(uint32_t afe = 0; afe < kAfes; afe++){
+		std::vector<uint32_t> data(kDelayTaps);
+		for(uint32_t tap = 0; tap < kDelayTaps; tap++){
+			probe.setDelay(afe, tap);
+			data[tap] = probe.snapshot()[afe];
+		}
+		const auto window = AlignmentEngine::longestIdenticalSubsequenceIndices(data);
+		result[afe].delay = window->first + (window->second - window->first) / 2;
+		probe.setDelay(afe, result[afe].delay);
+
+		const uint32_t initialBitslip = probe.getBitslip(afe);
+		result[afe].bitslip = initialBitslip;
+		for(uint32_t bitslip = 0; bitslip < kBitslipTaps; bitslip++){
+			probe.setBitslip(afe, bitslip);
+			if(!result[afe].matched && probe.snapshot()[afe] == kTarget32){
+				result[afe].matched = true;
+				result[afe].bitslip = bitslip;
+			}
+		}
+		probe.setBitslip(afe, result[afe].bitslip);
+		probe.snapshot();
+	}
+	return result;
+}
+
+struct Totals {
+	uint64_t afes = 0;
+	uint64_t mismatches = 0;
+	uint64_t fallbacks = 0;
+	uint64_t engineTriggers = 0;
+	uint64_t fullScanTriggers = 0;
+};
+
+Totals run(const std::string& name, const uint32_t& trials, const uint32_t& seed,
+           const uint32_t& minWidth, const uint32_t& maxWidth){
+
+	std::mt19937 rng(seed);
+	Totals totals;
+	for(uint32_t trial = 0; trial < trials; trial++){
+		std::array<Eye, kAfes> eyes;
+		for(auto& eye : eyes){
+			eye = makeEye(rng, minWidth, maxWidth);
+		}
+
+		SimulatedProbe baselineProbe(eyes);
+		const std::array<Choice, kAfes> expected = fullScan(baselineProbe);
+
+		SimulatedProbe engineProbe(eyes);
+		AlignmentEngine engine(engineProbe, kDelayTaps, kCoarseStep, kBitslipTaps);
+		// Keep the engine's "could not find expected pattern" warnings out of the report.
+		std::streambuf* cerrBuf = std::cerr.rdbuf(nullptr);
+		const std::array<AfeAlignment, kAfes> got = engine.align();
+		std::cerr.rdbuf(cerrBuf);
+
+		for(uint32_t afe = 0; afe < kAfes; afe++){
+			totals.afes++;
+			totals.fallbacks += got[afe].fullScan ? 1 : 0;
+			if(got[afe].delay != expected[afe].delay || got[afe].matched != expected[afe].matched ||
+			   got[afe].bitslip != expected[afe].bitslip){
+				totals.mismatches++;
+				if(totals.mismatches <= 5){
+					std::cerr << name << " trial " << trial << " AFE " << afe << ": engine delay/bitslip "
+					          << got[afe].delay << "/" << got[afe].bitslip << ", full scan "
+					          << expected[afe].delay << "/" << expected[afe].bitslip << std::endl;
+				}
+			}
+		}
+		totals.engineTriggers += engine.getTriggerCount();
+		totals.fullScanTriggers += baselineProbe.triggers;
+	}
+
+	std::cout << std::left << std::setw(8) << name
+	          << " windows " << minWidth << ".." << maxWidth << " taps: "
+	          << trials << " trials, " << totals.mismatches << "/" << totals.afes << " AFEs differ, "
+	          << totals.fallbacks << " full-scan fallbacks; triggers per alignment: engine "
+	          << (trials ? totals.engineTriggers / trials : 0) << ", full scan "
+	          << (trials ? totals.fullScanTriggers / trials : 0) << std::endl;
+	return totals;
+}
+}
+
+int main(int argc, char** argv){
+
+	const uint32_t trials = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 0)) : 200;
+	const uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 0)) : 1;
+
+	const Totals wide = run("wide", trials, seed, kCoarseStep + 8, 180);
+	run("narrow", trials, seed, 2, kCoarseStep - 2);
+	return wide.mismatches == 0 ? 0 : 1;
+}
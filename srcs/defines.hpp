@@ -1,6 +1,9 @@
 #ifndef DEFINES_HPP
 #define DEFINES_HPP
 
+#include <array>
+#include <cstdint>
+#include <optional>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -25,196 +28,247 @@ namespace afe_definitions {
         {1, 4}
     };
 
-    // {FUNCTION_NAME, {REGISTER_ADDR, {BITH, BITL}}}
-    const std::unordered_map<std::string, BitField> afeFunctionDict = { 
-        {"SOFTWARE_RESET", {{0, {0, 0}}}},
-        {"REGISTER_READOUT_ENABLE", {{0, {1, 1}}}},
-        {"ADC_COMPLETE_PDN", {{1, {0, 0}}}},
-        {"LVDS_OUTPUT_DISABLE", {{1, {1, 1}}}},
-        {"ADC_PDN_CH", {{1, {9, 2}}}},
-        {"PARTIAL_PDN", {{1, {10, 10}}}},
-        {"LOW_FREQUENCY_NOISE_SUPPRESSION", {{1, {11, 11}}}},
-        {"EXT_REF", {{1 , {13, 13}}}},
-        {"LVDS_OUTPUT_RATE_2X", {{1, {12, 14}}}},
-        {"SINGLE-ENDED_CLK_MODE", {{1, {15, 15}}}},
-        {"POWER-DOWN_LVDS", {{2, {10, 3}}}},
-        {"AVERAGING_ENABLE", {{2, {11, 11}}}},
-        {"LOW_LATENCY", {{2, {12, 12}}}},
-        {"TEST_PATTERN_MODES", {{2, {15, 13}}}},
-        {"INVERT_CHANNELS", {{3, {7, 0}}}},
-        {"CHANNEL_OFFSET_SUBSTRACTION_ENABLE", {{3, {8, 8}}}},
-        {"DIGITAL_GAIN_ENABLE", {{3, {12, 12}}}},
-        {"SERIALIZED_DATA_RATE", {{3, {14, 13}}}},
-        {"ENABLE_EXTERNAL_REFERENCE_MODE", {{3, {15, 15}}}},
-        {"ADC_RESOLUTION_RESET", {{4, {1, 1}}}},
-        {"ADC_OUTPUT_FORMAT", {{4, {3, 3}}}},
-        {"LSB_MSB_FIRST", {{4, {4 ,4}}}},
-        {"CUSTOM_PATTERN", {{5, {13, 0}}}},
-        {"SYNC_PATTERN", {{10, {8, 8}}}},
-        {"OFFSET_CH1", {{13, {9, 0}}}},
-        {"DIGITAL_GAIN_CH1", {{13, {15, 11}}}},
-        {"OFFSET_CH2", {{15, {9, 0}}}},
-        {"DIGITAL_GAIN_CH2", {{15, {15, 11}}}},
-        {"OFFSET_CH3", {{17, {9, 0}}}},
-        {"DIGITAL_GAIN_CH3", {{17, {15, 11}}}},
-        {"OFFSET_CH4", {{19, {9, 0}}}},
-        {"DIGITAL_GAIN_CH4", {{19, {15, 11}}}},
-        {"DIGITAL_HPF_FILTER_ENABLE_CH1-4", {{21, {0, 0}}}},
-        {"DIGITAL_HPF_FILTER_K_CH1-4", {{21, {4, 1}}}},
-        {"OFFSET_CH8", {{25, {9, 0}}}},
-        {"DIGITAL_GAIN_CH8", {{25, {15, 11}}}},
-        {"OFFSET_CH7", {{27, {9, 0}}}},
-        {"DIGITAL_GAIN_CH7", {{27, {15, 11}}}},
-        {"OFFSET_CH6", {{29, {9, 0}}}},
-        {"DIGITAL_GAIN_CH6", {{29, {15, 11}}}},
-        {"OFFSET_CH5", {{31, {9, 0}}}},
-        {"DIGITAL_GAIN_CH5", {{31, {15, 11}}}},
-        {"DIGITAL_HPF_FILTER_ENABLE_CH5-8", {{33, {0, 0}}}},
-        {"DIGITAL_HPF_FILTER_K_CH5-8", {{33, {4, 1}}}},
-        {"DITHER", {{66, {15, 15}}}},
-        {"PGA_CLAMP_-6dB", {{50, {10, 10}}}},
-        {"LPF_PROGRAMMABILITY", {{51, {3, 1}}}},
-        {"PGA_INTEGRATOR_DISABLE", {{51, {4, 4}}}},
-        {"PGA_CLAMP_LEVEL", {{51, {7, 5}}}},
-        {"PGA_GAIN_CONTROL", {{51, {13, 13}}}},
-        {"ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_CNTL", {{52, {4, 0}}}},
-        {"ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_ENABLE", {{52, {5, 5}}}},
-        {"PRESET_ACTIVE_TERMINATIONS", {{52, {7, 6}}}},
-        {"ACTIVE_TERMINATION_ENABLE", {{52, {8, 8}}}},
-        {"LNA_INPUT_CLAMP_SETTING", {{52, {10, 9}}}},
-        {"LNA_INTEGRATOR_DISABLE", {{52, {12, 12}}}},
-        {"LNA_GAIN", {{52, {14, 13}}}},
-        {"LNA_INDIVIDUAL_CH_CNTL", {{52, {15, 15}}}},
-        {"PDN_CH", {{53, {7, 0}}}},
-        {"LOW_POWER", {{53, {10, 10}}}},
-        {"MED_POWER", {{53, {11, 11}}}},
-        {"PDN_VCAT_PGA", {{53, {12, 12}}}},
-        {"PDN_LNA", {{53, {13, 13}}}},
-        {"VCA_PARTIAL_PDN", {{53, {14, 14}}}},
-        {"VCA_COMPLETE_PDN", {{53, {15, 15}}}},
-        {"CW_SUM_AMP_GAIN_CNTL", {{54, {4, 0}}}},
-        {"CW_16X_CLK_SEL", {{54, {5, 5}}}},
-        {"CW_1X_CLK_SEL", {{54, {6, 6}}}},
-        {"CW_TGC_SEL", {{54, {8, 8}}}}, 
-        {"CW_SUM_AMP_ENABLE", {{54, {9, 9}}}},
-        {"CW_CLK_MODE_SEL", {{54, {11, 10}}}},
-        {"CH1_CW_MIXER_PHASE", {{55, {3 ,0}}}},
-        {"CH2_CW_MIXER_PHASE", {{55, {7, 4}}}},
-        {"CH3_CW_MIXER_PHASE", {{55, {11, 8}}}},
-        {"CH4_CW_MIXER_PHASE", {{55, {15, 12}}}},
-        {"CH5_CW_MIXER_PHASE", {{56, {3, 0}}}},
-        {"CH6_CW_MIXER_PHASE", {{56, {7, 4}}}},
-        {"CH7_CW_MIXER_PHASE", {{56, {11, 8}}}},
-        {"CH8_CW_MIXER_PHASE", {{56, {15, 12}}}},
-        {"CH1_LNA_GAIN_CNTL", {{57, {1, 0}}}},
-        {"CH2_LNA_GAIN_CNTL", {{57, {3, 2}}}},
-        {"CH3_LNA_GAIN_CNTL", {{57, {5, 4}}}},
-        {"CH4_LNA_GAIN_CNTL", {{57, {7, 6}}}},
-        {"CH5_LNA_GAIN_CNTL", {{57, {9, 8}}}},
-        {"CH6_LNA_GAIN_CNTL", {{57, {11, 10}}}},
-        {"CH7_LNA_GAIN_CNTL", {{57, {13, 12}}}},
-        {"CH8_LNA_GAIN_CNTL", {{57, {15, 14}}}},
-        {"HPF_LNA", {{59, {3, 2}}}},
-        {"DIG_TGC_ATT_GAIN", {{59, {6, 4}}}},
-        {"DIG_TGC_ATT", {{59, {7, 7}}}},
-        {"CW_SUM_AMP_PDN", {{59, {8, 8}}}},
-        {"PGA_TEST_MODE", {{59 , {9, 9}}}}
+    // AFE5808 functions. The order matches afeFunctionTable and the AfeFunctionId
+    // enum of daphneV3_low_level_confs.proto (AFE_FN_<NAME> = index + 1).
+    enum class AfeFunction : uint8_t {
+        SOFTWARE_RESET,
+        REGISTER_READOUT_ENABLE,
+        ADC_COMPLETE_PDN,
+        LVDS_OUTPUT_DISABLE,
+        ADC_PDN_CH,
+        PARTIAL_PDN,
+        LOW_FREQUENCY_NOISE_SUPPRESSION,
+        EXT_REF,
+        LVDS_OUTPUT_RATE_2X,
+        SINGLE_ENDED_CLK_MODE,
+        POWER_DOWN_LVDS,
+        AVERAGING_ENABLE,
+        LOW_LATENCY,
+        TEST_PATTERN_MODES,
+        INVERT_CHANNELS,
+        CHANNEL_OFFSET_SUBSTRACTION_ENABLE,
+        DIGITAL_GAIN_ENABLE,
+        SERIALIZED_DATA_RATE,
+        ENABLE_EXTERNAL_REFERENCE_MODE,
+        ADC_RESOLUTION_RESET,
+        ADC_OUTPUT_FORMAT,
+        LSB_MSB_FIRST,
+        CUSTOM_PATTERN,
+        SYNC_PATTERN,
+        OFFSET_CH1,
+        DIGITAL_GAIN_CH1,
+        OFFSET_CH2,
+        DIGITAL_GAIN_CH2,
+        OFFSET_CH3,
+        DIGITAL_GAIN_CH3,
+        OFFSET_CH4,
+        DIGITAL_GAIN_CH4,
+        DIGITAL_HPF_FILTER_ENABLE_CH1_4,
+        DIGITAL_HPF_FILTER_K_CH1_4,
+        OFFSET_CH8,
+        DIGITAL_GAIN_CH8,
+        OFFSET_CH7,
+        DIGITAL_GAIN_CH7,
+        OFFSET_CH6,
+        DIGITAL_GAIN_CH6,
+        OFFSET_CH5,
+        DIGITAL_GAIN_CH5,
+        DIGITAL_HPF_FILTER_ENABLE_CH5_8,
+        DIGITAL_HPF_FILTER_K_CH5_8,
+        DITHER,
+        PGA_CLAMP_MINUS_6DB,
+        LPF_PROGRAMMABILITY,
+        PGA_INTEGRATOR_DISABLE,
+        PGA_CLAMP_LEVEL,
+        PGA_GAIN_CONTROL,
+        ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_CNTL,
+        ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_ENABLE,
+        PRESET_ACTIVE_TERMINATIONS,
+        ACTIVE_TERMINATION_ENABLE,
+        LNA_INPUT_CLAMP_SETTING,
+        LNA_INTEGRATOR_DISABLE,
+        LNA_GAIN,
+        LNA_INDIVIDUAL_CH_CNTL,
+        PDN_CH,
+        LOW_POWER,
+        MED_POWER,
+        PDN_VCAT_PGA,
+        PDN_LNA,
+        VCA_PARTIAL_PDN,
+        VCA_COMPLETE_PDN,
+        CW_SUM_AMP_GAIN_CNTL,
+        CW_16X_CLK_SEL,
+        CW_1X_CLK_SEL,
+        CW_TGC_SEL,
+        CW_SUM_AMP_ENABLE,
+        CW_CLK_MODE_SEL,
+        CH1_CW_MIXER_PHASE,
+        CH2_CW_MIXER_PHASE,
+        CH3_CW_MIXER_PHASE,
+        CH4_CW_MIXER_PHASE,
+        CH5_CW_MIXER_PHASE,
+        CH6_CW_MIXER_PHASE,
+        CH7_CW_MIXER_PHASE,
+        CH8_CW_MIXER_PHASE,
+        CH1_LNA_GAIN_CNTL,
+        CH2_LNA_GAIN_CNTL,
+        CH3_LNA_GAIN_CNTL,
+        CH4_LNA_GAIN_CNTL,
+        CH5_LNA_GAIN_CNTL,
+        CH6_LNA_GAIN_CNTL,
+        CH7_LNA_GAIN_CNTL,
+        CH8_LNA_GAIN_CNTL,
+        HPF_LNA,
+        DIG_TGC_ATT_GAIN,
+        DIG_TGC_ATT,
+        CW_SUM_AMP_PDN,
+        PGA_TEST_MODE,
     };
 
-    const std::unordered_map<std::string, std::vector<uint16_t>> afeFunctionAvailableOptionsDict = { 
-        {"SOFTWARE_RESET", {0, 1}},
-        {"REGISTER_READOUT_ENABLE", {0, 1}},
-        {"ADC_COMPLETE_PDN", {0, 1}},
-        {"LVDS_OUTPUT_DISABLE", {0, 1}},
-        {"ADC_PDN_CH", {0, 0xFF}},
-        {"PARTIAL_PDN", {0, 1}},
-        {"LOW_FREQUENCY_NOISE_SUPPRESSION", {0, 1}},
-        {"EXT_REF", {0, 1}},
-        {"LVDS_OUTPUT_RATE_2X", {0, 1}},
-        {"SINGLE-ENDED_CLK_MODE", {0, 1}},
-        {"POWER-DOWN_LVDS", {0, 1}},
-        {"AVERAGING_ENABLE", {0, 1}},
-        {"LOW_LATENCY", {0, 1}},
-        {"TEST_PATTERN_MODES", {0, 0x7}},
-        {"INVERT_CHANNELS", {0, 0xFF}},
-        {"CHANNEL_OFFSET_SUBSTRACTION_ENABLE", {0, 1}},
-        {"DIGITAL_GAIN_ENABLE", {0, 1}},
-        {"SERIALIZED_DATA_RATE", {0, 0x3}},
-        {"ENABLE_EXTERNAL_REFERENCE_MODE", {0, 1}},
-        {"ADC_RESOLUTION_RESET", {0, 1}},
-        {"ADC_OUTPUT_FORMAT", {0, 1}},
-        {"LSB_MSB_FIRST", {0, 1}},
-        {"CUSTOM_PATTERN", {0, 0x3FFF}},
-        {"SYNC_PATTERN", {0, 1}},
-        {"OFFSET_CH1", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH1", {0, 0x1F}},
-        {"OFFSET_CH2", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH2", {0, 0x1F}},
-        {"OFFSET_CH3", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH3", {0, 0x1F}},
-        {"OFFSET_CH4", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH4", {0, 0x1F}},
-        {"DIGITAL_HPF_FILTER_ENABLE_CH1-4", {0, 1}},
-        {"DIGITAL_HPF_FILTER_K_CH1-4", {2, 10}},
-        {"OFFSET_CH8", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH8", {0, 0x1F}},
-        {"OFFSET_CH7", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH7", {0, 0x1F}},
-        {"OFFSET_CH6", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH6", {0, 0x1F}},
-        {"OFFSET_CH5", {0, 0x3FF}},
-        {"DIGITAL_GAIN_CH5", {0, 0x1F}},
-        {"DIGITAL_HPF_FILTER_ENABLE_CH5-8", {0, 1}},
-        {"DIGITAL_HPF_FILTER_K_CH5-8", {2, 10}},
-        {"DITHER", {0, 1}},
-        {"PGA_CLAMP_-6dB", {0, 1}},
-        {"LPF_PROGRAMMABILITY", {0, 2, 3, 4}},
-        {"PGA_INTEGRATOR_DISABLE", {0, 1}},
-        {"PGA_CLAMP_LEVEL", {0, 7}},
-        {"PGA_GAIN_CONTROL", {0, 1}},
-        {"ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_CNTL", {0, 0x1F}},
-        {"ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_ENABLE", {0, 1}},
-        {"PRESET_ACTIVE_TERMINATIONS", {0, 3}},
-        {"ACTIVE_TERMINATION_ENABLE", {0, 1}},
-        {"LNA_INPUT_CLAMP_SETTING", {0, 3}},
-        {"LNA_INTEGRATOR_DISABLE", {0, 1}},
-        {"LNA_GAIN", {0, 3}},
-        {"LNA_INDIVIDUAL_CH_CNTL", {0, 1}},
-        {"PDN_CH", {0, 0xFF}},
-        {"LOW_POWER", {0, 1}},
-        {"MED_POWER", {0, 1}},
-        {"PDN_VCAT_PGA", {0, 1}},
-        {"PDN_LNA", {0, 1}},
-        {"VCA_PARTIAL_PDN", {0, 1}},
-        {"VCA_COMPLETE_PDN", {0, 1}},
-        {"CW_SUM_AMP_GAIN_CNTL", {0, 1, 2, 4, 8, 16}},
-        {"CW_16X_CLK_SEL", {0, 1}},
-        {"CW_1X_CLK_SEL", {0, 1}},
-        {"CW_TGC_SEL", {0, 1}}, 
-        {"CW_SUM_AMP_ENABLE", {0, 1}},
-        {"CW_CLK_MODE_SEL", {0, 3}},
-        {"CH1_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH2_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH3_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH4_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH5_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH6_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH7_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH8_CW_MIXER_PHASE", {0, 0xF}},
-        {"CH1_LNA_GAIN_CNTL", {0, 3}},
-        {"CH2_LNA_GAIN_CNTL", {0, 3}},
-        {"CH3_LNA_GAIN_CNTL", {0, 3}},
-        {"CH4_LNA_GAIN_CNTL", {0, 3}},
-        {"CH5_LNA_GAIN_CNTL", {0, 3}},
-        {"CH6_LNA_GAIN_CNTL", {0, 3}},
-        {"CH7_LNA_GAIN_CNTL", {0, 3}},
-        {"CH8_LNA_GAIN_CNTL", {0, 3}},
-        {"HPF_LNA", {0, 3}},
-        {"DIG_TGC_ATT_GAIN", {0, 0x7}},
-        {"DIG_TGC_ATT", {0, 1}},
-        {"CW_SUM_AMP_PDN", {0, 1}},
-        {"PGA_TEST_MODE", {0, 1}}
+    struct AfeFunctionInfo {
+        AfeFunction id;
+        const char* name;
+        uint8_t registerAddr;
+        uint8_t msb;
+        uint8_t lsb;
+        uint16_t mask;          // field mask within the register
+        uint16_t minValue;      // accepted range when optionBits == 0
+        uint16_t maxValue;
+        uint32_t optionBits;    // bit v set: value v accepted (discrete option lists)
     };
+
+    constexpr uint16_t afeFieldMask(uint8_t msb, uint8_t lsb) {
+        return static_cast<uint16_t>(((1u << (msb - lsb + 1)) - 1) << lsb);
+    }
+
+    constexpr AfeFunctionInfo afeRange(AfeFunction id, const char* name, uint8_t reg, uint8_t msb, uint8_t lsb, uint16_t minValue, uint16_t maxValue) {
+        return {id, name, reg, msb, lsb, afeFieldMask(msb, lsb), minValue, maxValue, 0};
+    }
+
+    constexpr AfeFunctionInfo afeOptions(AfeFunction id, const char* name, uint8_t reg, uint8_t msb, uint8_t lsb, uint32_t optionBits) {
+        return {id, name, reg, msb, lsb, afeFieldMask(msb, lsb), 0, 0, optionBits};
+    }
+
+    // {FUNCTION, NAME, REGISTER_ADDR, BITH, BITL, options}
+    constexpr std::array<AfeFunctionInfo, 92> afeFunctionTable = {{
+        afeRange(AfeFunction::SOFTWARE_RESET, "SOFTWARE_RESET", 0, 0, 0, 0, 1),
+        afeRange(AfeFunction::REGISTER_READOUT_ENABLE, "REGISTER_READOUT_ENABLE", 0, 1, 1, 0, 1),
+        afeRange(AfeFunction::ADC_COMPLETE_PDN, "ADC_COMPLETE_PDN", 1, 0, 0, 0, 1),
+        afeRange(AfeFunction::LVDS_OUTPUT_DISABLE, "LVDS_OUTPUT_DISABLE", 1, 1, 1, 0, 1),
+        afeRange(AfeFunction::ADC_PDN_CH, "ADC_PDN_CH", 1, 9, 2, 0, 0xFF),
+        afeRange(AfeFunction::PARTIAL_PDN, "PARTIAL_PDN", 1, 10, 10, 0, 1),
+        afeRange(AfeFunction::LOW_FREQUENCY_NOISE_SUPPRESSION, "LOW_FREQUENCY_NOISE_SUPPRESSION", 1, 11, 11, 0, 1),
+        afeRange(AfeFunction::EXT_REF, "EXT_REF", 1, 13, 13, 0, 1),
+        afeRange(AfeFunction::LVDS_OUTPUT_RATE_2X, "LVDS_OUTPUT_RATE_2X", 1, 14, 14, 0, 1),
+        afeRange(AfeFunction::SINGLE_ENDED_CLK_MODE, "SINGLE-ENDED_CLK_MODE", 1, 15, 15, 0, 1),
+        afeRange(AfeFunction::POWER_DOWN_LVDS, "POWER-DOWN_LVDS", 2, 10, 3, 0, 1),
+        afeRange(AfeFunction::AVERAGING_ENABLE, "AVERAGING_ENABLE", 2, 11, 11, 0, 1),
+        afeRange(AfeFunction::LOW_LATENCY, "LOW_LATENCY", 2, 12, 12, 0, 1),
+        afeRange(AfeFunction::TEST_PATTERN_MODES, "TEST_PATTERN_MODES", 2, 15, 13, 0, 7),
+        afeRange(AfeFunction::INVERT_CHANNELS, "INVERT_CHANNELS", 3, 7, 0, 0, 0xFF),
+        afeRange(AfeFunction::CHANNEL_OFFSET_SUBSTRACTION_ENABLE, "CHANNEL_OFFSET_SUBSTRACTION_ENABLE", 3, 8, 8, 0, 1),
+        afeRange(AfeFunction::DIGITAL_GAIN_ENABLE, "DIGITAL_GAIN_ENABLE", 3, 12, 12, 0, 1),
+        afeRange(AfeFunction::SERIALIZED_DATA_RATE, "SERIALIZED_DATA_RATE", 3, 14, 13, 0, 3),
+        afeRange(AfeFunction::ENABLE_EXTERNAL_REFERENCE_MODE, "ENABLE_EXTERNAL_REFERENCE_MODE", 3, 15, 15, 0, 1),
+        afeRange(AfeFunction::ADC_RESOLUTION_RESET, "ADC_RESOLUTION_RESET", 4, 1, 1, 0, 1),
+        afeRange(AfeFunction::ADC_OUTPUT_FORMAT, "ADC_OUTPUT_FORMAT", 4, 3, 3, 0, 1),
+        afeRange(AfeFunction::LSB_MSB_FIRST, "LSB_MSB_FIRST", 4, 4, 4, 0, 1),
+        afeRange(AfeFunction::CUSTOM_PATTERN, "CUSTOM_PATTERN", 5, 13, 0, 0, 0x3FFF),
+        afeRange(AfeFunction::SYNC_PATTERN, "SYNC_PATTERN", 10, 8, 8, 0, 1),
+        afeRange(AfeFunction::OFFSET_CH1, "OFFSET_CH1", 13, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH1, "DIGITAL_GAIN_CH1", 13, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::OFFSET_CH2, "OFFSET_CH2", 15, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH2, "DIGITAL_GAIN_CH2", 15, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::OFFSET_CH3, "OFFSET_CH3", 17, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH3, "DIGITAL_GAIN_CH3", 17, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::OFFSET_CH4, "OFFSET_CH4", 19, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH4, "DIGITAL_GAIN_CH4", 19, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::DIGITAL_HPF_FILTER_ENABLE_CH1_4, "DIGITAL_HPF_FILTER_ENABLE_CH1-4", 21, 0, 0, 0, 1),
+        afeRange(AfeFunction::DIGITAL_HPF_FILTER_K_CH1_4, "DIGITAL_HPF_FILTER_K_CH1-4", 21, 4, 1, 2, 10),
+        afeRange(AfeFunction::OFFSET_CH8, "OFFSET_CH8", 25, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH8, "DIGITAL_GAIN_CH8", 25, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::OFFSET_CH7, "OFFSET_CH7", 27, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH7, "DIGITAL_GAIN_CH7", 27, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::OFFSET_CH6, "OFFSET_CH6", 29, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH6, "DIGITAL_GAIN_CH6", 29, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::OFFSET_CH5, "OFFSET_CH5", 31, 9, 0, 0, 0x3FF),
+        afeRange(AfeFunction::DIGITAL_GAIN_CH5, "DIGITAL_GAIN_CH5", 31, 15, 11, 0, 0x1F),
+        afeRange(AfeFunction::DIGITAL_HPF_FILTER_ENABLE_CH5_8, "DIGITAL_HPF_FILTER_ENABLE_CH5-8", 33, 0, 0, 0, 1),
+        afeRange(AfeFunction::DIGITAL_HPF_FILTER_K_CH5_8, "DIGITAL_HPF_FILTER_K_CH5-8", 33, 4, 1, 2, 10),
+        afeRange(AfeFunction::DITHER, "DITHER", 66, 15, 15, 0, 1),
+        afeRange(AfeFunction::PGA_CLAMP_MINUS_6DB, "PGA_CLAMP_-6dB", 50, 10, 10, 0, 1),
+        afeOptions(AfeFunction::LPF_PROGRAMMABILITY, "LPF_PROGRAMMABILITY", 51, 3, 1, 0x1D),  // {0, 2, 3, 4}
+        afeRange(AfeFunction::PGA_INTEGRATOR_DISABLE, "PGA_INTEGRATOR_DISABLE", 51, 4, 4, 0, 1),
+        afeRange(AfeFunction::PGA_CLAMP_LEVEL, "PGA_CLAMP_LEVEL", 51, 7, 5, 0, 7),
+        afeRange(AfeFunction::PGA_GAIN_CONTROL, "PGA_GAIN_CONTROL", 51, 13, 13, 0, 1),
+        afeRange(AfeFunction::ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_CNTL, "ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_CNTL", 52, 4, 0, 0, 0x1F),
+        afeRange(AfeFunction::ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_ENABLE, "ACTIVE_TERMINATION_INDIVIDUAL_RESISTOR_ENABLE", 52, 5, 5, 0, 1),
+        afeRange(AfeFunction::PRESET_ACTIVE_TERMINATIONS, "PRESET_ACTIVE_TERMINATIONS", 52, 7, 6, 0, 3),
+        afeRange(AfeFunction::ACTIVE_TERMINATION_ENABLE, "ACTIVE_TERMINATION_ENABLE", 52, 8, 8, 0, 1),
+        afeRange(AfeFunction::LNA_INPUT_CLAMP_SETTING, "LNA_INPUT_CLAMP_SETTING", 52, 10, 9, 0, 3),
+        afeRange(AfeFunction::LNA_INTEGRATOR_DISABLE, "LNA_INTEGRATOR_DISABLE", 52, 12, 12, 0, 1),
+        afeRange(AfeFunction::LNA_GAIN, "LNA_GAIN", 52, 14, 13, 0, 3),
+        afeRange(AfeFunction::LNA_INDIVIDUAL_CH_CNTL, "LNA_INDIVIDUAL_CH_CNTL", 52, 15, 15, 0, 1),
+        afeRange(AfeFunction::PDN_CH, "PDN_CH", 53, 7, 0, 0, 0xFF),
+        afeRange(AfeFunction::LOW_POWER, "LOW_POWER", 53, 10, 10, 0, 1),
+        afeRange(AfeFunction::MED_POWER, "MED_POWER", 53, 11, 11, 0, 1),
+        afeRange(AfeFunction::PDN_VCAT_PGA, "PDN_VCAT_PGA", 53, 12, 12, 0, 1),
+        afeRange(AfeFunction::PDN_LNA, "PDN_LNA", 53, 13, 13, 0, 1),
+        afeRange(AfeFunction::VCA_PARTIAL_PDN, "VCA_PARTIAL_PDN", 53, 14, 14, 0, 1),
+        afeRange(AfeFunction::VCA_COMPLETE_PDN, "VCA_COMPLETE_PDN", 53, 15, 15, 0, 1),
+        afeOptions(AfeFunction::CW_SUM_AMP_GAIN_CNTL, "CW_SUM_AMP_GAIN_CNTL", 54, 4, 0, 0x10117),  // {0, 1, 2, 4, 8, 16}
+        afeRange(AfeFunction::CW_16X_CLK_SEL, "CW_16X_CLK_SEL", 54, 5, 5, 0, 1),
+        afeRange(AfeFunction::CW_1X_CLK_SEL, "CW_1X_CLK_SEL", 54, 6, 6, 0, 1),
+        afeRange(AfeFunction::CW_TGC_SEL, "CW_TGC_SEL", 54, 8, 8, 0, 1),
+        afeRange(AfeFunction::CW_SUM_AMP_ENABLE, "CW_SUM_AMP_ENABLE", 54, 9, 9, 0, 1),
+        afeRange(AfeFunction::CW_CLK_MODE_SEL, "CW_CLK_MODE_SEL", 54, 11, 10, 0, 3),
+        afeRange(AfeFunction::CH1_CW_MIXER_PHASE, "CH1_CW_MIXER_PHASE", 55, 3, 0, 0, 0xF),
+        afeRange(AfeFunction::CH2_CW_MIXER_PHASE, "CH2_CW_MIXER_PHASE", 55, 7, 4, 0, 0xF),
+        afeRange(AfeFunction::CH3_CW_MIXER_PHASE, "CH3_CW_MIXER_PHASE", 55, 11, 8, 0, 0xF),
+        afeRange(AfeFunction::CH4_CW_MIXER_PHASE, "CH4_CW_MIXER_PHASE", 55, 15, 12, 0, 0xF),
+        afeRange(AfeFunction::CH5_CW_MIXER_PHASE, "CH5_CW_MIXER_PHASE", 56, 3, 0, 0, 0xF),
+        afeRange(AfeFunction::CH6_CW_MIXER_PHASE, "CH6_CW_MIXER_PHASE", 56, 7, 4, 0, 0xF),
+        afeRange(AfeFunction::CH7_CW_MIXER_PHASE, "CH7_CW_MIXER_PHASE", 56, 11, 8, 0, 0xF),
+        afeRange(AfeFunction::CH8_CW_MIXER_PHASE, "CH8_CW_MIXER_PHASE", 56, 15, 12, 0, 0xF),
+        afeRange(AfeFunction::CH1_LNA_GAIN_CNTL, "CH1_LNA_GAIN_CNTL", 57, 1, 0, 0, 3),
+        afeRange(AfeFunction::CH2_LNA_GAIN_CNTL, "CH2_LNA_GAIN_CNTL", 57, 3, 2, 0, 3),
+        afeRange(AfeFunction::CH3_LNA_GAIN_CNTL, "CH3_LNA_GAIN_CNTL", 57, 5, 4, 0, 3),
+        afeRange(AfeFunction::CH4_LNA_GAIN_CNTL, "CH4_LNA_GAIN_CNTL", 57, 7, 6, 0, 3),
+        afeRange(AfeFunction::CH5_LNA_GAIN_CNTL, "CH5_LNA_GAIN_CNTL", 57, 9, 8, 0, 3),
+        afeRange(AfeFunction::CH6_LNA_GAIN_CNTL, "CH6_LNA_GAIN_CNTL", 57, 11, 10, 0, 3),
+        afeRange(AfeFunction::CH7_LNA_GAIN_CNTL, "CH7_LNA_GAIN_CNTL", 57, 13, 12, 0, 3),
+        afeRange(AfeFunction::CH8_LNA_GAIN_CNTL, "CH8_LNA_GAIN_CNTL", 57, 15, 14, 0, 3),
+        afeRange(AfeFunction::HPF_LNA, "HPF_LNA", 59, 3, 2, 0, 3),
+        afeRange(AfeFunction::DIG_TGC_ATT_GAIN, "DIG_TGC_ATT_GAIN", 59, 6, 4, 0, 7),
+        afeRange(AfeFunction::DIG_TGC_ATT, "DIG_TGC_ATT", 59, 7, 7, 0, 1),
+        afeRange(AfeFunction::CW_SUM_AMP_PDN, "CW_SUM_AMP_PDN", 59, 8, 8, 0, 1),
+        afeRange(AfeFunction::PGA_TEST_MODE, "PGA_TEST_MODE", 59, 9, 9, 0, 1)
+    }};
+
+    constexpr bool afeFunctionTableInOrder() {
+        for (size_t i = 0; i < afeFunctionTable.size(); ++i) {
+            if (static_cast<size_t>(afeFunctionTable[i].id) != i) return false;
+            if (afeFunctionTable[i].msb < afeFunctionTable[i].lsb || afeFunctionTable[i].msb > 15) return false;
+        }
+        return true;
+    }
+    static_assert(afeFunctionTableInOrder(), "afeFunctionTable must follow the AfeFunction order");
+
+    constexpr const AfeFunctionInfo& afeFunctionInfo(AfeFunction id) {
+        return afeFunctionTable[static_cast<size_t>(id)];
+    }
+
+    // Name -> function, for the string-based client API.
+    inline std::optional<AfeFunction> findAfeFunction(const std::string& name) {
+        static const std::unordered_map<std::string, AfeFunction> byName = [] {
+            std::unordered_map<std::string, AfeFunction> map;
+            for (const auto& info : afeFunctionTable) map.emplace(info.name, info.id);
+            return map;
+        }();
+        auto it = byName.find(name);
+        if (it == byName.end()) return std::nullopt;
+        return it->second;
+    }
 }
 
 namespace I2C_drivers_defines{
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <mutex>
+
+#include "Daphne.hpp"
+#include "MonitoringHistory.hpp"
+
+namespace daphne_sc {
+
+// Held by client requests that drive the frontend trigger / spy buffers.
+// The counter is raised before locking so background snapshot loops can abort
+// between waveforms instead of making the client wait for a full cycle. It is
+// a count, not a flag: a guard that finishes while another one is still
+// waiting for the mutex must not let the background loops back in.
+struct ClientAcquisitionGuard {
+  Daphne& d;
+  std::unique_lock<std::mutex> lock;
+
+  explicit ClientAcquisitionGuard(Daphne& daphne) : d(daphne), lock(daphne.acquisition_mutex, std::defer_lock) {
+    d.activeClientAcquisitions.fetch_add(1);
+    lock.lock();
+  }
+
+  ~ClientAcquisitionGuard() {
+    lock.unlock();
+    d.last_client_acquisition_ns.store(MonitoringHistory::nowNs());
+    d.activeClientAcquisitions.fetch_sub(1);
+  }
+};
+
+}  // namespace daphne_sc
@@ -0,0 +1,314 @@
+#include "server_controller/board_state.hpp"
+
+#include <array>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Daphne.hpp"
+#include "I2CBusExecutor.hpp"
+#include "MonitoringHistory.hpp"
+#include "TriggerBlock.hpp"
+#include "defines.hpp"
+#include "server_controller/acquisition_guard.hpp"
+
+namespace daphne_sc {
+
+namespace {
+
+constexpr uint32_t kAfes = BoardStateSnapshot::kAfes;
+constexpr uint32_t kExpectedFclkWord = 0x00FF00FFu;
+constexpr uint32_t kVerificationReads = 4;
+
+std::mutex default_path_mutex;
+std::string default_path = "/var/tmp/daphne_board_state.bin";
+
+// Runs one restore step; an exception marks it failed without stopping the rest.
+template <typename Step>
+void run_step(BoardStateRestoreReport& report, const char* name, Step step) {
+  std::string detail;
+  bool ok = false;
+  try {
+    ok = step(detail);
+  } catch (const std::exception& e) {
+    detail = std::string("error: ") + e.what();
+  }
+  report.ok = report.ok && ok;
+  report.text += std::string(name) + ": " + (ok ? "ok" : "FAILED") + (detail.empty() ? "" : " (" + detail + ")") + "\n";
+}
+
+}  // namespace
+
+BoardStateSnapshot capture_board_state(Daphne& daphne) {
+  BoardStateSnapshot snapshot;
+  snapshot.timestamp_ns = MonitoringHistory::nowNs();
+
+  for (uint32_t afe = 0; afe < kAfes; ++afe) {
+    snapshot.afeAttenuation[afe] = daphne.findAfeAttenuationDictValue(afe);
+    snapshot.biasVoltage[afe] = daphne.findBiasVoltageDictValue(afe);
+    for (const auto& info : afe_definitions::afeFunctionTable) {
+      const std::optional<uint32_t> value = daphne.findAfeFunctionDictValue(afe, info.id);
+      if (value) {
+        snapshot.afeFunctions.push_back(
+            {static_cast<uint8_t>(afe), static_cast<uint8_t>(info.id), static_cast<uint16_t>(*value)});
+      }
+    }
+    snapshot.afeRegisters[afe] = daphne.getAfe()->getShadowImage(afe);
+    snapshot.delay[afe] = daphne.getFrontEnd()->getDelay(static_cast<uint8_t>(afe));
+    snapshot.bitslip[afe] = daphne.getFrontEnd()->getBitslip(static_cast<uint8_t>(afe));
+  }
+  for (uint32_t ch = 0; ch < BoardStateSnapshot::kChannels; ++ch) {
+    snapshot.channelTrim[ch] = daphne.findChTrimDictValue(ch);
+    snapshot.channelOffset[ch] = daphne.findChOffsetDictValue(ch);
+  }
+  snapshot.biasControl = daphne.findBiasControlDictValue();
+  snapshot.afePowerState = daphne.getAfe()->getPowerState();
+
+  TriggerBlock* trigger = daphne.getTriggerBlock();
+  snapshot.triggerThreshold = trigger->getThresholds();
+  const uint64_t enable_mask = trigger->getEnableMask();
+  snapshot.triggerMaskLow = static_cast<uint32_t>(enable_mask);
+  snapshot.triggerMaskHigh = static_cast<uint32_t>(enable_mask >> 32);
+  BoardStateSnapshot::TriggerConfig trigger_config;
+  trigger_config.fullConfig = trigger->getFullConfig();
+  trigger_config.matchingTemplates = trigger->getMatchingTemplates();
+  snapshot.triggerConfig = trigger_config;
+
+  if (auto* hdmezz = daphne.getHDMezzDriver()) {
+    std::array<BoardStateSnapshot::HdMezzBlock, kAfes> blocks{};
+    daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser, [&] {
+      for (uint8_t block = 0; block < kAfes; ++block) {
+        auto& b = blocks[block];
+        b.enabled = hdmezz->isAfeBlockEnabled(block);
+        b.rShunt5V = hdmezz->getRShunt(block, "5V");
+        b.rShunt3V3 = hdmezz->getRShunt(block, "3V3");
+        b.maxCurrentScale5V = hdmezz->getMaxCurrentScale(block, "5V");
+        b.maxCurrentScale3V3 = hdmezz->getMaxCurrentScale(block, "3V3");
+        b.maxCurrentShutdown5V = hdmezz->getMaxCurrentShutdown(block, "5V");
+        b.maxCurrentShutdown3V3 = hdmezz->getMaxCurrentShutdown(block, "3V3");
+        if (b.enabled) {
+          b.power5V = hdmezz->isPowerOn(block, "5V");
+          b.power3V3 = hdmezz->isPowerOn(block, "3V3");
+        }
+      }
+    });
+    snapshot.hdMezz = blocks;
+  }
+  return snapshot;
+}
+
+BoardStateRestoreReport restore_board_state(const BoardStateSnapshot& snapshot, Daphne& daphne) {
+  BoardStateRestoreReport report;
+  const auto t0 = std::chrono::steady_clock::now();
+  ClientAcquisitionGuard acquisition(daphne);
+
+  run_step(report, "hdmezz", [&](std::string& detail) {
+    if (!snapshot.hdMezz) {
+      detail = "not in snapshot";
+      return true;
+    }
+    auto* hdmezz = daphne.getHDMezzDriver();
+    if (!hdmezz) throw std::runtime_error("HD mezzanine driver not initialized");
+    // One transaction per block, so monitor safety checks can run in between.
+    uint32_t restored = 0;
+    uint32_t disabled = 0;
+    for (uint8_t block = 0; block < kAfes; ++block) {
+      const auto& b = (*snapshot.hdMezz)[block];
+      if (!b.enabled) {
+        daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser, [&] { hdmezz->enableAfeBlock(block, false); });
+        ++disabled;
+        continue;
+      }
+      daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser, [&] {
+        hdmezz->enableAfeBlock(block, true);
+        hdmezz->setRShunt(block, b.rShunt5V, "5V");
+        hdmezz->setRShunt(block, b.rShunt3V3, "3V3");
+        hdmezz->setMaxCurrentScale(block, b.maxCurrentScale5V, "5V");
+        hdmezz->setMaxCurrentScale(block, b.maxCurrentScale3V3, "3V3");
+        hdmezz->setMaxCurrentShutdown(block, b.maxCurrentShutdown5V, "5V");
+        hdmezz->setMaxCurrentShutdown(block, b.maxCurrentShutdown3V3, "3V3");
+        hdmezz->configureHdMezzAfeBlock(block);
+        hdmezz->powerOn_HDMezzAfeBlock(block, b.power5V, "5V");
+        hdmezz->powerOn_HDMezzAfeBlock(block, b.power3V3, "3V3");
+      });
+      ++restored;
+    }
+    detail = std::to_string(restored) + " block(s) enabled, " + std::to_string(disabled) + " disabled";
+    return true;
+  });
+
+  run_step(report, "afe_registers", [&](std::string& detail) {
+    if (daphne.getAfe()->getPowerState() != snapshot.afePowerState) {
+      daphne.getAfe()->setPowerState(snapshot.afePowerState);
+      daphne.clearAfeFunctionDictValues();
+    }
+    // One job per AFE; the three SPI busy groups are written concurrently.
+    std::array<std::future<std::vector<Afe::RegisterMismatch>>, kAfes> pending;
+    for (uint32_t afe = 0; afe < kAfes; ++afe) {
+      const auto& image = snapshot.afeRegisters[afe];
+      report.afe_registers += static_cast<uint32_t>(image.size());
+      pending[afe] = daphne.getSpiScheduler()->submit<std::vector<Afe::RegisterMismatch>>(
+          afe, [afe, &image](Afe& a) { return a.writeImage(afe, image); });
+    }
+    std::array<bool, kAfes> afe_ok{};
+    std::exception_ptr error;
+    for (uint32_t afe = 0; afe < kAfes; ++afe) {
+      try {
+        const auto mismatches = pending[afe].get();
+        report.afe_register_mismatches += static_cast<uint32_t>(mismatches.size());
+        afe_ok[afe] = mismatches.empty();
+      } catch (...) {
+        if (!error) error = std::current_exception();
+      }
+    }
+    // Function values only for AFEs whose registers read back as saved, so a
+    // delta configure reprograms the others.
+    for (const auto& function : snapshot.afeFunctions) {
+      if (function.afe >= kAfes || function.function >= afe_definitions::afeFunctionTable.size()) continue;
+      if (!afe_ok[function.afe]) continue;
+      daphne.setAfeFunctionDictValue(function.afe, afe_definitions::afeFunctionTable[function.function].id,
+                                     function.value);
+    }
+    if (error) std::rethrow_exception(error);
+    detail = std::to_string(report.afe_registers) + " written, " + std::to_string(report.afe_register_mismatches) +
+             " mismatched";
+    return report.afe_register_mismatches == 0;
+  });
+
+  run_step(report, "dac", [&](std::string& detail) {
+    uint32_t words = 0;
+    for (uint32_t afe_board = 0; afe_board < kAfes; ++afe_board) {
+      const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+      std::array<uint32_t, 8> trims{};
+      std::array<uint32_t, 8> offsets{};
+      uint8_t trim_mask = 0;
+      uint8_t offset_mask = 0;
+      for (uint32_t idx = 0; idx < 8; ++idx) {
+        const uint32_t ch = afe_board * 8 + idx;
+        if (snapshot.channelTrim[ch]) {
+          trims[idx] = *snapshot.channelTrim[ch];
+          trim_mask |= 1u << idx;
+        }
+        if (snapshot.channelOffset[ch]) {
+          offsets[idx] = *snapshot.channelOffset[ch];
+          offset_mask |= 1u << idx;
+        }
+      }
+      if (trim_mask != 0) daphne.getDac()->setTrims(afe_pl, trims, false, false, trim_mask);
+      if (offset_mask != 0) daphne.getDac()->setOffsets(afe_pl, offsets, false, false, offset_mask);
+      for (uint32_t idx = 0; idx < 8; ++idx) {
+        const uint32_t ch = afe_board * 8 + idx;
+        if (trim_mask & (1u << idx)) daphne.setChTrimDictValue(ch, trims[idx]);
+        if (offset_mask & (1u << idx)) daphne.setChOffsetDictValue(ch, offsets[idx]);
+      }
+      words += static_cast<uint32_t>(__builtin_popcount(trim_mask) + __builtin_popcount(offset_mask));
+    }
+    for (uint32_t afe = 0; afe < kAfes; ++afe) {
+      if (snapshot.afeAttenuation[afe]) {
+        daphne.getDac()->setDacGain(afe, *snapshot.afeAttenuation[afe]);
+        daphne.setAfeAttenuationDictValue(afe, *snapshot.afeAttenuation[afe]);
+        ++words;
+      }
+      if (snapshot.biasVoltage[afe]) {
+        daphne.getDac()->setDacBias(afe, *snapshot.biasVoltage[afe]);
+        daphne.setBiasVoltageDictValue(afe, *snapshot.biasVoltage[afe]);
+        ++words;
+      }
+    }
+    if (snapshot.biasControl) {
+      daphne.getDac()->setDacHvBias(*snapshot.biasControl, false, false);
+      daphne.getDac()->setBiasEnable(true);
+      daphne.setBiasControlDictValue(*snapshot.biasControl);
+      ++words;
+    }
+    detail = std::to_string(words) + " value(s)";
+    return true;
+  });
+
+  run_step(report, "trigger", [&](std::string& detail) {
+    TriggerBlock* trigger = daphne.getTriggerBlock();
+    std::vector<std::pair<uint32_t, uint32_t>> thresholds;
+    for (uint32_t ch = 0; ch < BoardStateSnapshot::kChannels; ++ch) {
+      thresholds.emplace_back(ch, snapshot.triggerThreshold[ch]);
+    }
+    size_t mismatches = trigger->setThresholds(thresholds).size();
+    const uint64_t enable_mask = (static_cast<uint64_t>(snapshot.triggerMaskHigh) << 32) | snapshot.triggerMaskLow;
+    if (!trigger->setEnableMask(enable_mask)) ++mismatches;
+    if (snapshot.triggerConfig) {
+      if (!trigger->setFullConfig(snapshot.triggerConfig->fullConfig)) ++mismatches;
+      std::vector<std::pair<uint32_t, uint32_t>> templates;
+      for (uint32_t i = 0; i < TriggerBlock::kMatchingTemplates; ++i) {
+        templates.emplace_back(i, snapshot.triggerConfig->matchingTemplates[i]);
+      }
+      mismatches += trigger->setMatchingTemplates(templates).size();
+    }
+    detail = std::to_string(mismatches) + " read-back mismatch(es)";
+    return mismatches == 0;
+  });
+
+  run_step(report, "frontend", [&](std::string& detail) {
+    FrontEnd* frontend = daphne.getFrontEnd();
+    bool unchanged = true;
+    for (uint32_t afe = 0; afe < kAfes; ++afe) {
+      unchanged = unchanged && frontend->getDelay(static_cast<uint8_t>(afe)) == snapshot.delay[afe] &&
+                  frontend->getBitslip(static_cast<uint8_t>(afe)) == snapshot.bitslip[afe];
+    }
+    // A process restart leaves the taps in place; reload them only when they differ.
+    if (!unchanged) {
+      frontend->resetDelayCtrlValues();
+      frontend->doResetDelayCtrl();
+      frontend->doResetSerDesCtrl();
+      frontend->setEnableDelayVtc(0);
+      if (!frontend->waitForDelayCtrlReady()) {
+        throw std::runtime_error("DELAYCTRL_READY did not assert after reset");
+      }
+      for (uint32_t afe = 0; afe < kAfes; ++afe) {
+        frontend->setDelay(static_cast<uint8_t>(afe), snapshot.delay[afe]);
+        frontend->setBitslip(static_cast<uint8_t>(afe), snapshot.bitslip[afe]);
+      }
+      frontend->setEnableDelayVtc(1);
+      report.frontend_rewritten = true;
+    }
+    std::array<bool, kAfes> aligned;
+    aligned.fill(true);
+    for (uint32_t i = 0; i < kVerificationReads; ++i) {
+      const std::array<uint32_t, kAfes> words = daphne.readFrameClocks();
+      for (uint32_t afe = 0; afe < kAfes; ++afe) {
+        aligned[afe] = aligned[afe] && words[afe] == kExpectedFclkWord;
+      }
+    }
+    std::ostringstream os;
+    os << (report.frontend_rewritten ? "reloaded" : "unchanged") << ", misaligned AFE(s):";
+    bool all_aligned = true;
+    for (uint32_t afe = 0; afe < kAfes; ++afe) {
+      if (!aligned[afe]) {
+        os << " " << afe_definitions::AFE_PL2board_map.at(afe);
+        all_aligned = false;
+      }
+    }
+    detail = all_aligned ? (report.frontend_rewritten ? "reloaded, verified" : "unchanged, verified") : os.str();
+    return all_aligned;
+  });
+
+  report.elapsed_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count());
+  return report;
+}
+
+void set_default_board_state_path(const std::string& path) {
+  std::lock_guard<std::mutex> lock(default_path_mutex);
+  default_path = path;
+}
+
+std::string default_board_state_path() {
+  std::lock_guard<std::mutex> lock(default_path_mutex);
+  return default_path;
+}
+
+}  // namespace daphne_sc
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "BoardState.hpp"
+
+class Daphne;
+
+namespace daphne_sc {
+
+// Reads the programmed state (Daphne values, AFE register shadows, frontend
+// delays/bitslips, trigger thresholds/masks, HD mezzanine calibration) into a
+// snapshot. Only the AFE shadow is captured, so registers never touched since
+// the last reset are not part of it.
+BoardStateSnapshot capture_board_state(Daphne& daphne);
+
+struct BoardStateRestoreReport {
+  bool ok = true;                    // every step applied and read back as saved
+  uint32_t afe_registers = 0;
+  uint32_t afe_register_mismatches = 0;
+  bool frontend_rewritten = false;   // delays/bitslips differed and were reloaded
+  uint64_t elapsed_us = 0;
+  std::string text;                  // one line per step
+};
+
+// Applies a snapshot: HD mezzanines, AFE power and register images (all SPI
+// groups concurrently), DACs, trigger thresholds, then the frontend alignment,
+// which is verified against the 0x00FF00FF frame-clock pattern. Steps that
+// fail are reported and the remaining steps still run.
+BoardStateRestoreReport restore_board_state(const BoardStateSnapshot& snapshot, Daphne& daphne);
+
+// File used by MT2_SAVE_STATE_REQ / MT2_RESTORE_STATE_REQ when the request has no path.
+void set_default_board_state_path(const std::string& path);
+std::string default_board_state_path();
+
+}  // namespace daphne_sc
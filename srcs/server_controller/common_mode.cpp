@@ -0,0 +1,308 @@
+#include "server_controller/common_mode.hpp"
+
+#include <arm_neon.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Daphne.hpp"
+#include "defines.hpp"
+#include "daphneV3_high_level_confs.pb.h"
+
+namespace daphne_sc {
+
+namespace {
+
+constexpr uint32_t kMaxSamples = 2048;
+constexpr uint32_t kChannelsPerAfe = 8;
+
+float sum_f32(const float* x, uint32_t n) {
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  uint32_t i = 0;
+  for (; i + 3 < n; i += 4) acc = vaddq_f32(acc, vld1q_f32(x + i));
+  float s = vaddvq_f32(acc);
+  for (; i < n; ++i) s += x[i];
+  return s;
+}
+
+float dot_f32(const float* a, const float* b, uint32_t n) {
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  uint32_t i = 0;
+  for (; i + 3 < n; i += 4) acc = vfmaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+  float s = vaddvq_f32(acc);
+  for (; i < n; ++i) s += a[i] * b[i];
+  return s;
+}
+
+// raw 14-bit counts -> float with the waveform mean removed; returns that mean.
+float to_ac_f32(const uint32_t* raw, float* out, uint32_t n) {
+  uint32_t i = 0;
+  for (; i + 3 < n; i += 4) vst1q_f32(out + i, vcvtq_f32_u32(vld1q_u32(raw + i)));
+  for (; i < n; ++i) out[i] = static_cast<float>(raw[i]);
+
+  const float mean = sum_f32(out, n) / static_cast<float>(n);
+  const float32x4_t m = vdupq_n_f32(mean);
+  i = 0;
+  for (; i + 3 < n; i += 4) vst1q_f32(out + i, vsubq_f32(vld1q_f32(out + i), m));
+  for (; i < n; ++i) out[i] -= mean;
+  return mean;
+}
+
+// Sum of squares of (ac - cm); optionally writes (ac - cm + pedestal) to dst.
+float subtract_cm_f32(const float* ac, const float* cm, float pedestal, float* dst, uint32_t n) {
+  float32x4_t acc = vdupq_n_f32(0.0f);
+  const float32x4_t p = vdupq_n_f32(pedestal);
+  uint32_t i = 0;
+  for (; i + 3 < n; i += 4) {
+    const float32x4_t y = vsubq_f32(vld1q_f32(ac + i), vld1q_f32(cm + i));
+    acc = vfmaq_f32(acc, y, y);
+    if (dst) vst1q_f32(dst + i, vaddq_f32(y, p));
+  }
+  float s = vaddvq_f32(acc);
+  for (; i < n; ++i) {
+    const float y = ac[i] - cm[i];
+    s += y * y;
+    if (dst) dst[i] = y + pedestal;
+  }
+  return s;
+}
+
+struct AfeGroup {
+  uint32_t afe = 0;             // board AFE index (channel / 8)
+  std::vector<uint32_t> rows;   // indices into the request channel list
+};
+
+}  // namespace
+
+std::string analyze_common_mode(const daphne::CommonModeNoiseRequest& request,
+                                Daphne& daphne,
+                                daphne::CommonModeNoiseResponse& response,
+                                size_t max_waveform_bytes) {
+  const uint32_t number_of_samples = request.numberofsamples();
+  const uint32_t number_of_waveforms = request.numberofwaveforms();
+  const bool software_trigger = request.softwaretrigger();
+  const bool use_median = request.estimator() == daphne::CM_MEDIAN;
+
+  if (number_of_samples == 0 || number_of_samples > kMaxSamples)
+    throw std::invalid_argument("numberOfSamples out of range (1..2048)");
+  if (number_of_waveforms == 0) throw std::invalid_argument("numberOfWaveforms must be > 0");
+
+  std::vector<uint32_t> channels(request.channellist().begin(), request.channellist().end());
+  if (channels.empty()) {
+    channels.resize(40);
+    for (uint32_t ch = 0; ch < 40; ++ch) channels[ch] = ch;
+  }
+  for (const auto ch : channels) {
+    if (ch > 39) throw std::invalid_argument("channel out of range (0..39)");
+  }
+  {
+    std::vector<uint32_t> sorted = channels;
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+      throw std::invalid_argument("channelList contains duplicates");
+  }
+
+  const uint32_t n_ch = static_cast<uint32_t>(channels.size());
+  const uint32_t n_s = number_of_samples;
+
+  std::vector<uint32_t> mapped_channels(n_ch);
+  std::vector<AfeGroup> groups;
+  std::vector<int> row_group(n_ch, -1);
+  for (uint32_t i = 0; i < n_ch; ++i) {
+    const uint32_t ch = channels[i];
+    const uint32_t afe = ch / kChannelsPerAfe;
+    mapped_channels[i] = afe_definitions::AFE_board2PL_map.at(afe) * kChannelsPerAfe + ch % kChannelsPerAfe;
+    auto it = std::find_if(groups.begin(), groups.end(), [&](const AfeGroup& g) { return g.afe == afe; });
+    if (it == groups.end()) {
+      groups.push_back(AfeGroup{afe, {}});
+      it = groups.end() - 1;
+    }
+    it->rows.push_back(i);
+  }
+  // A common mode needs at least two channels; single-channel AFEs are left as-is.
+  for (size_t g = 0; g < groups.size(); ++g) {
+    if (groups[g].rows.size() < 2) continue;
+    for (const auto row : groups[g].rows) row_group[row] = static_cast<int>(g);
+  }
+  const uint32_t n_groups = static_cast<uint32_t>(groups.size());
+
+  const bool want_cov = request.returncovariance();
+  const bool want_sub = request.returnsubtractedwaveforms();
+  const bool want_cm = request.returncommonmodewaveforms();
+
+  const size_t wf_values = (want_sub ? static_cast<size_t>(n_ch) : 0) + (want_cm ? static_cast<size_t>(n_groups) : 0);
+  const size_t out_bytes = wf_values * n_s * static_cast<size_t>(number_of_waveforms) * sizeof(float);
+  if (out_bytes > max_waveform_bytes)
+    throw std::invalid_argument("Requested waveforms exceed DAPHNE_MAX_SPYBUFFER_BYTES");
+
+  // Covariance pairs (upper triangle); the diagonal alone when the matrix is not requested.
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  for (uint32_t i = 0; i < n_ch; ++i) {
+    for (uint32_t j = i; j < n_ch; ++j) {
+      if (want_cov || i == j) pairs.emplace_back(i, j);
+    }
+  }
+  const uint32_t n_pairs = static_cast<uint32_t>(pairs.size());
+
+  std::vector<uint32_t> raw(static_cast<size_t>(n_ch) * n_s);
+  std::vector<float> ac(static_cast<size_t>(n_ch) * n_s);
+  std::vector<float> cm(static_cast<size_t>(n_groups) * n_s, 0.0f);
+  std::vector<float> wf_mean(n_ch);
+
+  std::vector<double> mean_acc(n_ch, 0.0);
+  std::vector<double> sub_acc(n_ch, 0.0);
+  std::vector<double> cm_acc(n_groups, 0.0);
+  std::vector<double> pair_acc(n_pairs, 0.0);
+
+  float* sub_out = nullptr;
+  float* cm_out = nullptr;
+  if (want_sub) {
+    response.mutable_subtractedwaveforms()->Resize(static_cast<int>(static_cast<size_t>(n_ch) * n_s * number_of_waveforms), 0.0f);
+    sub_out = response.mutable_subtractedwaveforms()->mutable_data();
+  }
+  if (want_cm) {
+    response.mutable_commonmodewaveforms()->Resize(static_cast<int>(static_cast<size_t>(n_groups) * n_s * number_of_waveforms), 0.0f);
+    cm_out = response.mutable_commonmodewaveforms()->mutable_data();
+  }
+
+  auto* spy_buffer = daphne.getSpyBuffer();
+  auto* front_end = daphne.getFrontEnd();
+
+  for (uint32_t wf = 0; wf < number_of_waveforms; ++wf) {
+    if (software_trigger) front_end->doTrigger();
+
+    #pragma omp parallel for
+    for (uint32_t i = 0; i < n_ch; ++i) {
+      uint32_t* raw_row = raw.data() + static_cast<size_t>(i) * n_s;
+      spy_buffer->extractMappedDataBulkSIMD(raw_row, n_s, mapped_channels[i]);
+      wf_mean[i] = to_ac_f32(raw_row, ac.data() + static_cast<size_t>(i) * n_s, n_s);
+    }
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (uint32_t p = 0; p < n_pairs; ++p) {
+      const float* a = ac.data() + static_cast<size_t>(pairs[p].first) * n_s;
+      const float* b = ac.data() + static_cast<size_t>(pairs[p].second) * n_s;
+      pair_acc[p] += dot_f32(a, b, n_s);
+    }
+
+    if (use_median) {
+      #pragma omp parallel for
+      for (uint32_t t = 0; t < n_s; ++t) {
+        std::array<float, kChannelsPerAfe> v;
+        for (uint32_t g = 0; g < n_groups; ++g) {
+          const auto& rows = groups[g].rows;
+          const size_t m = rows.size();
+          if (m < 2) continue;
+          for (size_t k = 0; k < m; ++k) v[k] = ac[static_cast<size_t>(rows[k]) * n_s + t];
+          auto mid = v.begin() + m / 2;
+          std::nth_element(v.begin(), mid, v.begin() + m);
+          float med = *mid;
+          if ((m & 1) == 0) med = 0.5f * (med + *std::max_element(v.begin(), mid));
+          cm[static_cast<size_t>(g) * n_s + t] = med;
+        }
+      }
+    } else {
+      #pragma omp parallel for
+      for (uint32_t g = 0; g < n_groups; ++g) {
+        const auto& rows = groups[g].rows;
+        if (rows.size() < 2) continue;
+        float* c = cm.data() + static_cast<size_t>(g) * n_s;
+        const float32x4_t scale = vdupq_n_f32(1.0f / static_cast<float>(rows.size()));
+        uint32_t t = 0;
+        for (; t + 3 < n_s; t += 4) {
+          float32x4_t acc = vdupq_n_f32(0.0f);
+          for (const auto row : rows) acc = vaddq_f32(acc, vld1q_f32(ac.data() + static_cast<size_t>(row) * n_s + t));
+          vst1q_f32(c + t, vmulq_f32(acc, scale));
+        }
+        for (; t < n_s; ++t) {
+          float acc = 0.0f;
+          for (const auto row : rows) acc += ac[static_cast<size_t>(row) * n_s + t];
+          c[t] = acc / static_cast<float>(rows.size());
+        }
+      }
+    }
+
+    #pragma omp parallel for
+    for (uint32_t i = 0; i < n_ch; ++i) {
+      const float* a = ac.data() + static_cast<size_t>(i) * n_s;
+      float* dst = sub_out ? sub_out + (static_cast<size_t>(wf) * n_ch + i) * n_s : nullptr;
+      mean_acc[i] += wf_mean[i];
+      if (row_group[i] < 0) {
+        // No common mode to remove: report the raw AC figure.
+        sub_acc[i] += dot_f32(a, a, n_s);
+        if (dst) {
+          for (uint32_t t = 0; t < n_s; ++t) dst[t] = a[t] + wf_mean[i];
+        }
+        continue;
+      }
+      const float* c = cm.data() + static_cast<size_t>(row_group[i]) * n_s;
+      sub_acc[i] += subtract_cm_f32(a, c, wf_mean[i], dst, n_s);
+    }
+
+    for (uint32_t g = 0; g < n_groups; ++g) {
+      const float* c = cm.data() + static_cast<size_t>(g) * n_s;
+      cm_acc[g] += dot_f32(c, c, n_s);
+      if (cm_out) std::copy(c, c + n_s, cm_out + (static_cast<size_t>(wf) * n_groups + g) * n_s);
+    }
+  }
+
+  const double n_values = static_cast<double>(n_s) * number_of_waveforms;
+  std::vector<double> cov(static_cast<size_t>(n_ch) * n_ch, 0.0);
+  for (uint32_t p = 0; p < n_pairs; ++p) {
+    const auto [i, j] = pairs[p];
+    const double v = pair_acc[p] / n_values;
+    cov[static_cast<size_t>(i) * n_ch + j] = v;
+    cov[static_cast<size_t>(j) * n_ch + i] = v;
+  }
+
+  response.clear_channellist();
+  for (const auto ch : channels) response.add_channellist(ch);
+  response.set_numberofsamples(number_of_samples);
+  response.set_numberofwaveforms(number_of_waveforms);
+  response.set_estimator(request.estimator());
+
+  double raw_sum = 0.0;
+  double sub_sum = 0.0;
+  for (uint32_t i = 0; i < n_ch; ++i) {
+    auto* s = response.add_channels();
+    const double ac_rms = std::sqrt(cov[static_cast<size_t>(i) * n_ch + i]);
+    const double sub_rms = std::sqrt(sub_acc[i] / n_values);
+    s->set_channel(channels[i]);
+    s->set_mean_counts(mean_acc[i] / number_of_waveforms);
+    s->set_ac_rms_counts(ac_rms);
+    s->set_cm_sub_rms_counts(sub_rms);
+    raw_sum += ac_rms;
+    sub_sum += sub_rms;
+  }
+
+  std::ostringstream msg;
+  msg << std::fixed << std::setprecision(3);
+  msg << "Common-mode analysis (" << (use_median ? "median" : "mean") << ") over " << number_of_waveforms
+      << " waveforms x " << n_ch << " channels x " << n_s << " samples.";
+  for (uint32_t g = 0; g < n_groups; ++g) {
+    auto* a = response.add_afes();
+    a->set_afe(groups[g].afe);
+    a->set_channels_used(static_cast<uint32_t>(groups[g].rows.size()));
+    a->set_cm_rms_counts(std::sqrt(cm_acc[g] / n_values));
+    msg << " AFE " << groups[g].afe << ": cm_rms=" << a->cm_rms_counts();
+    if (groups[g].rows.size() < 2) msg << " (single channel, not subtracted)";
+    msg << ".";
+  }
+  msg << " Mean ac_rms " << raw_sum / n_ch << " -> " << sub_sum / n_ch << " counts.";
+
+  if (want_cov) {
+    response.mutable_covariance()->Reserve(static_cast<int>(cov.size()));
+    for (const auto v : cov) response.add_covariance(v);
+  }
+  return msg.str();
+}
+
+}  // namespace daphne_sc
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class Daphne;
+
+namespace daphne {
+class CommonModeNoiseRequest;
+class CommonModeNoiseResponse;
+}  // namespace daphne
+
+namespace daphne_sc {
+
+// Acquires the requested waveforms and fills the response with per-channel
+// pedestal and AC RMS before/after per-AFE common-mode subtraction, the channel
+// covariance matrix and, on request, the CM and CM-subtracted waveforms.
+// Returns a one-line summary. Throws std::invalid_argument on malformed
+// requests or when the returned waveforms would exceed max_waveform_bytes.
+std::string analyze_common_mode(const daphne::CommonModeNoiseRequest& request,
+                                Daphne& daphne,
+                                daphne::CommonModeNoiseResponse& response,
+                                size_t max_waveform_bytes);
+
+}  // namespace daphne_sc
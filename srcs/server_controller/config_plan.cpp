@@ -0,0 +1,190 @@
+#include "server_controller/config_plan.hpp"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "Afe.hpp"
+#include "TriggerBlock.hpp"
+#include "daphneV3_high_level_confs.pb.h"
+
+namespace daphne_sc {
+
+namespace {
+
+using afe_definitions::AfeFunction;
+
+constexpr uint32_t kMaxDacValue = 4095;
+
+// Programming order used by configure.
+std::vector<std::pair<AfeFunction, uint16_t>> requested_afe_functions(const daphne::AFEConfig& afe_config) {
+  return {
+      {AfeFunction::SERIALIZED_DATA_RATE, 1u},
+      {AfeFunction::ADC_RESOLUTION_RESET, afe_config.adc().resolution() ? 1u : 0u},
+      {AfeFunction::ADC_OUTPUT_FORMAT, afe_config.adc().output_format() ? 1u : 0u},
+      {AfeFunction::LSB_MSB_FIRST, afe_config.adc().sb_first() ? 1u : 0u},
+      {AfeFunction::LPF_PROGRAMMABILITY, static_cast<uint16_t>(afe_config.pga().lpf_cut_frequency())},
+      {AfeFunction::PGA_INTEGRATOR_DISABLE, afe_config.pga().integrator_disable() ? 1u : 0u},
+      {AfeFunction::PGA_CLAMP_LEVEL, 2u},
+      {AfeFunction::ACTIVE_TERMINATION_ENABLE, 0u},
+      {AfeFunction::LNA_INPUT_CLAMP_SETTING, static_cast<uint16_t>(afe_config.lna().clamp())},
+      {AfeFunction::LNA_GAIN, static_cast<uint16_t>(afe_config.lna().gain())},
+      {AfeFunction::LNA_INTEGRATOR_DISABLE, afe_config.lna().integrator_disable() ? 1u : 0u},
+  };
+}
+
+uint32_t clamp_threshold(uint64_t requested, std::ostringstream& warnings) {
+  if (requested > static_cast<uint64_t>(TriggerBlock::kThresholdMask)) {
+    warnings << "Requested threshold " << requested << " exceeds 28-bit THRESH_S_AXI range; clamping to 0x0FFFFFFF.\n";
+    return TriggerBlock::kThresholdMask;
+  }
+  return static_cast<uint32_t>(requested);
+}
+
+}  // namespace
+
+ConfigurePlan compile_configure_plan(const daphne::ConfigureRequest& request) {
+  ConfigurePlan plan;
+  std::ostringstream warnings;
+  plan.delta = request.delta_configure();
+
+  bool bias_requested = false;
+  for (const daphne::AFEConfig& afe_config : request.afes()) {
+    const uint32_t board = afe_config.id();
+    if (board > 4) throw std::invalid_argument("AFE out of range (0..4): " + std::to_string(board));
+
+    ConfigurePlan::Afe afe;
+    afe.board = board;
+    afe.pl = afe_definitions::AFE_board2PL_map.at(board);
+    afe.vgain = afe_config.attenuators();
+    if (afe.vgain > kMaxDacValue) throw std::invalid_argument("VGAIN out of range for AFE " + std::to_string(board));
+    afe.bias = afe_config.v_bias();
+    if (afe.bias > kMaxDacValue) throw std::invalid_argument("BIAS out of range for AFE " + std::to_string(board));
+    bias_requested = bias_requested || afe.bias > 0;
+
+    // Values above 16 bits would be truncated on the way to the chip.
+    if (afe_config.pga().lpf_cut_frequency() > 0xFFFF || afe_config.lna().clamp() > 0xFFFF ||
+        afe_config.lna().gain() > 0xFFFF) {
+      throw std::invalid_argument("AFE function value out of range for AFE " + std::to_string(board));
+    }
+    afe.functions = requested_afe_functions(afe_config);
+    for (const auto& function : afe.functions) {
+      Afe::validateFunctionValue(afe_definitions::afeFunctionInfo(function.first), function.second);
+    }
+    plan.afes.push_back(std::move(afe));
+  }
+
+  for (uint32_t board = 0; board < plan.dacs.size(); ++board) {
+    plan.dacs[board].pl = afe_definitions::AFE_board2PL_map.at(board);
+  }
+  for (const daphne::ChannelConfig& ch_config : request.channels()) {
+    const uint32_t ch = ch_config.id();
+    if (ch >= TriggerBlock::kNumChannels) throw std::invalid_argument("Channel out of range (0..39): " + std::to_string(ch));
+
+    // A channel listed twice keeps its last values, as it did when written in order.
+    ConfigurePlan::Dac& dac = plan.dacs[ch / 8];
+    dac.trims[ch % 8] = ch_config.trim();
+    dac.offsets[ch % 8] = ch_config.offset();
+    dac.channels |= 1u << (ch % 8);
+    plan.trigger_channels.push_back(ch);
+  }
+
+  std::sort(plan.trigger_channels.begin(), plan.trigger_channels.end());
+  plan.trigger_channels.erase(std::unique(plan.trigger_channels.begin(), plan.trigger_channels.end()),
+                              plan.trigger_channels.end());
+  for (const uint32_t ch : plan.trigger_channels) {
+    if (ch < 32) {
+      plan.trigger_mask_low |= 1u << ch;
+    } else {
+      plan.trigger_mask_high |= 1u << (ch - 32);
+    }
+  }
+
+  plan.threshold = clamp_threshold(request.self_trigger_threshold(), warnings);
+  std::map<uint32_t, uint32_t> thresholds;
+  for (const uint32_t ch : plan.trigger_channels) thresholds[ch] = plan.threshold;
+  for (const daphne::ChannelThreshold& ch_threshold : request.channel_thresholds()) {
+    const uint32_t ch = ch_threshold.channel();
+    if (ch >= TriggerBlock::kNumChannels) {
+      throw std::invalid_argument("Threshold channel out of range (0..39): " + std::to_string(ch));
+    }
+    thresholds[ch] = clamp_threshold(ch_threshold.threshold(), warnings);
+  }
+  plan.thresholds.assign(thresholds.begin(), thresholds.end());
+
+  if (request.biasctrl() <= kMaxDacValue) {
+    plan.biasctrl = request.biasctrl();
+  } else {
+    warnings << "Warning: Bias Control value " << request.biasctrl() << " out of range (0..4095). Skipping.\n";
+    if (bias_requested) {
+      plan.biasctrl = kMaxDacValue;
+      plan.biasctrl_default = true;
+    }
+  }
+
+  plan.warnings = warnings.str();
+  return plan;
+}
+
+uint64_t configure_request_hash(const std::string& payload) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const unsigned char c : payload) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+ConfigurePlanCache::ConfigurePlanCache(size_t capacity) : capacity_(std::max<size_t>(1, capacity)) {}
+
+std::shared_ptr<const ConfigurePlan> ConfigurePlanCache::find(const std::string& payload) {
+  const uint64_t hash = configure_request_hash(payload);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (Entry& entry : entries_) {
+    if (entry.hash == hash && entry.payload == payload) {
+      entry.last_used = ++tick_;
+      ++hits_;
+      return entry.plan;
+    }
+  }
+  ++misses_;
+  return nullptr;
+}
+
+std::shared_ptr<const ConfigurePlan> ConfigurePlanCache::insert(const std::string& payload, ConfigurePlan plan) {
+  Entry entry;
+  entry.hash = configure_request_hash(payload);
+  entry.payload = payload;
+  entry.plan = std::make_shared<const ConfigurePlan>(std::move(plan));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entry.last_used = ++tick_;
+  for (Entry& existing : entries_) {
+    if (existing.hash == entry.hash && existing.payload == payload) {
+      existing = std::move(entry);
+      return existing.plan;
+    }
+  }
+  if (entries_.size() >= capacity_) {
+    auto oldest = std::min_element(entries_.begin(), entries_.end(),
+                                   [](const Entry& a, const Entry& b) { return a.last_used < b.last_used; });
+    *oldest = std::move(entry);
+    return oldest->plan;
+  }
+  entries_.push_back(std::move(entry));
+  return entries_.back().plan;
+}
+
+uint64_t ConfigurePlanCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+uint64_t ConfigurePlanCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+}  // namespace daphne_sc
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace daphne {
+class ConfigureRequest;
+}  // namespace daphne
+
+namespace daphne_sc {
+
+// A ConfigureRequest reduced to the values configure programs. Compiling does
+// all range checks, board->PL mapping, AFE function lookups and trigger mask
+// computation up front, so a bad request fails before any hardware is touched
+// and replaying a plan needs no protobuf access at all.
+struct ConfigurePlan {
+  struct Afe {
+    uint32_t board = 0;
+    uint32_t pl = 0;
+    uint32_t vgain = 0;
+    uint32_t bias = 0;  // 0: not written
+    // Validated against afeFunctionTable, in programming order.
+    std::vector<std::pair<afe_definitions::AfeFunction, uint16_t>> functions;
+  };
+
+  // Trim/offset DAC values of one AFE (board numbering), indexed by channel % 8.
+  struct Dac {
+    uint32_t pl = 0;
+    std::array<uint32_t, 8> trims{};
+    std::array<uint32_t, 8> offsets{};
+    uint8_t channels = 0;  // bit i: channel i is in the request
+  };
+
+  bool delta = false;
+  std::vector<Afe> afes;
+  std::array<Dac, 5> dacs{};
+
+  // Bias control DAC. Defaulted to 4095 when the request has none in range but
+  // sets an AFE bias; a defaulted value is always written.
+  std::optional<uint32_t> biasctrl;
+  bool biasctrl_default = false;
+
+  // Self-trigger thresholds and enable masks (sorted, unique channels).
+  // thresholds holds {channel, value} for every requested channel and every
+  // channel_thresholds entry, sorted by channel.
+  std::vector<uint32_t> trigger_channels;
+  uint32_t threshold = 0;  // self_trigger_threshold, clamped
+  std::vector<std::pair<uint32_t, uint32_t>> thresholds;
+  uint32_t trigger_mask_low = 0;
+  uint32_t trigger_mask_high = 0;
+
+  // Notes from compiling (clamped threshold, skipped bias control), one per line.
+  std::string warnings;
+};
+
+// Throws std::invalid_argument for out-of-range channels, AFEs, VGAIN, bias or
+// AFE function values.
+ConfigurePlan compile_configure_plan(const daphne::ConfigureRequest& request);
+
+// FNV-1a over the serialized request.
+uint64_t configure_request_hash(const std::string& payload);
+
+// Compiled plans keyed by the hash of the serialized request they came from.
+// A hit is confirmed against the stored payload, so a hash collision only
+// costs a recompile. The least recently used plan is evicted when full.
+class ConfigurePlanCache {
+ public:
+  explicit ConfigurePlanCache(size_t capacity = 16);
+
+  std::shared_ptr<const ConfigurePlan> find(const std::string& payload);
+  std::shared_ptr<const ConfigurePlan> insert(const std::string& payload, ConfigurePlan plan);
+
+  uint64_t hits() const;
+  uint64_t misses() const;
+
+ private:
+  struct Entry {
+    uint64_t hash = 0;
+    std::string payload;
+    std::shared_ptr<const ConfigurePlan> plan;
+    uint64_t last_used = 0;
+  };
+
+  mutable std::mutex mutex_;
+  size_t capacity_;
+  std::vector<Entry> entries_;
+  uint64_t tick_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace daphne_sc
@@ -9,11 +9,15 @@
 #include <cstring>
 #include <exception>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -24,18 +28,36 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include "CompletionWaiter.hpp"
 #include "Daphne.hpp"
 #include "DevMem.hpp"
 #include "FpgaRegDict.hpp"
+#include "I2CBusExecutor.hpp"
 #include "defines.hpp"
 #include "daphneV3_low_level_confs.pb.h"
 #include "reg.hpp"
+#include "server_controller/acquisition_guard.hpp"
+#include "server_controller/board_state.hpp"
+#include "server_controller/common_mode.hpp"
+#include "server_controller/config_plan.hpp"
+#include "server_controller/pedestal_tuning.hpp"
+#include "server_controller/threshold_calibration.hpp"
 
 namespace daphne_sc {
 namespace {
 
 using daphne::AFEConfig;
 using daphne::ChannelConfig;
+using daphne::CommonModeNoiseRequest;
+using daphne::CommonModeNoiseResponse;
+using daphne::TunePedestalsRequest;
+using daphne::ReadFullFeStateRequest;
+using daphne::ReadMonitoringSnapshotRequest;
+using daphne::ReadMonitoringSnapshotResponse;
+using daphne::ReadMetricSeriesRequest;
+using daphne::ReadMetricSeriesResponse;
+using daphne::ReadFullFeStateResponse;
+using daphne::TunePedestalsResponse;
 using daphne::ConfigureCLKsRequest;
 using daphne::ConfigureCLKsResponse;
 using daphne::ConfigureRequest;
@@ -47,9 +69,30 @@ using daphne::DumpSpyBuffersRequest;
 using daphne::DumpSpyBuffersResponse;
 using daphne::GeneralInfo;
 using daphne::InfoRequest;
+using daphne::MinMaxAvg;
+using daphne::ReadBusWaitStatsRequest;
+using daphne::ReadBusWaitStatsResponse;
+using daphne::ReadFrameClockStatusRequest;
+using daphne::ReadFrameClockStatusResponse;
+using daphne::ReadPedestalHistoryRequest;
+using daphne::ReadPedestalHistoryResponse;
 using daphne::ReadTriggerCountersRequest;
 using daphne::ReadTriggerCountersResponse;
+using daphne::CalibrateThresholdsRequest;
+using daphne::CalibrateThresholdsResponse;
+using daphne::ReadTriggerRatesRequest;
+using daphne::ReadTriggerRatesResponse;
+using daphne::ReadTriggerHistoryRequest;
+using daphne::ReadTriggerHistoryResponse;
+using daphne::WriteTriggerConfigRequest;
+using daphne::WriteTriggerConfigResponse;
 using daphne::TestRegResponse;
+using daphne::VerifyAfeRequest;
+using daphne::VerifyAfeResponse;
+using daphne::SaveStateRequest;
+using daphne::SaveStateResponse;
+using daphne::RestoreStateRequest;
+using daphne::RestoreStateResponse;
 
 using daphne::cmd_alignAFEs;
 using daphne::cmd_alignAFEs_response;
@@ -123,25 +166,16 @@ using daphne::cmd_clearHDMezzAlertFlag;
 using daphne::cmd_clearHDMezzAlertFlag_response;
 
 
-struct I2C2BusGuard {
-  Daphne& d;
-  std::unique_lock<std::mutex> lock;
-
-  explicit I2C2BusGuard(Daphne& daphne) : d(daphne), lock(daphne.i2c_2_mutex) {
-    d.isI2C_2_device_configuring.store(true);
-  }
-
-  ~I2C2BusGuard() {
-    d.isI2C_2_device_configuring.store(false);
-  }
-};
-
-
 bool auto_align_enabled() {
   static const bool enabled = (std::getenv("DAPHNE_SKIP_ALIGN_AFTER_CONFIGURE") == nullptr);
   return enabled;
 }
 
+bool legacy_align_enabled() {
+  static const bool enabled = (std::getenv("DAPHNE_LEGACY_ALIGN") != nullptr);
+  return enabled;
+}
+
 bool config_resets_enabled() {
   static const bool enabled = (std::getenv("DAPHNE_SKIP_CONFIG_RESET") == nullptr);
   return enabled;
@@ -166,22 +200,29 @@ std::string decode_clk_status(uint32_t v) {
   return os.str();
 }
 
-namespace trigregs {
-constexpr uint32_t PHYS_BASE = 0xA0010000u;
-constexpr uint32_t STRIDE = 0x20u;
-constexpr uint32_t NUM_CHANNELS = 40u;
-constexpr uint32_t OFF_THR = 0x00u;
-constexpr uint32_t OFF_REC_LO = 0x04u;
-constexpr uint32_t OFF_REC_HI = 0x08u;
-constexpr uint32_t OFF_BSY_LO = 0x0Cu;
-constexpr uint32_t OFF_BSY_HI = 0x10u;
-constexpr uint32_t OFF_FUL_LO = 0x14u;
-constexpr uint32_t OFF_FUL_HI = 0x18u;
-constexpr uint32_t THRESH_MASK = 0x0FFFFFFFu;
-constexpr uint32_t MASK_REG_LOW = 0x94000020u;
-constexpr uint32_t MASK_REG_HIGH = 0x94000024u;
-}  // namespace trigregs
+bool read_counters_block(TriggerBlock& block,
+                         const std::vector<uint32_t>& chs,
+                         ReadTriggerCountersResponse& resp,
+                         std::string& err) {
+  try {
+    for (const auto ch : chs) {
+      if (ch >= TriggerBlock::kNumChannels) continue;
+      const TriggerBlock::Counters counters = block.getCounters(ch);
+      auto* s = resp.add_snapshots();
+      s->set_channel(ch);
+      s->set_threshold(block.getThreshold(ch));
+      s->set_record_count(counters.record);
+      s->set_busy_count(counters.busy);
+      s->set_full_count(counters.full);
+    }
+  } catch (const std::exception& e) {
+    err = e.what();
+    return false;
+  }
+  return true;
+}
 
+// Counters of a trigger block at a non-default address (ReadTriggerCountersRequest.base_addr).
 bool read_counters_raw(uint32_t base,
                        const std::vector<uint32_t>& chs,
                        ReadTriggerCountersResponse& resp,
@@ -193,9 +234,9 @@ bool read_counters_raw(uint32_t base,
   const uint64_t map_base = (static_cast<uint64_t>(base)) & ~(pg - 1ULL);
   uint32_t maxch = 0;
   for (const auto c : chs) {
-    if (c < trigregs::NUM_CHANNELS && c > maxch) maxch = c;
+    if (c < TriggerBlock::kNumChannels && c > maxch) maxch = c;
   }
-  const uint32_t span = (maxch * trigregs::STRIDE) + trigregs::OFF_FUL_HI + 4u;
+  const uint32_t span = (maxch * TriggerBlock::kStride) + TriggerBlock::kOffFullHi + 4u;
   const uint64_t tail = (static_cast<uint64_t>(base) - map_base) + static_cast<uint64_t>(span);
   const uint64_t map_len = (tail + (pg - 1ULL)) & ~(pg - 1ULL);
 
@@ -225,14 +266,14 @@ bool read_counters_raw(uint32_t base,
   };
 
   for (const auto ch : chs) {
-    if (ch >= trigregs::NUM_CHANNELS) continue;
-    const uint32_t b = base + ch * trigregs::STRIDE;
+    if (ch >= TriggerBlock::kNumChannels) continue;
+    const uint32_t b = base + ch * TriggerBlock::kStride;
     auto* s = resp.add_snapshots();
     s->set_channel(ch);
-    s->set_threshold(rd32(b + trigregs::OFF_THR) & trigregs::THRESH_MASK);
-    s->set_record_count(rd64(b + trigregs::OFF_REC_LO, b + trigregs::OFF_REC_HI));
-    s->set_busy_count(rd64(b + trigregs::OFF_BSY_LO, b + trigregs::OFF_BSY_HI));
-    s->set_full_count(rd64(b + trigregs::OFF_FUL_LO, b + trigregs::OFF_FUL_HI));
+    s->set_threshold(rd32(b + TriggerBlock::kOffThreshold) & TriggerBlock::kThresholdMask);
+    s->set_record_count(rd64(b + TriggerBlock::kOffRecordLo, b + TriggerBlock::kOffRecordHi));
+    s->set_busy_count(rd64(b + TriggerBlock::kOffBusyLo, b + TriggerBlock::kOffBusyHi));
+    s->set_full_count(rd64(b + TriggerBlock::kOffFullLo, b + TriggerBlock::kOffFullHi));
   }
 
   munmap(ptr, map_len);
@@ -240,97 +281,52 @@ bool read_counters_raw(uint32_t base,
   return true;
 }
 
-bool write_trigger_thresholds(const ConfigureRequest& cfg, std::string& response_msg) {
-  std::ostringstream out;
-  std::vector<uint32_t> channels;
-  channels.reserve(static_cast<size_t>(cfg.channels_size()));
-  for (const auto& ch_cfg : cfg.channels()) {
-    channels.push_back(ch_cfg.id());
-  }
-
-  if (channels.empty()) {
-    response_msg = "No channels provided; skipping trigger threshold programming.\n";
+bool write_trigger_thresholds(const ConfigurePlan& plan,
+                              Daphne& daphne,
+                              std::ostringstream* log,
+                              std::string& error) {
+  if (plan.thresholds.empty()) {
+    if (log) *log << "No channels provided; skipping trigger threshold programming.\n";
     return true;
   }
 
-  std::sort(channels.begin(), channels.end());
-  channels.erase(std::unique(channels.begin(), channels.end()), channels.end());
-  for (const auto ch : channels) {
-    if (ch >= trigregs::NUM_CHANNELS) {
-      out << "Channel out of range for trigger threshold: " << ch << " (0.."
-          << (trigregs::NUM_CHANNELS - 1) << ").\n";
-      response_msg = out.str();
+  try {
+    TriggerBlock* block = daphne.getTriggerBlock();
+    const std::vector<uint32_t> mismatches = block->setThresholds(plan.thresholds);
+    if (log) {
+      *log << "Trigger thresholds written:";
+      for (const auto& threshold : plan.thresholds) {
+        *log << " " << threshold.first << "=0x" << std::hex << threshold.second << std::dec;
+      }
+      *log << ".\n";
+    }
+    if (!mismatches.empty()) {
+      std::ostringstream os;
+      os << "Trigger threshold read-back mismatch on channels:";
+      for (const uint32_t ch : mismatches) os << " " << ch;
+      error = os.str() + ".";
+      if (log) *log << error << "\n";
       return false;
     }
-  }
 
-  const uint64_t requested_thr = cfg.self_trigger_threshold();
-  uint32_t thr_val = static_cast<uint32_t>(requested_thr & trigregs::THRESH_MASK);
-  if (requested_thr > static_cast<uint64_t>(trigregs::THRESH_MASK)) {
-    out << "Requested threshold " << requested_thr
-        << " exceeds 28-bit THRESH_S_AXI range; clamping to 0x0FFFFFFF.\n";
-    thr_val = trigregs::THRESH_MASK;
-  }
-
-  try {
-    DevMem thr_mem(trigregs::PHYS_BASE);
-    const size_t span = trigregs::STRIDE * trigregs::NUM_CHANNELS + 4u;
-    thr_mem.map_memory(span);
-    for (const auto ch : channels) {
-      const size_t off = static_cast<size_t>(ch) * trigregs::STRIDE + trigregs::OFF_THR;
-      thr_mem.write(off, std::vector<uint32_t>{thr_val});
-    }
-    out << "Trigger threshold_xc 0x" << std::hex << thr_val << std::dec
-        << " written to channels:";
-    for (const auto ch : channels) out << " " << ch;
-    out << ".\n";
-  } catch (const std::exception& e) {
-    out << "Failed to write trigger thresholds via /dev/mem: " << e.what() << ".\n";
-    response_msg = out.str();
-    return false;
-  }
-
-  uint32_t mask_low = 0;
-  uint32_t mask_high = 0;
-  for (const auto ch : channels) {
-    if (ch < 32) {
-      mask_low |= (1u << ch);
-    } else {
-      mask_high |= (1u << (ch - 32));
+    const uint64_t mask = (static_cast<uint64_t>(plan.trigger_mask_high) << 32) | plan.trigger_mask_low;
+    const bool mask_ok = block->setEnableMask(mask);
+    if (log) {
+      *log << "Trigger enable LOW @ 0x" << std::hex << TriggerBlock::kEnableMaskLow << " = 0x" << plan.trigger_mask_low
+           << ", HIGH @ 0x" << TriggerBlock::kEnableMaskHigh << " = 0x" << plan.trigger_mask_high << std::dec << ".\n";
     }
-  }
-
-  bool ok = true;
-  try {
-    DevMem mlow(trigregs::MASK_REG_LOW);
-    mlow.map_memory(4);
-    mlow.write(0, std::vector<uint32_t>{mask_low});
-    out << "Trigger enable LOW @ 0x" << std::hex << trigregs::MASK_REG_LOW << " = 0x" << mask_low
-        << std::dec << ".\n";
-  } catch (const std::exception& e) {
-    out << "Failed to write LOW trigger mask via /dev/mem: " << e.what() << ".\n";
-    ok = false;
-  }
-
-  try {
-    DevMem mhigh(trigregs::MASK_REG_HIGH);
-    mhigh.map_memory(4);
-    mhigh.write(0, std::vector<uint32_t>{mask_high});
-    out << "Trigger enable HIGH @ 0x" << std::hex << trigregs::MASK_REG_HIGH << " = 0x" << mask_high
-        << std::dec << ".\n";
-  } catch (const std::exception& e) {
-    if (mask_high != 0) {
-      out << "Failed to write HIGH trigger mask via /dev/mem: " << e.what() << ".\n";
-      ok = false;
-    } else {
-      out << "High trigger mask register unavailable; skipped.\n";
+    if (!mask_ok) {
+      error = "Trigger enable mask read-back mismatch.";
+      if (log) *log << error << "\n";
+      return false;
     }
+  } catch (const std::exception& e) {
+    error = std::string("Failed to program the trigger block via /dev/mem: ") + e.what() + ".";
+    if (log) *log << error << "\n";
+    return false;
   }
-
-  response_msg = out.str();
-  return ok;
+  return true;
 }
-
 struct EpRegs {
   FpgaRegDict dict;
   reg r;
@@ -401,141 +397,300 @@ bool set_endpoint_addr_and_reset(uint16_t ep_addr,
   }
 }
 
-bool configureDaphne(const ConfigureRequest& requested_cfg, Daphne& daphne, std::string& response_str) {
-  try {
-    std::ostringstream out;
-    bool ok_all = true;
+struct ConfigureStep {
+  const char* name = "";
+  bool ok = true;
+  uint32_t applied = 0;
+  uint32_t skipped = 0;  // delta configure only
+  std::string error;
+};
 
-    const bool requested_bias_for_any_afe =
-        std::any_of(requested_cfg.afes().begin(),
-                    requested_cfg.afes().end(),
-                    [](const AFEConfig& afe_cfg) { return afe_cfg.v_bias() > 0; });
-    bool bias_control_applied = false;
+struct ConfigureOutcome {
+  bool frontend_reset = false;  // AFEs were reset/power-cycled, alignment must be redone
+  uint32_t applied_ops = 0;
+  uint32_t skipped_ops = 0;
+  std::vector<ConfigureStep> steps;  // execution order
+};
 
-    if (config_resets_enabled()) {
-      daphne.getAfe()->doReset();
-      daphne.getAfe()->setPowerState(1);
-    } else {
-      out << "Config reset/powercycle skipped (DAPHNE_SKIP_CONFIG_RESET set).\n";
+using afe_definitions::AfeFunction;
+
+// AFE functions that change the serial data format. In delta mode a change in
+// any of them forces the full reset/powercycle path (and a new alignment).
+constexpr std::array<AfeFunction, 4> kFormatAfeFunctions = {
+    AfeFunction::SERIALIZED_DATA_RATE, AfeFunction::ADC_RESOLUTION_RESET, AfeFunction::ADC_OUTPUT_FORMAT,
+    AfeFunction::LSB_MSB_FIRST};
+
+// The wire enum is the table index + 1 (0 means "use the function name").
+static_assert(daphne::AfeFunctionId_ARRAYSIZE == afe_definitions::afeFunctionTable.size() + 1,
+              "AfeFunctionId in daphneV3_low_level_confs.proto is out of sync with afeFunctionTable");
+
+ConfigurePlanCache& configure_plan_cache() {
+  static ConfigurePlanCache cache;
+  return cache;
+}
+
+// Programs a compiled plan. The detailed per-write report goes to log; cached
+// replays pass nullptr and only get the per-step counts in result.steps.
+bool run_configure_plan(const ConfigurePlan& plan,
+                        Daphne& daphne,
+                        std::ostringstream* log,
+                        ConfigureOutcome& result) {
+  ClientAcquisitionGuard acquisition(daphne);
+  bool ok_all = true;
+
+  // Steps are held by reference while later ones are added: reserve them all up front.
+  constexpr size_t kMaxSteps = 8;
+  result.steps.reserve(kMaxSteps);
+  auto add_step = [&](const char* name) -> ConfigureStep& {
+    if (result.steps.size() == kMaxSteps) throw std::logic_error("Too many configure steps");
+    ConfigureStep step;
+    step.name = name;
+    result.steps.push_back(std::move(step));
+    return result.steps.back();
+  };
+
+  // Delta mode: a setting whose programmed value is known and equal to the
+  // request is not written again.
+  auto needs_write = [&](ConfigureStep& step, const std::optional<uint32_t>& programmed, uint32_t requested) {
+    if (plan.delta && programmed && *programmed == requested) {
+      ++step.skipped;
+      ++result.skipped_ops;
+      return false;
     }
+    ++step.applied;
+    ++result.applied_ops;
+    return true;
+  };
+
+  if (log) *log << plan.warnings;
 
-    {
-      std::string thr_msg;
-      const bool thr_ok = write_trigger_thresholds(requested_cfg, thr_msg);
-      ok_all = ok_all && thr_ok;
-      out << "[TRIGGER_THRESHOLDS]\n" << thr_msg;
+  {
+    ConfigureStep& step = add_step("reset");
+    bool do_reset = config_resets_enabled();
+    if (plan.delta && do_reset) {
+      std::string reason;
+      if (daphne.getAfe()->getPowerState() != 1) {
+        reason = "AFEs not powered";
+      }
+      for (const ConfigurePlan::Afe& afe : plan.afes) {
+        if (!reason.empty()) break;
+        for (const auto& fn : afe.functions) {
+          if (std::find(kFormatAfeFunctions.begin(), kFormatAfeFunctions.end(), fn.first) ==
+              kFormatAfeFunctions.end()) {
+            continue;
+          }
+          const char* name = afe_definitions::afeFunctionInfo(fn.first).name;
+          const std::optional<uint32_t> programmed = daphne.findAfeFunctionDictValue(afe.pl, fn.first);
+          if (!programmed || *programmed != fn.second) {
+            reason = std::string(name) + (programmed ? " changed" : " unknown") + " on AFE " +
+                     std::to_string(afe.board);
+            break;
+          }
+        }
+      }
+      do_reset = !reason.empty();
+      if (!do_reset) ++step.skipped;
+      if (log) {
+        if (do_reset) {
+          *log << "Delta configure: reset/powercycle required (" << reason << ").\n";
+        } else {
+          *log << "Delta configure: reset/powercycle skipped (data format unchanged).\n";
+        }
+      }
     }
 
-    for (const ChannelConfig& ch_config : requested_cfg.channels()) {
-      const uint32_t ch = ch_config.id();
-      if (ch > 39) throw std::invalid_argument("Channel out of range (0..39): " + std::to_string(ch));
+    if (do_reset) {
+      daphne.getAfe()->doReset();
+      daphne.getAfe()->setPowerState(1);
+      daphne.clearAfeFunctionDictValues();
+      result.frontend_reset = true;
+      ++step.applied;
+    } else if (!config_resets_enabled() && log) {
+      *log << "Config reset/powercycle skipped (DAPHNE_SKIP_CONFIG_RESET set).\n";
+    }
+  }
 
-      const uint32_t afe_board = ch / 8;
-      const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
-      const uint32_t idx = ch % 8;
-
-      daphne.getDac()->setDacTrim(afe_pl, idx, ch_config.trim(), false, false);
-      daphne.setChTrimDictValue(ch, ch_config.trim());
-      out << "Trim value written successfully for Channel " << ch << ". Trim value: " << ch_config.trim()
-          << ". Returned value: " << daphne.getChTrimDictValue(ch) << ".\n";
-
-      daphne.getDac()->setDacOffset(afe_pl, idx, ch_config.offset(), false, false);
-      daphne.setChOffsetDictValue(ch, ch_config.offset());
-      out << "Offset value written successfully for Channel " << ch << ". Offset value: " << ch_config.offset()
-          << ". Returned value: " << daphne.getChOffsetDictValue(ch) << ".\n";
-    }
-
-    {
-      const uint32_t ctrl = requested_cfg.biasctrl();
-      if (ctrl <= 4095) {
-        const uint32_t returnedControlValue = daphne.getDac()->setDacHvBias(ctrl, false, false);
-        const uint32_t returnedBiasEnable = daphne.getDac()->setBiasEnable(true);
-        daphne.setBiasControlDictValue(ctrl);
-        bias_control_applied = true;
-        out << "Bias Control value written successfully. Bias Control value: " << ctrl << " and Enable: "
-            << returnedBiasEnable << " Returned value: " << returnedControlValue << ".\n";
-      } else {
-        out << "Warning: Bias Control value " << ctrl << " out of range (0..4095). Skipping.\n";
+  {
+    ConfigureStep& step = add_step("trigger_thresholds");
+    if (log) *log << "[TRIGGER_THRESHOLDS]\n";
+    step.ok = write_trigger_thresholds(plan, daphne, log, step.error);
+    if (step.ok) step.applied = static_cast<uint32_t>(plan.thresholds.size());
+    ok_all = ok_all && step.ok;
+  }
+
+  // The trim/offset DACs pack an H/L channel pair into one word: every touched
+  // pair of an AFE is written once.
+  {
+    ConfigureStep& trim_step = add_step("trim");
+    ConfigureStep& offset_step = add_step("offset");
+    for (uint32_t afe_board = 0; afe_board < plan.dacs.size(); ++afe_board) {
+      const ConfigurePlan::Dac& dac = plan.dacs[afe_board];
+      uint8_t trim_mask = 0;
+      uint8_t offset_mask = 0;
+      for (uint32_t idx = 0; idx < 8; ++idx) {
+        if ((dac.channels & (1u << idx)) == 0) continue;
+        const uint32_t ch = afe_board * 8 + idx;
+        if (needs_write(trim_step, daphne.findChTrimDictValue(ch), dac.trims[idx])) trim_mask |= 1u << idx;
+        if (needs_write(offset_step, daphne.findChOffsetDictValue(ch), dac.offsets[idx])) offset_mask |= 1u << idx;
+      }
+      if (trim_mask != 0) {
+        daphne.getDac()->setTrims(dac.pl, dac.trims, false, false, trim_mask);
+      }
+      if (offset_mask != 0) {
+        daphne.getDac()->setOffsets(dac.pl, dac.offsets, false, false, offset_mask);
+      }
+      for (uint32_t idx = 0; idx < 8; ++idx) {
+        const uint32_t ch = afe_board * 8 + idx;
+        if (trim_mask & (1u << idx)) {
+          daphne.setChTrimDictValue(ch, dac.trims[idx]);
+          if (log) {
+            *log << "Trim value written successfully for Channel " << ch << ". Trim value: " << dac.trims[idx]
+                 << ". Returned value: " << daphne.getChTrimDictValue(ch) << ".\n";
+          }
+        }
+        if (offset_mask & (1u << idx)) {
+          daphne.setChOffsetDictValue(ch, dac.offsets[idx]);
+          if (log) {
+            *log << "Offset value written successfully for Channel " << ch << ". Offset value: " << dac.offsets[idx]
+                 << ". Returned value: " << daphne.getChOffsetDictValue(ch) << ".\n";
+          }
+        }
       }
     }
+  }
 
-    if (!bias_control_applied && requested_bias_for_any_afe) {
-      const uint32_t ctrl = 4095;
+  if (plan.biasctrl) {
+    ConfigureStep& step = add_step("biasctrl");
+    const uint32_t ctrl = *plan.biasctrl;
+    bool write = true;
+    if (plan.biasctrl_default) {
+      ++step.applied;
+      ++result.applied_ops;
+    } else {
+      write = needs_write(step, daphne.findBiasControlDictValue(), ctrl);
+    }
+    // The enable bit is not tracked, so it is always (re)asserted.
+    if (write) {
       const uint32_t returnedControlValue = daphne.getDac()->setDacHvBias(ctrl, false, false);
       const uint32_t returnedBiasEnable = daphne.getDac()->setBiasEnable(true);
       daphne.setBiasControlDictValue(ctrl);
-      out << "Bias Control was not set in request but AFE bias values are present. Defaulting Bias Control to " << ctrl
-          << " and Enable: " << returnedBiasEnable << " Returned value: " << returnedControlValue << ".\n";
+      if (log && plan.biasctrl_default) {
+        *log << "Bias Control was not set in request but AFE bias values are present. Defaulting Bias Control to "
+             << ctrl << " and Enable: " << returnedBiasEnable << " Returned value: " << returnedControlValue << ".\n";
+      } else if (log) {
+        *log << "Bias Control value written successfully. Bias Control value: " << ctrl << " and Enable: "
+             << returnedBiasEnable << " Returned value: " << returnedControlValue << ".\n";
+      }
+    } else {
+      daphne.getDac()->setBiasEnable(true);
     }
+  }
 
-    for (const AFEConfig& afe_config : requested_cfg.afes()) {
-      const uint32_t afe_board = afe_config.id();
-      const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+  struct PendingAfeFunctions {
+    const ConfigurePlan::Afe* afe;
+    std::vector<std::pair<AfeFunction, uint16_t>> functions;
+    std::future<std::vector<uint32_t>> returned;
+  };
+  std::vector<PendingAfeFunctions> pending_functions;
+
+  ConfigureStep& vgain_step = add_step("vgain");
+  ConfigureStep& bias_step = add_step("bias");
+  ConfigureStep& function_step = add_step("afe_function");
+  for (const ConfigurePlan::Afe& afe : plan.afes) {
+    if (needs_write(vgain_step, daphne.findAfeAttenuationDictValue(afe.pl), afe.vgain)) {
+      daphne.getDac()->setDacGain(afe.pl, afe.vgain);
+      daphne.setAfeAttenuationDictValue(afe.pl, afe.vgain);
+      if (log) {
+        *log << "AFE VGAIN written successfully for AFE " << afe.board << ". VGAIN: " << afe.vgain
+             << ". Returned value: " << daphne.getAfeAttenuationDictValue(afe.pl) << ".\n";
+      }
+    }
 
-      const uint32_t v = afe_config.attenuators();
-      if (v > 4095) throw std::invalid_argument("VGAIN out of range for AFE " + std::to_string(afe_board));
-      daphne.getDac()->setDacGain(afe_pl, v);
-      daphne.setAfeAttenuationDictValue(afe_pl, v);
-      out << "AFE VGAIN written successfully for AFE " << afe_board << ". VGAIN: " << v
-          << ". Returned value: " << daphne.getAfeAttenuationDictValue(afe_pl) << ".\n";
-
-      const uint32_t bias = afe_config.v_bias();
-      if (bias > 4095) throw std::invalid_argument("BIAS out of range for AFE " + std::to_string(afe_board));
-      if (bias != 0) {
-        daphne.getDac()->setDacBias(afe_pl, bias);
-        daphne.setBiasVoltageDictValue(afe_pl, bias);
-        out << "AFE bias value written successfully for AFE " << afe_board << ". Bias value: " << bias
-            << ". Returned value: " << daphne.getBiasVoltageDictValue(afe_pl) << ".\n";
+    if (afe.bias != 0 && needs_write(bias_step, daphne.findBiasVoltageDictValue(afe.pl), afe.bias)) {
+      daphne.getDac()->setDacBias(afe.pl, afe.bias);
+      daphne.setBiasVoltageDictValue(afe.pl, afe.bias);
+      if (log) {
+        *log << "AFE bias value written successfully for AFE " << afe.board << ". Bias value: " << afe.bias
+             << ". Returned value: " << daphne.getBiasVoltageDictValue(afe.pl) << ".\n";
       }
+    }
 
-      const uint32_t adc_res = afe_config.adc().resolution() ? 1u : 0u;
-      const uint32_t adc_out_fmt = afe_config.adc().output_format() ? 1u : 0u;
-      const uint32_t adc_sb_first = afe_config.adc().sb_first() ? 1u : 0u;
-
-      uint32_t r = daphne.getAfe()->setAFEFunction(afe_pl, "SERIALIZED_DATA_RATE", 1u);
-      out << "Function SERIALIZED_DATA_RATE in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "ADC_RESOLUTION_RESET", adc_res);
-      out << "Function ADC_RESOLUTION_RESET in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "ADC_OUTPUT_FORMAT", adc_out_fmt);
-      out << "Function ADC_OUTPUT_FORMAT in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "LSB_MSB_FIRST", adc_sb_first);
-      out << "Function LSB_MSB_FIRST in AFE " << afe_board << " configured correctly.\nReturned value: " << r << "\n";
-
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "LPF_PROGRAMMABILITY", afe_config.pga().lpf_cut_frequency());
-      out << "Function LPF_PROGRAMMABILITY in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl,
-                                          "PGA_INTEGRATOR_DISABLE",
-                                          afe_config.pga().integrator_disable() ? 1u : 0u);
-      out << "Function PGA_INTEGRATOR_DISABLE in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "PGA_CLAMP_LEVEL", 2u);
-      out << "Function PGA_CLAMP_LEVEL in AFE " << afe_board << " configured correctly.\nReturned value: " << r << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "ACTIVE_TERMINATION_ENABLE", 0u);
-      out << "Function ACTIVE_TERMINATION_ENABLE in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "LNA_INPUT_CLAMP_SETTING", afe_config.lna().clamp());
-      out << "Function LNA_INPUT_CLAMP_SETTING in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl, "LNA_GAIN", afe_config.lna().gain());
-      out << "Function LNA_GAIN in AFE " << afe_board << " configured correctly.\nReturned value: " << r << "\n";
-      r = daphne.getAfe()->setAFEFunction(afe_pl,
-                                          "LNA_INTEGRATOR_DISABLE",
-                                          afe_config.lna().integrator_disable() ? 1u : 0u);
-      out << "Function LNA_INTEGRATOR_DISABLE in AFE " << afe_board << " configured correctly.\nReturned value: " << r
-          << "\n";
-    }
-
-    if (config_resets_enabled()) {
-      daphne.getAfe()->setPowerState(1);
+    // All pending functions of this AFE in one batch: one write per touched register.
+    std::vector<std::pair<AfeFunction, uint16_t>> functions;
+    for (const auto& fn : afe.functions) {
+      if (needs_write(function_step, daphne.findAfeFunctionDictValue(afe.pl, fn.first), fn.second)) {
+        functions.push_back(fn);
+      }
+    }
+    if (!functions.empty()) {
+      // Queued on the AFE's SPI group; the groups run concurrently.
+      auto returned = daphne.getSpiScheduler()->applyFunctions(afe.pl, functions);
+      pending_functions.push_back({&afe, std::move(functions), std::move(returned)});
+    }
+  }
+
+  // Wait for every batch, then report the first failure (if any).
+  std::exception_ptr function_error;
+  for (PendingAfeFunctions& pending : pending_functions) {
+    try {
+      const std::vector<uint32_t> returned = pending.returned.get();
+      for (size_t i = 0; i < pending.functions.size(); ++i) {
+        const char* name = afe_definitions::afeFunctionInfo(pending.functions[i].first).name;
+        daphne.setAfeFunctionDictValue(pending.afe->pl, pending.functions[i].first, pending.functions[i].second);
+        if (log) {
+          *log << "Function " << name << " in AFE " << pending.afe->board
+               << " configured correctly.\nReturned value: " << returned[i] << "\n";
+        }
+      }
+    } catch (...) {
+      if (!function_error) function_error = std::current_exception();
     }
+  }
+  if (function_error) std::rethrow_exception(function_error);
+
+  if (result.frontend_reset) {
+    daphne.getAfe()->setPowerState(1);
+  }
 
-    response_str = out.str();
-    return ok_all;
+  if (plan.delta && log) {
+    *log << "[DELTA] applied " << result.applied_ops << ", skipped " << result.skipped_ops;
+    const char* sep = " (";
+    bool any_skipped = false;
+    for (const ConfigureStep& step : result.steps) {
+      if (step.skipped == 0 || std::strcmp(step.name, "reset") == 0) continue;
+      *log << sep << step.name << " x" << step.skipped;
+      sep = ", ";
+      any_skipped = true;
+    }
+    *log << (any_skipped ? ")" : "") << ".\n";
+  }
+
+  return ok_all;
+}
+
+// One line per step, for replays of a cached plan.
+std::string format_configure_steps(const ConfigureOutcome& outcome) {
+  std::string text = "Configure replayed from cached plan.\n";
+  for (const ConfigureStep& step : outcome.steps) {
+    text += std::string(step.name) + ": " + (step.ok ? "ok" : "FAILED") + ", applied " +
+            std::to_string(step.applied);
+    if (step.skipped != 0) text += ", skipped " + std::to_string(step.skipped);
+    if (!step.error.empty()) text += " (" + step.error + ")";
+    text += "\n";
+  }
+  return text;
+}
+
+bool configurePlan(const ConfigurePlan& plan,
+                   Daphne& daphne,
+                   bool verbose,
+                   std::string& response_str,
+                   ConfigureOutcome& outcome) {
+  try {
+    std::ostringstream out;
+    const bool ok = run_configure_plan(plan, daphne, verbose ? &out : nullptr, outcome);
+    response_str = verbose ? out.str() : format_configure_steps(outcome);
+    return ok;
   } catch (const std::exception& e) {
     response_str = std::string("Caught Exception:\n") + e.what();
     return false;
@@ -554,7 +709,7 @@ bool writeAFERegister(const cmd_writeAFEReg& request,
     response_str = "AFE Register " + std::to_string(reg_addr) + " written with value " + std::to_string(reg_value) +
                    " for AFE " + std::to_string(afe_definitions::AFE_PL2board_map.at(afe_block)) +
                    ". Returned value: " + std::to_string(returned_value) + ".";
-    daphne.setAfeRegDictValue(afe_block, reg_addr, returned_value);
+    daphne.clearAfeFunctionDictValues(afe_block);
     return true;
   } catch (const std::exception& e) {
     response_str = std::string("Error writing AFE Register: ") + e.what();
@@ -702,12 +857,13 @@ bool readAFEReg(const cmd_readAFEReg& request,
   try {
     const uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(request.afeblock());
     const uint32_t reg_addr = request.regaddress();
-    const uint32_t reg_value = daphne.getAfeRegDictValue(afe_block, reg_addr);
+    const uint32_t reg_value = request.fromhardware() ? daphne.getAfe()->getRegister(afe_block, reg_addr)
+                                                      : daphne.getAfeRegDictValue(afe_block, reg_addr);
     response.set_afeblock(request.afeblock());
     response.set_regaddress(reg_addr);
     response.set_regvalue(reg_value);
-    response_str = "AFE Register " + std::to_string(reg_addr) + " read successfully. Value: " +
-                   std::to_string(reg_value) + ".";
+    response_str = "AFE Register " + std::to_string(reg_addr) + " read successfully" +
+                   (request.fromhardware() ? " (SPI)" : " (shadow)") + ". Value: " + std::to_string(reg_value) + ".";
     return true;
   } catch (const std::exception& e) {
     response_str = std::string("Error reading AFE register: ") + e.what();
@@ -863,11 +1019,173 @@ bool readVbiasControl(const cmd_readVbiasControl&,
   }
 }
 
+bool readFullFeState(const ReadFullFeStateRequest& request,
+                     ReadFullFeStateResponse& response,
+                     Daphne& daphne,
+                     std::string& response_str) {
+  try {
+    const DaphneState::Snapshot state = daphne.getStateSnapshot();
+    response.set_sequence(state.sequence);
+
+    uint64_t trims_valid = 0;
+    uint64_t offsets_valid = 0;
+    for (uint32_t ch = 0; ch < DaphneState::kChannels; ++ch) {
+      response.add_trims(state.trims[ch].value_or(0u));
+      response.add_offsets(state.offsets[ch].value_or(0u));
+      if (state.trims[ch]) trims_valid |= 1ULL << ch;
+      if (state.offsets[ch]) offsets_valid |= 1ULL << ch;
+    }
+    response.set_trims_valid(trims_valid);
+    response.set_offsets_valid(offsets_valid);
+
+    // Attenuation/bias are kept by PL AFE; reported in board order.
+    uint32_t attenuations_valid = 0;
+    uint32_t bias_voltages_valid = 0;
+    for (uint32_t afe_board = 0; afe_board < DaphneState::kAfes; ++afe_board) {
+      const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+      response.add_attenuations(state.attenuations[afe_pl].value_or(0u));
+      response.add_bias_voltages(state.biasVoltages[afe_pl].value_or(0u));
+      if (state.attenuations[afe_pl]) attenuations_valid |= 1u << afe_board;
+      if (state.biasVoltages[afe_pl]) bias_voltages_valid |= 1u << afe_board;
+    }
+    response.set_attenuations_valid(attenuations_valid);
+    response.set_bias_voltages_valid(bias_voltages_valid);
+    response.set_bias_control(state.biasControl.value_or(0u));
+    response.set_bias_control_valid(state.biasControl.has_value());
+
+    for (const double v : daphne.getMonitoringSnapshot().vBias) response.add_bias_monitor_v(v);
+
+    uint32_t registers = 0;
+    if (!request.skip_afe_registers()) {
+      for (uint32_t afe_board = 0; afe_board < DaphneState::kAfes; ++afe_board) {
+        const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+        auto* image = response.add_afe_registers();
+        image->set_afe(afe_board);
+        for (const auto& reg : daphne.getAfe()->getShadowImage(afe_pl)) {
+          image->add_registers(reg.first);
+          image->add_values(reg.second);
+          ++registers;
+        }
+      }
+    }
+
+    response_str = "Front-end state read (sequence " + std::to_string(state.sequence) + ", " +
+                   std::to_string(registers) + " AFE register(s)).";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error reading front-end state: ") + e.what();
+    return false;
+  }
+}
+
+bool readMonitoringSnapshot(const ReadMonitoringSnapshotRequest&,
+                            ReadMonitoringSnapshotResponse& response,
+                            Daphne& daphne,
+                            std::string& response_str) {
+  uint64_t sequence = 0;
+  const MonitoringSnapshot monitor = daphne.getMonitoringSnapshot(&sequence);
+  response.set_sequence(sequence);
+  response.set_rails_cycle_ns(monitor.railsCycleNs);
+  response.set_rails_cycles(monitor.railsCycles);
+  response.set_v_3v3pds(monitor.v3V3PDS);
+  response.set_v_1v8pds(monitor.v1V8PDS);
+  response.set_v_3v3a(monitor.v3V3A);
+  response.set_v_1v8a(monitor.v1V8A);
+  response.set_v_n5va(monitor.vn5VA);
+  for (const double v : monitor.vBias) response.add_v_bias(v);
+  response.set_hdmezz_cycle_ns(monitor.hdmezzCycleNs);
+  response.set_hdmezz_cycles(monitor.hdmezzCycles);
+  for (uint32_t afe = 0; afe < monitor.hdmezz.size(); ++afe) {
+    const HDMezzRails& rails = monitor.hdmezz[afe];
+    auto* out = response.add_hdmezz();
+    out->set_afe(afe);
+    out->set_enabled(rails.enabled);
+    out->set_powered_5v(rails.powered5V);
+    out->set_powered_3v3(rails.powered3V3);
+    out->set_voltage_5v(rails.voltage5V);
+    out->set_current_5v(rails.current5V);
+    out->set_power_5v(rails.power5V);
+    out->set_voltage_3v3(rails.voltage3V3);
+    out->set_current_3v3(rails.current3V3);
+    out->set_power_3v3(rails.power3V3);
+    out->set_alert_5v(rails.alert5V);
+    out->set_alert_3v3(rails.alert3V3);
+  }
+  response_str = "Monitoring snapshot " + std::to_string(sequence) + ".";
+  return true;
+}
+
+bool readMetricSeries(const ReadMetricSeriesRequest& request,
+                      ReadMetricSeriesResponse& response,
+                      Daphne& daphne,
+                      std::string& response_str) {
+  try {
+    MonitoringSeries::Resolution resolution = MonitoringSeries::Resolution::kRaw;
+    switch (request.resolution()) {
+      case daphne::SERIES_RAW: resolution = MonitoringSeries::Resolution::kRaw; break;
+      case daphne::SERIES_1S: resolution = MonitoringSeries::Resolution::kSecond; break;
+      case daphne::SERIES_1MIN: resolution = MonitoringSeries::Resolution::kMinute; break;
+      default:
+        response_str = "Unknown series resolution " + std::to_string(request.resolution()) + ".";
+        return false;
+    }
+    if (request.to_ns() != 0 && request.to_ns() < request.from_ns()) {
+      response_str = "to_ns is before from_ns.";
+      return false;
+    }
+
+    std::vector<size_t> metrics;
+    if (request.metrics().empty()) {
+      for (size_t i = 0; i < MonitoringSeries::getMetricNames().size(); ++i) metrics.push_back(i);
+    } else {
+      for (const auto& name : request.metrics()) {
+        const int metric = MonitoringSeries::findMetric(name);
+        if (metric < 0) {
+          response_str = "Unknown metric '" + name + "'.";
+          return false;
+        }
+        metrics.push_back(static_cast<size_t>(metric));
+      }
+    }
+
+    const MonitoringSeries* store = daphne.getMonitoringSeries();
+    const bool raw = resolution == MonitoringSeries::Resolution::kRaw;
+    size_t points = 0;
+    response.set_resolution(request.resolution());
+    response.set_capacity(static_cast<uint32_t>(store->getCapacity(resolution)));
+    for (const size_t metric : metrics) {
+      bool truncated = false;
+      const auto series = store->query(metric, resolution, request.from_ns(), request.to_ns(),
+                                       request.max_points(), &truncated);
+      auto* out = response.add_series();
+      out->set_name(MonitoringSeries::getMetricNames()[metric]);
+      out->set_truncated(truncated);
+      for (const auto& point : series) {
+        out->add_timestamp_ns(point.timestamp_ns);
+        out->add_mean(point.mean);
+        if (!raw) {
+          out->add_min(point.min);
+          out->add_max(point.max);
+          out->add_count(point.count);
+        }
+      }
+      points += series.size();
+    }
+    response_str = "Read " + std::to_string(points) + " point(s) of " + std::to_string(metrics.size()) +
+                   " metric(s).";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error reading metric series: ") + e.what();
+    return false;
+  }
+}
+
 bool dumpSpybuffer(const DumpSpyBuffersRequest& request,
                    DumpSpyBuffersResponse& response,
                    Daphne& daphne,
                    std::string& response_str) {
   try {
+    ClientAcquisitionGuard acquisition(daphne);
     const uint32_t number_of_samples = request.numberofsamples();
     const uint32_t number_of_waveforms = request.numberofwaveforms();
     const auto& channel_list = request.channellist();
@@ -950,17 +1268,86 @@ bool dumpSpybuffer(const DumpSpyBuffersRequest& request,
   }
 }
 
-bool alignAFE(const cmd_alignAFEs&,
+bool commonModeNoise(const CommonModeNoiseRequest& request,
+                     CommonModeNoiseResponse& response,
+                     Daphne& daphne,
+                     std::string& response_str) {
+  try {
+    ClientAcquisitionGuard acquisition(daphne);
+    response_str = analyze_common_mode(request, daphne, response, max_spybuffer_bytes());
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error running common-mode analysis: ") + e.what();
+    return false;
+  }
+}
+
+bool tunePedestals(const TunePedestalsRequest& request,
+                   TunePedestalsResponse& response,
+                   Daphne& daphne,
+                   std::string& response_str) {
+  try {
+    ClientAcquisitionGuard acquisition(daphne);
+    response_str = tune_pedestals(request, daphne, response);
+    return true;
+  } catch (const std::exception& e) {
+    response.clear_results();
+    response_str = std::string("Error tuning pedestals: ") + e.what();
+    return false;
+  }
+}
+
+// Mean regulator temperature, NaN if the regulators cannot be read.
+double board_temperature_C(Daphne& daphne) {
+  auto* regulators = daphne.getRegulatorsDriver();
+  if (!regulators) return std::numeric_limits<double>::quiet_NaN();
+  try {
+    return daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser, [&] {
+      double sum = 0.0;
+      for (uint8_t r = 0; r < 4; ++r) {
+        sum += regulators->readTemperature(r);
+      }
+      return sum / 4.0;
+    });
+  } catch (const std::exception&) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+// One trigger per read covers all five AFEs. ok[afe] is cleared on any word
+// other than 0x00FF00FF; dbg[afe] gets the VERIFY_SCAN line.
+void verify_all_afes(Daphne& daphne,
+                     uint32_t reads,
+                     std::array<bool, 5>& ok,
+                     std::array<std::string, 5>& dbg) {
+  constexpr uint32_t kExpectedFclkWord = 0x00FF00FFu;
+  for (auto& line : dbg) line = "  VERIFY_SCAN:";
+  for (uint32_t i = 0; i < reads; ++i) {
+    const std::array<uint32_t, 5> words = daphne.readFrameClocks();
+    for (uint32_t afe_block = 0; afe_block < 5; ++afe_block) {
+      std::ostringstream os;
+      os << " [" << i << "]=0x" << std::hex << std::uppercase << words[afe_block];
+      dbg[afe_block] += os.str();
+      if (words[afe_block] != kExpectedFclkWord) {
+        ok[afe_block] = false;
+      }
+    }
+  }
+}
+
+bool alignAFE(const cmd_alignAFEs& request,
               cmd_alignAFEs_response& response,
               Daphne& daphne,
               std::string& response_str) {
   try {
+    ClientAcquisitionGuard acquisition(daphne);
     constexpr uint32_t kExpectedFclkWord = 0x00FF00FFu;
     constexpr uint32_t kVerificationReads = 4;
     constexpr uint32_t afe_num = 5;
     std::vector<uint32_t> delay(afe_num, 0);
     std::vector<uint32_t> bitslip(afe_num, 0);
 
+    const auto t_start = std::chrono::steady_clock::now();
     daphne.getFrontEnd()->resetDelayCtrlValues();
     daphne.getFrontEnd()->doResetDelayCtrl();
     daphne.getFrontEnd()->doResetSerDesCtrl();
@@ -972,38 +1359,109 @@ bool alignAFE(const cmd_alignAFEs&,
 
     std::string report;
     std::vector<std::string> failures;
-    for (uint32_t afe_block = 0; afe_block < afe_num; ++afe_block) {
-      std::string delay_dbg;
-      std::string bitslip_dbg;
-      bool matched = false;
-      daphne.setBestDelay(afe_block, 512, &delay_dbg);
-      const uint32_t aligned_word = daphne.setBestBitslip(afe_block, 16, &bitslip_dbg, &matched);
-      report += delay_dbg + bitslip_dbg;
-
-      bool verification_ok = matched;
-      report += "  VERIFY_SCAN:";
-      for (uint32_t i = 0; i < kVerificationReads; ++i) {
-        daphne.getFrontEnd()->doTrigger();
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        const uint32_t verify_word = daphne.getSpyBuffer()->getFrameClock(afe_block, 0);
-        report += " [" + std::to_string(i) + "]=0x" +
-                  [&]() {
-                    std::ostringstream os;
-                    os << std::hex << std::uppercase << verify_word;
-                    return os.str();
-                  }();
-        if (verify_word != kExpectedFclkWord) {
-          verification_ok = false;
+    uint32_t triggers = 0;
+    std::string mode = legacy_align_enabled() ? "legacy" : "parallel";
+
+    // Cached result for this firmware/board/temperature: apply and verify, scan only on failure.
+    AlignmentCache* cache = daphne.getAlignmentCache();
+    AlignmentCacheKey cache_key;
+    bool from_cache = false;
+    if (cache) {
+      cache_key = daphne.getAlignmentCacheKey(board_temperature_C(daphne));
+      std::ostringstream key_os;
+      key_os << "git=0x" << std::hex << cache_key.git << std::dec << " slot=" << cache_key.slot
+             << " crate=" << cache_key.crate << " temp_band=";
+      if (cache_key.temperatureBand == AlignmentCacheKey::kUnknownTemperatureBand) {
+        key_os << "unknown";
+      } else {
+        key_os << cache_key.temperatureBand;
+      }
+      const std::optional<AlignmentCacheEntry> entry =
+          request.full_scan() ? std::nullopt : cache->lookup(cache_key);
+      if (entry) {
+        for (uint32_t afe_block = 0; afe_block < afe_num; ++afe_block) {
+          daphne.getFrontEnd()->setDelay(afe_block, entry->delay[afe_block]);
+          daphne.getFrontEnd()->setBitslip(afe_block, entry->bitslip[afe_block]);
+        }
+        std::array<bool, afe_num> verification_ok;
+        verification_ok.fill(true);
+        std::array<std::string, afe_num> verify_dbg;
+        verify_all_afes(daphne, kVerificationReads, verification_ok, verify_dbg);
+        triggers += kVerificationReads;
+        from_cache = std::all_of(verification_ok.begin(), verification_ok.end(), [](bool ok) { return ok; });
+        report += std::string("ALIGN_CACHE: ") + (from_cache ? "hit" : "stale") + " (" + key_os.str() + ")\n";
+        for (uint32_t afe_block = 0; afe_block < afe_num; ++afe_block) {
+          report += verify_dbg[afe_block] + "\n";
+        }
+        if (from_cache) {
+          mode = "cache";
+        } else {
+          cache->invalidate(cache_key);
         }
+      } else {
+        report += std::string("ALIGN_CACHE: ") + (request.full_scan() ? "bypassed" : "miss") +
+                  " (" + key_os.str() + ")\n";
       }
-      report += "\n";
+    }
+
+    if (!from_cache && legacy_align_enabled()) {
+      for (uint32_t afe_block = 0; afe_block < afe_num; ++afe_block) {
+        std::string delay_dbg;
+        std::string bitslip_dbg;
+        bool matched = false;
+        daphne.setBestDelay(afe_block, 512, &delay_dbg);
+        const uint32_t aligned_word = daphne.setBestBitslip(afe_block, 16, &bitslip_dbg, &matched);
+        triggers += 512 + 16 + 1 + kVerificationReads;
+        report += delay_dbg + bitslip_dbg;
+
+        bool verification_ok = matched;
+        report += "  VERIFY_SCAN:";
+        for (uint32_t i = 0; i < kVerificationReads; ++i) {
+          daphne.getFrontEnd()->doTrigger();
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          const uint32_t verify_word = daphne.getSpyBuffer()->getFrameClock(afe_block, 0);
+          report += " [" + std::to_string(i) + "]=0x" +
+                    [&]() {
+                      std::ostringstream os;
+                      os << std::hex << std::uppercase << verify_word;
+                      return os.str();
+                    }();
+          if (verify_word != kExpectedFclkWord) {
+            verification_ok = false;
+          }
+        }
+        report += "\n";
 
-      if (!matched || aligned_word != kExpectedFclkWord || !verification_ok) {
-        failures.push_back(
-            "AFE_" + std::to_string(afe_block) +
-            " did not converge to stable 0x00FF00FF alignment.");
+        if (!matched || aligned_word != kExpectedFclkWord || !verification_ok) {
+          failures.push_back(
+              "AFE_" + std::to_string(afe_block) +
+              " did not converge to stable 0x00FF00FF alignment.");
+        }
+      }
+    } else if (!from_cache) {
+      // All AFEs scanned together (coarse-to-fine delay, shared bitslip steps),
+      // then verified together.
+      uint32_t scan_triggers = 0;
+      const std::array<AfeAlignment, afe_num> aligned = daphne.alignAllAfes(512, 16, &scan_triggers);
+      triggers += scan_triggers + kVerificationReads;
+      std::array<bool, afe_num> verification_ok{};
+      std::array<std::string, afe_num> verify_dbg;
+      for (uint32_t afe_block = 0; afe_block < afe_num; ++afe_block) {
+        verification_ok[afe_block] = aligned[afe_block].matched;
+      }
+      verify_all_afes(daphne, kVerificationReads, verification_ok, verify_dbg);
+      for (uint32_t afe_block = 0; afe_block < afe_num; ++afe_block) {
+        report += aligned[afe_block].report + verify_dbg[afe_block] + "\n";
+        if (!aligned[afe_block].matched || aligned[afe_block].word != kExpectedFclkWord ||
+            !verification_ok[afe_block]) {
+          failures.push_back(
+              "AFE_" + std::to_string(afe_block) +
+              " did not converge to stable 0x00FF00FF alignment.");
+        }
       }
     }
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t_start).count();
 
     response.clear_delay();
     response.clear_bitslip();
@@ -1015,8 +1473,28 @@ bool alignAFE(const cmd_alignAFEs&,
       report += "AFE_" + std::to_string(afe_block) + "\nDELAY: " + std::to_string(delay[afe_block]) +
                 "\nBITSLIP: " + std::to_string(bitslip[afe_block]) + "\n";
     }
+    response.set_from_cache(from_cache);
+
+    if (cache && !from_cache && failures.empty()) {
+      AlignmentCacheEntry entry;
+      entry.key = cache_key;
+      for (uint32_t afe_block = 0; afe_block < afe_num; ++afe_block) {
+        entry.delay[afe_block] = delay[afe_block];
+        entry.bitslip[afe_block] = bitslip[afe_block];
+      }
+      entry.timestamp_ns = MonitoringHistory::nowNs();
+      if (!cache->store(entry)) {
+        report += "ALIGN_CACHE: could not write " + cache->getPath() + "\n";
+      }
+    }
+
+    report += "ALIGN_STATS: mode=" + mode + ", triggers=" + std::to_string(triggers) +
+              ", elapsed_ms=" + std::to_string(elapsed_ms) + "\n";
 
     daphne.getFrontEnd()->setEnableDelayVtc(1);
+    daphne.getMonitoringHistory()->pushEvent(
+        "align", failures.empty() ? std::string(from_cache ? "Alignment restored from cache." : "Full alignment OK.")
+                                  : "Full alignment failed for " + std::to_string(failures.size()) + " AFE(s).");
     if (!failures.empty()) {
       response_str = "AFE alignment failed.\n";
       for (const auto& failure : failures) {
@@ -1041,9 +1519,26 @@ bool writeAFEFunction(const cmd_writeAFEFunction& request,
   try {
     uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(request.afeblock());
     if (afe_block > 4) throw std::invalid_argument("AFE out of range (0..4)");
-    const std::string afe_function_name = request.function();
+    AfeFunction function;
+    if (request.functionid() != daphne::AFE_FN_UNSPECIFIED) {
+      const uint32_t index = static_cast<uint32_t>(request.functionid()) - 1;
+      if (index >= afe_definitions::afeFunctionTable.size()) {
+        throw std::invalid_argument("Unknown AFE function id " + std::to_string(request.functionid()));
+      }
+      function = static_cast<AfeFunction>(index);
+    } else {
+      const auto found = afe_definitions::findAfeFunction(request.function());
+      if (!found) {
+        throw std::invalid_argument("AFE function name " + request.function() +
+                                    " not found in the AFE functions dictionary.");
+      }
+      function = *found;
+    }
+    const std::string afe_function_name = afe_definitions::afeFunctionInfo(function).name;
     const uint32_t conf_value = request.configvalue();
-    const uint32_t returned = daphne.getAfe()->setAFEFunction(afe_block, afe_function_name, conf_value);
+    if (conf_value > 0xFFFF) throw std::invalid_argument("Value out of range for AFE function " + afe_function_name);
+    const uint32_t returned = daphne.getAfe()->setAFEFunction(afe_block, function, static_cast<uint16_t>(conf_value));
+    daphne.setAfeFunctionDictValue(afe_block, function, conf_value);
     response.set_function(afe_function_name);
     response.set_configvalue(returned);
     response.set_afeblock(afe_block);
@@ -1064,6 +1559,7 @@ bool setAFEReset(const cmd_setAFEReset& request,
   try {
     const bool reset_value = request.resetvalue();
     const uint32_t returned = daphne.getAfe()->setReset(static_cast<uint32_t>(reset_value));
+    daphne.clearAfeFunctionDictValues();
     response.set_resetvalue(returned);
     response_str = "AFEs reset register written with value " + std::to_string(reset_value) +
                    ". Returned value: " + std::to_string(returned) + ".";
@@ -1080,6 +1576,7 @@ bool doAFEReset(const cmd_doAFEReset&,
                std::string& response_str) {
   try {
     (void)daphne.getAfe()->doReset();
+    daphne.clearAfeFunctionDictValues();
     response_str = "AFEs doreset command successful.";
     return true;
   } catch (const std::exception& e) {
@@ -1095,6 +1592,7 @@ bool setAFEPowerState(const cmd_setAFEPowerState& request,
   try {
     const bool power_state_value = request.powerstate();
     const uint32_t returned = daphne.getAfe()->setPowerState(static_cast<uint32_t>(power_state_value));
+    daphne.clearAfeFunctionDictValues();
     response.set_powerstate(returned);
     response_str = "AFEs powerstate register written with value " + std::to_string(power_state_value) +
                    ". Returned value: " + std::to_string(returned) + ".";
@@ -1110,6 +1608,7 @@ bool doSoftwareTrigger(const cmd_doSoftwareTrigger&,
                        Daphne& daphne,
                        std::string& response_str) {
   try {
+    ClientAcquisitionGuard acquisition(daphne);
     daphne.getFrontEnd()->doTrigger();
     response_str = "Software trigger executed.";
     return true;
@@ -1124,13 +1623,8 @@ bool readBiasVoltageMonitor(const cmd_readBiasVoltageMonitor& request,
                             Daphne& daphne,
                             std::string& response_msg) {
   const uint32_t afe_block = request.afeblock();
-  const std::array<double, 5> biases = {
-      daphne._VBIAS_0_voltage.load(),
-      daphne._VBIAS_1_voltage.load(),
-      daphne._VBIAS_2_voltage.load(),
-      daphne._VBIAS_3_voltage.load(),
-      daphne._VBIAS_4_voltage.load(),
-  };
+  const MonitoringSnapshot monitor = daphne.getMonitoringSnapshot();
+  const std::array<double, 5>& biases = monitor.vBias;
 
   if (afe_block >= biases.size()) {
     response_msg = "AFE block out of range (0..4)";
@@ -1143,11 +1637,11 @@ bool readBiasVoltageMonitor(const cmd_readBiasVoltageMonitor& request,
 
   std::ostringstream oss;
   oss << std::fixed << std::setprecision(5);
-  oss << "3V3PDS:" << daphne._3V3PDS_voltage.load() << " V, "
-      << "1V8PDS:" << daphne._1V8PDS_voltage.load() << " V. "
-      << "3V3A:" << daphne._3V3A_voltage.load() << " V, "
-      << "1V8A:" << daphne._1V8A_voltage.load() << " V, "
-      << "-5VA:" << daphne._n5VA_voltage.load() << " V. "
+  oss << "3V3PDS:" << monitor.v3V3PDS << " V, "
+      << "1V8PDS:" << monitor.v1V8PDS << " V. "
+      << "3V3A:" << monitor.v3V3A << " V, "
+      << "1V8A:" << monitor.v1V8A << " V, "
+      << "-5VA:" << monitor.vn5VA << " V. "
       << "BIAS0:" << biases[0] << " V, "
       << "BIAS1:" << biases[1] << " V, "
       << "BIAS2:" << biases[2] << " V, "
@@ -1158,53 +1652,439 @@ bool readBiasVoltageMonitor(const cmd_readBiasVoltageMonitor& request,
   return true;
 }
 
-// --------------HD Mezzanine helper functions-------------------------
+bool readPedestalHistory(const ReadPedestalHistoryRequest& request,
+                         ReadPedestalHistoryResponse& response,
+                         Daphne& daphne,
+                         std::string& response_str) {
+  try {
+    std::vector<uint32_t> chs(request.channels().begin(), request.channels().end());
+    if (chs.empty()) {
+      chs.resize(40);
+      std::iota(chs.begin(), chs.end(), 0);
+    }
+    for (const auto ch : chs) {
+      if (ch > 39) throw std::invalid_argument("channel out of range (0..39)");
+    }
+    uint32_t max_buckets = request.max_buckets() == 0 ? 64 : request.max_buckets();
+    max_buckets = std::min<uint32_t>(max_buckets, 4096);
+
+    const auto records = daphne.getMonitoringHistory()->getPedestalHistory(request.since_ns());
+    const size_t n = records.size();
+    response.set_total_records(static_cast<uint32_t>(n));
+    for (const auto ch : chs) response.add_channels(ch);
+
+    auto fill = [](MinMaxAvg* out, double lo, double hi, double sum, size_t count) {
+      out->set_min(lo);
+      out->set_max(hi);
+      out->set_avg(sum / static_cast<double>(count));
+    };
+
+    // Consecutive records are grouped so that at most max_buckets buckets are returned.
+    const size_t per_bucket = n == 0 ? 1 : (n + max_buckets - 1) / max_buckets;
+    for (size_t first = 0; first < n; first += per_bucket) {
+      const size_t last = std::min(n, first + per_bucket);
+      auto* bucket = response.add_buckets();
+      bucket->set_t_start_ns(records[first].timestamp_ns);
+      bucket->set_t_end_ns(records[last - 1].timestamp_ns);
+      bucket->set_n_records(static_cast<uint32_t>(last - first));
+      for (const auto ch : chs) {
+        std::array<double, 3> lo{};
+        std::array<double, 3> hi{};
+        std::array<double, 3> sum{};
+        lo.fill(std::numeric_limits<double>::max());
+        hi.fill(std::numeric_limits<double>::lowest());
+        for (size_t r = first; r < last; ++r) {
+          const std::array<double, 3> v = {records[r].mean[ch], records[r].ac_rms[ch], records[r].p2p[ch]};
+          for (size_t k = 0; k < v.size(); ++k) {
+            lo[k] = std::min(lo[k], v[k]);
+            hi[k] = std::max(hi[k], v[k]);
+            sum[k] += v[k];
+          }
+        }
+        auto* c = bucket->add_channels();
+        c->set_channel(ch);
+        fill(c->mutable_mean_counts(), lo[0], hi[0], sum[0], last - first);
+        fill(c->mutable_ac_rms_counts(), lo[1], hi[1], sum[1], last - first);
+        fill(c->mutable_p2p_counts(), lo[2], hi[2], sum[2], last - first);
+      }
+    }
 
-bool setHDMezzBlockEnable(const cmd_setHDMezzBlockEnable& request,
-                          cmd_setHDMezzBlockEnable_response& response,
+    for (const auto ch : chs) {
+      double sum = 0.0;
+      double sum_sq = 0.0;
+      for (const auto& r : records) {
+        sum += r.mean[ch];
+        sum_sq += static_cast<double>(r.mean[ch]) * r.mean[ch];
+      }
+      const double mean = n ? sum / n : 0.0;
+      response.add_wf_mean_std_counts(n ? std::sqrt(std::max(0.0, sum_sq / n - mean * mean)) : 0.0);
+    }
+
+    response_str = std::to_string(n) + " pedestal records in " + std::to_string(response.buckets_size()) +
+                   " buckets (history capacity " +
+                   std::to_string(daphne.getMonitoringHistory()->getPedestalCapacity()) + ").";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error reading pedestal history: ") + e.what();
+    return false;
+  }
+}
+
+bool readFrameClockStatus(const ReadFrameClockStatusRequest& request,
+                          ReadFrameClockStatusResponse& response,
                           Daphne& daphne,
                           std::string& response_str) {
   try {
-    const uint32_t afeBlock = request.afeblock();
-    const bool enable = request.enable();
-    if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
-    if(!daphne.getHDMezzDriver()) throw std::runtime_error("HD mezzanine driver not initialized");
-    I2C2BusGuard bus_guard(daphne);
-    daphne.getHDMezzDriver()->enableAfeBlock(afeBlock, enable);
-    response.set_afeblock(afeBlock);
-    response.set_enable(enable);
-    response_str = "HD mezzanine block " + std::to_string(afeBlock) + " enable state set to " +
-                   std::to_string(enable) + ".";
+    auto* history = daphne.getMonitoringHistory();
+    const auto status = history->getFrameClockStatus();
+    uint32_t locked = 0;
+    for (uint32_t afe = 0; afe < status.size(); ++afe) {
+      const auto& st = status[afe];
+      auto* out = response.add_afes();
+      out->set_afe(afe);
+      out->set_locked(st.locked);
+      out->set_armed(st.armed);
+      out->set_last_word(st.last_word);
+      out->set_delay(st.delay);
+      out->set_bitslip(st.bitslip);
+      out->set_lock_quality(st.lock_quality);
+      out->set_checks(st.checks);
+      out->set_misses(st.misses);
+      out->set_realigns(st.realigns);
+      out->set_realign_failures(st.realign_failures);
+      out->set_last_check_ns(st.last_check_ns);
+      if (st.locked) ++locked;
+    }
+    for (const auto& event : history->getEvents(request.events_since_ns())) {
+      auto* out = response.add_events();
+      out->set_timestamp_ns(event.timestamp_ns);
+      out->set_source(event.source);
+      out->set_message(event.message);
+    }
+    response_str = std::to_string(locked) + "/" + std::to_string(status.size()) + " AFE frame clocks locked.";
     return true;
   } catch (const std::exception& e) {
-    response_str = std::string("Error setting HD mezzanine block enable state: ") + e.what();
+    response_str = std::string("Error reading frame-clock status: ") + e.what();
     return false;
   }
 }
 
-bool configureHDMezzBlock(const cmd_configureHDMezzBlock& request,
-                         cmd_configureHDMezzBlock_response& response,
-                         Daphne& daphne,
-                         std::string& response_str) {
+bool verifyAfeShadow(const VerifyAfeRequest& request,
+                     VerifyAfeResponse& response,
+                     Daphne& daphne,
+                     std::string& response_str) {
   try {
-    const uint32_t afeBlock = request.afeblock();
-    const float r_shunt_5V = request.r_shunt_5v();
-    const float r_shunt_3V3 = request.r_shunt_3v3();
-    const float max_current_5V_scale = request.max_current_5v_scale();
-    const float max_current_3V3_scale = request.max_current_3v3_scale();
-    const float max_current_5V_shutdown = request.max_current_5v_shutdown();
-    const float max_current_3V3_shutdown = request.max_current_3v3_shutdown();
-    if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
-    if(!daphne.getHDMezzDriver()) throw std::runtime_error("HD mezzanine driver not initialized");
-    I2C2BusGuard bus_guard(daphne);
-    daphne.getHDMezzDriver()->setRShunt(afeBlock, r_shunt_5V, "5V");
-    daphne.getHDMezzDriver()->setRShunt(afeBlock, r_shunt_3V3, "3V3");
-    daphne.getHDMezzDriver()->setMaxCurrentScale(afeBlock, max_current_5V_scale, "5V");
-    daphne.getHDMezzDriver()->setMaxCurrentScale(afeBlock, max_current_3V3_scale, "3V3");
-    daphne.getHDMezzDriver()->setMaxCurrentShutdown(afeBlock, max_current_5V_shutdown, "5V");
-    daphne.getHDMezzDriver()->setMaxCurrentShutdown(afeBlock, max_current_3V3_shutdown, "3V3");
-    daphne.getHDMezzDriver()->configureHdMezzAfeBlock(afeBlock);
-    response.set_afeblock(afeBlock);
+    std::vector<uint32_t> afe_boards(request.afe_blocks().begin(), request.afe_blocks().end());
+    if (afe_boards.empty()) afe_boards = {0, 1, 2, 3, 4};
+    uint32_t checked_total = 0;
+    for (const uint32_t afe_board : afe_boards) {
+      const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+      uint32_t checked = 0;
+      for (const auto& mismatch : daphne.getAfe()->verifyAfe(afe_pl, &checked)) {
+        auto* out = response.add_mismatches();
+        out->set_afe_block(afe_board);
+        out->set_reg_address(mismatch.registerAddr);
+        out->set_shadow_known(mismatch.shadowValue.has_value());
+        out->set_shadow_value(mismatch.shadowValue.value_or(0));
+        out->set_hardware_value(mismatch.hardwareValue);
+      }
+      checked_total += checked;
+    }
+    response.set_registers_checked(checked_total);
+    uint32_t stale = 0;
+    for (const auto& mismatch : response.mismatches()) {
+      if (mismatch.shadow_known()) ++stale;
+    }
+    response_str = std::to_string(checked_total) + " AFE registers read back; " + std::to_string(stale) +
+                   " differed from the shadow, " + std::to_string(response.mismatches_size() - stale) +
+                   " were not shadowed yet. The shadow now holds the read-back values.";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error verifying AFE registers: ") + e.what();
+    return false;
+  }
+}
+
+std::vector<uint32_t> requested_trigger_channels(const google::protobuf::RepeatedField<uint32_t>& channels) {
+  std::vector<uint32_t> chs(channels.begin(), channels.end());
+  if (chs.empty()) {
+    chs.resize(TriggerBlock::kNumChannels);
+    std::iota(chs.begin(), chs.end(), 0);
+  }
+  for (const auto ch : chs) {
+    if (ch >= TriggerBlock::kNumChannels) throw std::invalid_argument("channel out of range (0..39)");
+  }
+  return chs;
+}
+
+void fill_trigger_rate_sample(const TriggerCounterSample& sample,
+                              const std::vector<uint32_t>& chs,
+                              daphne::TriggerRateSample* out) {
+  out->set_timestamp_ns(sample.timestamp_ns);
+  out->set_monotonic_ns(sample.monotonic_ns);
+  out->set_interval_s(sample.interval_s);
+  for (const auto ch : chs) {
+    auto* rate = out->add_channels();
+    rate->set_channel(ch);
+    rate->set_record_count(sample.record[ch]);
+    rate->set_busy_count(sample.busy[ch]);
+    rate->set_full_count(sample.full[ch]);
+    rate->set_record_rate_hz(sample.record_rate[ch]);
+    rate->set_busy_rate_hz(sample.busy_rate[ch]);
+    rate->set_full_rate_hz(sample.full_rate[ch]);
+  }
+}
+
+bool readTriggerRates(const ReadTriggerRatesRequest& request,
+                      ReadTriggerRatesResponse& response,
+                      Daphne& daphne,
+                      std::string& response_str) {
+  try {
+    const std::vector<uint32_t> chs = requested_trigger_channels(request.channels());
+    TriggerCounterSample sample;
+    if (!daphne.getMonitoringHistory()->getLatestTriggerSample(sample)) {
+      response_str = "No trigger counter samples yet (sampler disabled or not started).";
+      return false;
+    }
+    fill_trigger_rate_sample(sample, chs, response.mutable_sample());
+    response_str = "OK";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error reading trigger rates: ") + e.what();
+    return false;
+  }
+}
+
+bool readTriggerHistory(const ReadTriggerHistoryRequest& request,
+                        ReadTriggerHistoryResponse& response,
+                        Daphne& daphne,
+                        std::string& response_str) {
+  try {
+    const std::vector<uint32_t> chs = requested_trigger_channels(request.channels());
+    auto* history = daphne.getMonitoringHistory();
+    const uint32_t max_samples = request.max_samples() == 0 ? 600 : request.max_samples();
+    response.set_capacity(static_cast<uint32_t>(history->getTriggerCapacity()));
+    const auto samples = history->getTriggerHistory(request.since_ns(), max_samples);
+    for (const auto& sample : samples) fill_trigger_rate_sample(sample, chs, response.add_samples());
+    response_str = std::to_string(samples.size()) + " trigger counter sample(s).";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error reading trigger history: ") + e.what();
+    return false;
+  }
+}
+
+bool calibrateThresholds(const CalibrateThresholdsRequest& request,
+                         CalibrateThresholdsResponse& response,
+                         Daphne& daphne,
+                         std::string& response_str) {
+  try {
+    response_str = calibrate_thresholds(request, daphne, response);
+    return true;
+  } catch (const std::exception& e) {
+    response.clear_results();
+    response_str = std::string("Error calibrating thresholds: ") + e.what();
+    return false;
+  }
+}
+
+bool writeTriggerConfig(const WriteTriggerConfigRequest& request,
+                        WriteTriggerConfigResponse& response,
+                        Daphne& daphne,
+                        std::string& response_str) {
+  try {
+    TriggerBlock* block = daphne.getTriggerBlock();
+    std::vector<std::pair<uint32_t, uint32_t>> thresholds;
+    for (const auto& threshold : request.thresholds()) {
+      if (threshold.threshold() > TriggerBlock::kThresholdMask) {
+        response_str = "Threshold out of 28-bit range for channel " + std::to_string(threshold.channel());
+        return false;
+      }
+      thresholds.emplace_back(threshold.channel(), static_cast<uint32_t>(threshold.threshold()));
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> templates;
+    for (const auto& template_ : request.templates()) {
+      if (template_.value() > TriggerBlock::kMatchingTemplateMask) {
+        response_str = "Matching trigger template " + std::to_string(template_.index()) + " out of 28-bit range";
+        return false;
+      }
+      templates.emplace_back(template_.index(), template_.value());
+    }
+
+    std::ostringstream errors;
+    for (const uint32_t ch : block->setThresholds(thresholds)) {
+      errors << " threshold[" << ch << "]";
+    }
+    if (request.set_enable_mask() && !block->setEnableMask(request.enable_mask())) errors << " enable_mask";
+    if (request.set_full_config() && !block->setFullConfig(request.full_config())) errors << " full_config";
+    for (const uint32_t index : block->setMatchingTemplates(templates)) {
+      errors << " template[" << index << "]";
+    }
+
+    for (const uint32_t threshold : block->getThresholds()) response.add_thresholds(threshold);
+    response.set_enable_mask(block->getEnableMask());
+    response.set_full_config(block->getFullConfig());
+    for (const uint32_t value : block->getMatchingTemplates()) response.add_templates(value);
+
+    if (!errors.str().empty()) {
+      response_str = "Trigger block read-back mismatch:" + errors.str();
+      return false;
+    }
+    response_str = "Trigger block: " + std::to_string(thresholds.size()) + " threshold(s), " +
+                   std::to_string(templates.size()) + " template(s) written.";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error writing trigger block: ") + e.what();
+    return false;
+  }
+}
+
+bool saveBoardState(const SaveStateRequest& request,
+                    SaveStateResponse& response,
+                    Daphne& daphne,
+                    std::string& response_str) {
+  try {
+    const std::string path = request.path().empty() ? default_board_state_path() : request.path();
+    response.set_path(path);
+    const BoardStateSnapshot snapshot = capture_board_state(daphne);
+    std::string error;
+    size_t bytes = 0;
+    if (!BoardStateFile::save(path, snapshot, error, &bytes)) {
+      response_str = "Error saving board state: " + error;
+      return false;
+    }
+    response.set_bytes(bytes);
+    response_str = "Board state saved to " + path + " (" + std::to_string(bytes) + " bytes).";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error saving board state: ") + e.what();
+    return false;
+  }
+}
+
+bool restoreBoardState(const RestoreStateRequest& request,
+                       RestoreStateResponse& response,
+                       Daphne& daphne,
+                       std::string& response_str) {
+  try {
+    const std::string path = request.path().empty() ? default_board_state_path() : request.path();
+    response.set_path(path);
+    std::string error;
+    const std::optional<BoardStateSnapshot> snapshot = BoardStateFile::load(path, error);
+    if (!snapshot) {
+      response_str = "Error loading board state: " + error;
+      return false;
+    }
+    const BoardStateRestoreReport report = restore_board_state(*snapshot, daphne);
+    response.set_elapsed_us(report.elapsed_us);
+    response.set_afe_registers(report.afe_registers);
+    response.set_afe_register_mismatches(report.afe_register_mismatches);
+    response.set_frontend_rewritten(report.frontend_rewritten);
+    response_str = report.text + "Restored from " + path + " in " + std::to_string(report.elapsed_us) + " us.";
+    return report.ok;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error restoring board state: ") + e.what();
+    return false;
+  }
+}
+
+bool readBusWaitStats(const ReadBusWaitStatsRequest&,
+                      ReadBusWaitStatsResponse& response,
+                      Daphne& daphne,
+                      std::string& response_str) {
+  try {
+    uint64_t completions = 0;
+    uint64_t timeouts = 0;
+    for (const auto& stats : CompletionWaiter::getAllStats()) {
+      auto* out = response.add_devices();
+      out->set_device(stats.device);
+      out->set_completions(stats.completions);
+      out->set_timeouts(stats.timeouts);
+      out->set_p50_ns(stats.p50_ns);
+      out->set_p99_ns(stats.p99_ns);
+      out->set_max_ns(stats.max_ns);
+      out->set_timeout_ns(stats.timeout_ns);
+      for (const auto count : stats.histogram) out->add_histogram(count);
+      completions += stats.completions;
+      timeouts += stats.timeouts;
+    }
+    uint64_t i2c_transactions = 0;
+    for (auto* bus : {daphne.getI2C1Bus(), daphne.getI2C2Bus()}) {
+      for (const auto& stats : bus->getStats()) {
+        auto* out = response.add_i2c_queues();
+        out->set_bus(bus->getName());
+        out->set_priority(stats.priority);
+        out->set_completed(stats.completed);
+        out->set_failed(stats.failed);
+        out->set_depth(stats.depth);
+        out->set_max_depth(stats.maxDepth);
+        out->set_wait_p50_ns(stats.waitP50_ns);
+        out->set_wait_p99_ns(stats.waitP99_ns);
+        out->set_wait_max_ns(stats.waitMax_ns);
+        out->set_run_mean_ns(stats.runMean_ns);
+        out->set_run_max_ns(stats.runMax_ns);
+        for (const auto count : stats.waitHistogram) out->add_wait_histogram(count);
+        i2c_transactions += stats.completed + stats.failed;
+      }
+    }
+    response_str = std::to_string(response.devices_size()) + " busy devices, " + std::to_string(completions) +
+                   " completions, " + std::to_string(timeouts) + " timeouts; " + std::to_string(i2c_transactions) +
+                   " I2C transactions.";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error reading bus wait statistics: ") + e.what();
+    return false;
+  }
+}
+
+// --------------HD Mezzanine helper functions-------------------------
+
+bool setHDMezzBlockEnable(const cmd_setHDMezzBlockEnable& request,
+                          cmd_setHDMezzBlockEnable_response& response,
+                          Daphne& daphne,
+                          std::string& response_str) {
+  try {
+    const uint32_t afeBlock = request.afeblock();
+    const bool enable = request.enable();
+    if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
+    if(!daphne.getHDMezzDriver()) throw std::runtime_error("HD mezzanine driver not initialized");
+    daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser,
+                             [&] { daphne.getHDMezzDriver()->enableAfeBlock(afeBlock, enable); });
+    response.set_afeblock(afeBlock);
+    response.set_enable(enable);
+    response_str = "HD mezzanine block " + std::to_string(afeBlock) + " enable state set to " +
+                   std::to_string(enable) + ".";
+    return true;
+  } catch (const std::exception& e) {
+    response_str = std::string("Error setting HD mezzanine block enable state: ") + e.what();
+    return false;
+  }
+}
+
+bool configureHDMezzBlock(const cmd_configureHDMezzBlock& request,
+                         cmd_configureHDMezzBlock_response& response,
+                         Daphne& daphne,
+                         std::string& response_str) {
+  try {
+    const uint32_t afeBlock = request.afeblock();
+    const float r_shunt_5V = request.r_shunt_5v();
+    const float r_shunt_3V3 = request.r_shunt_3v3();
+    const float max_current_5V_scale = request.max_current_5v_scale();
+    const float max_current_3V3_scale = request.max_current_3v3_scale();
+    const float max_current_5V_shutdown = request.max_current_5v_shutdown();
+    const float max_current_3V3_shutdown = request.max_current_3v3_shutdown();
+    if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
+    if(!daphne.getHDMezzDriver()) throw std::runtime_error("HD mezzanine driver not initialized");
+    daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser, [&] {
+      daphne.getHDMezzDriver()->setRShunt(afeBlock, r_shunt_5V, "5V");
+      daphne.getHDMezzDriver()->setRShunt(afeBlock, r_shunt_3V3, "3V3");
+      daphne.getHDMezzDriver()->setMaxCurrentScale(afeBlock, max_current_5V_scale, "5V");
+      daphne.getHDMezzDriver()->setMaxCurrentScale(afeBlock, max_current_3V3_scale, "3V3");
+      daphne.getHDMezzDriver()->setMaxCurrentShutdown(afeBlock, max_current_5V_shutdown, "5V");
+      daphne.getHDMezzDriver()->setMaxCurrentShutdown(afeBlock, max_current_3V3_shutdown, "3V3");
+      daphne.getHDMezzDriver()->configureHdMezzAfeBlock(afeBlock);
+    });
+    response.set_afeblock(afeBlock);
     response.set_r_shunt_5v(r_shunt_5V);
     response.set_r_shunt_3v3(r_shunt_3V3);
     response.set_max_current_5v_scale(max_current_5V_scale);
@@ -1230,20 +2110,21 @@ bool readHDMezzBlockConfig(const cmd_readHDMezzBlockConfig& request,
     const uint32_t afeBlock = request.afeblock();
     if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
     if(!daphne.getHDMezzDriver()) throw std::runtime_error("HD mezzanine driver not initialized");
-    I2C2BusGuard bus_guard(daphne);
     response.set_afeblock(afeBlock);
-    response.set_r_shunt_5v(daphne.getHDMezzDriver()->getRShunt(afeBlock, "5V"));
-    response.set_r_shunt_3v3(daphne.getHDMezzDriver()->getRShunt(afeBlock, "3V3"));
-    response.set_max_current_5v_scale(daphne.getHDMezzDriver()->getMaxCurrentScale(afeBlock, "5V"));
-    response.set_max_current_3v3_scale(daphne.getHDMezzDriver()->getMaxCurrentScale(afeBlock, "3V3"));
-    response.set_max_current_5v_shutdown(daphne.getHDMezzDriver()->getMaxCurrentShutdown(afeBlock, "5V"));
-    response.set_max_current_3v3_shutdown(daphne.getHDMezzDriver()->getMaxCurrentShutdown(afeBlock, "3V3"));
-    response.set_max_power_5v(daphne.getHDMezzDriver()->getMaxPower(afeBlock, "5V"));
-    response.set_max_power_3v3(daphne.getHDMezzDriver()->getMaxPower(afeBlock, "3V3"));
-    response.set_current_lsb_5v(daphne.getHDMezzDriver()->getCurrentLsb(afeBlock, "5V"));
-    response.set_current_lsb_3v3(daphne.getHDMezzDriver()->getCurrentLsb(afeBlock, "3V3"));
-    response.set_shunt_cal_5v(daphne.getHDMezzDriver()->getShuntCal(afeBlock, "5V"));
-    response.set_shunt_cal_3v3(daphne.getHDMezzDriver()->getShuntCal(afeBlock, "3V3"));
+    daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser, [&] {
+      response.set_r_shunt_5v(daphne.getHDMezzDriver()->getRShunt(afeBlock, "5V"));
+      response.set_r_shunt_3v3(daphne.getHDMezzDriver()->getRShunt(afeBlock, "3V3"));
+      response.set_max_current_5v_scale(daphne.getHDMezzDriver()->getMaxCurrentScale(afeBlock, "5V"));
+      response.set_max_current_3v3_scale(daphne.getHDMezzDriver()->getMaxCurrentScale(afeBlock, "3V3"));
+      response.set_max_current_5v_shutdown(daphne.getHDMezzDriver()->getMaxCurrentShutdown(afeBlock, "5V"));
+      response.set_max_current_3v3_shutdown(daphne.getHDMezzDriver()->getMaxCurrentShutdown(afeBlock, "3V3"));
+      response.set_max_power_5v(daphne.getHDMezzDriver()->getMaxPower(afeBlock, "5V"));
+      response.set_max_power_3v3(daphne.getHDMezzDriver()->getMaxPower(afeBlock, "3V3"));
+      response.set_current_lsb_5v(daphne.getHDMezzDriver()->getCurrentLsb(afeBlock, "5V"));
+      response.set_current_lsb_3v3(daphne.getHDMezzDriver()->getCurrentLsb(afeBlock, "3V3"));
+      response.set_shunt_cal_5v(daphne.getHDMezzDriver()->getShuntCal(afeBlock, "5V"));
+      response.set_shunt_cal_3v3(daphne.getHDMezzDriver()->getShuntCal(afeBlock, "3V3"));
+    });
     response_str = "HD mezzanine block " + std::to_string(afeBlock) + " configuration read successfully.";
     return true;
   } catch (const std::exception& e) {
@@ -1263,9 +2144,10 @@ bool setHDMezzPowerStates(const cmd_setHDMezzPowerStates& request,
     const bool power_5v = request.power5v();
     const bool power_3v3 = request.power3v3();
     if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
-    I2C2BusGuard bus_guard(daphne);
-    daphne.getHDMezzDriver()->powerOn_HDMezzAfeBlock(afeBlock, power_5v, "5V");
-    daphne.getHDMezzDriver()->powerOn_HDMezzAfeBlock(afeBlock, power_3v3, "3V3");
+    daphne.getI2C2Bus()->run(I2CBusExecutor::Priority::kUser, [&] {
+      daphne.getHDMezzDriver()->powerOn_HDMezzAfeBlock(afeBlock, power_5v, "5V");
+      daphne.getHDMezzDriver()->powerOn_HDMezzAfeBlock(afeBlock, power_3v3, "3V3");
+    });
     response.set_afeblock(afeBlock);
     response.set_power5v(power_5v);
     response.set_power3v3(power_3v3);
@@ -1287,16 +2169,17 @@ bool readHDMezzStatus(const cmd_readHDMezzStatus& request,
     if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
     if(!daphne.getHDMezzDriver()) throw std::runtime_error("HD mezzanine driver not initialized");
     response.set_afeblock(afeBlock);
-    response.set_power5v(daphne.HDMezz_5V_is_powered[afeBlock].load());
-    response.set_power3v3(daphne.HDMezz_3V3_is_powered[afeBlock].load());
-    response.set_measured_voltage5v(daphne.HDMezz_5V_voltage[afeBlock].load());
-    response.set_measured_voltage3v3(daphne.HDMezz_3V3_voltage[afeBlock].load());
-    response.set_measured_current5v(daphne.HDMezz_5V_current[afeBlock].load());
-    response.set_measured_current3v3(daphne.HDMezz_3V3_current[afeBlock].load());
-    response.set_measured_power5v(daphne.HDMezz_5V_power[afeBlock].load());
-    response.set_measured_power3v3(daphne.HDMezz_3V3_power[afeBlock].load());
-    response.set_alert_5v(daphne.HDMezz_5V_alert[afeBlock].load());
-    response.set_alert_3v3(daphne.HDMezz_3V3_alert[afeBlock].load());
+    const HDMezzRails rails = daphne.getMonitoringSnapshot().hdmezz[afeBlock];
+    response.set_power5v(rails.powered5V);
+    response.set_power3v3(rails.powered3V3);
+    response.set_measured_voltage5v(rails.voltage5V);
+    response.set_measured_voltage3v3(rails.voltage3V3);
+    response.set_measured_current5v(rails.current5V);
+    response.set_measured_current3v3(rails.current3V3);
+    response.set_measured_power5v(rails.power5V);
+    response.set_measured_power3v3(rails.power3V3);
+    response.set_alert_5v(rails.alert5V);
+    response.set_alert_3v3(rails.alert3V3);
     response_str = "HD mezzanine block " + std::to_string(afeBlock) + " status read successfully.";
     return true;
   } catch (const std::exception& e) {
@@ -1313,9 +2196,12 @@ bool clearHDMezzAlertFlag(const cmd_clearHDMezzAlertFlag& request,
     const uint32_t afeBlock = request.afeblock();
     if (afeBlock > 4) throw std::invalid_argument("HD mezzanine block out of range (0..4)");
     if(!daphne.getHDMezzDriver()) throw std::runtime_error("HD mezzanine driver not initialized");
-    I2C2BusGuard bus_guard(daphne);
-    daphne.HDMezz_5V_alert[afeBlock].store(false);
-    daphne.HDMezz_3V3_alert[afeBlock].store(false);
+    // The monitor latches alerts against the published snapshot, so clearing
+    // them there is enough; no bus access needed.
+    daphne.updateMonitoringSnapshot([afeBlock](MonitoringSnapshot& snapshot) {
+      snapshot.hdmezz[afeBlock].alert5V = false;
+      snapshot.hdmezz[afeBlock].alert3V3 = false;
+    });
     response.set_afeblock(afeBlock);
     response_str = "HD mezzanine block " + std::to_string(afeBlock) + " alert flags cleared.";
     return true;
@@ -1347,18 +2233,48 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
   std::unordered_map<MessageTypeV2, V2Handler> handlers;
 
   handlers[daphne::MT2_CONFIGURE_FE_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
-    ConfigureRequest req;
     ConfigureResponse resp;
-    if (!req.ParseFromString(in)) {
-      resp.set_success(false);
-      resp.set_message("Bad ConfigureRequest payload");
-      out = serialize_or_empty(resp);
-      return;
+
+    // A payload configured before replays its compiled plan: no parsing, no
+    // validation and a per-step summary instead of the full report.
+    std::shared_ptr<const ConfigurePlan> plan = configure_plan_cache().find(in);
+    const bool cached = (plan != nullptr);
+    if (!plan) {
+      ConfigureRequest req;
+      if (!req.ParseFromString(in)) {
+        resp.set_success(false);
+        resp.set_message("Bad ConfigureRequest payload");
+        out = serialize_or_empty(resp);
+        return;
+      }
+      try {
+        plan = configure_plan_cache().insert(in, compile_configure_plan(req));
+      } catch (const std::exception& e) {
+        resp.set_success(false);
+        resp.set_message(std::string("Caught Exception:\n") + e.what());
+        out = serialize_or_empty(resp);
+        return;
+      }
     }
 
     std::string msg;
-    bool ok = configureDaphne(req, d, msg);
-    if (ok && auto_align_enabled()) {
+    ConfigureOutcome outcome;
+    bool ok = configurePlan(*plan, d, !cached, msg, outcome);
+    resp.set_applied_ops(outcome.applied_ops);
+    resp.set_skipped_ops(outcome.skipped_ops);
+    resp.set_frontend_reset(outcome.frontend_reset);
+    resp.set_plan_cached(cached);
+    for (const ConfigureStep& step : outcome.steps) {
+      auto* status = resp.add_steps();
+      status->set_step(step.name);
+      status->set_success(step.ok);
+      status->set_applied(step.applied);
+      status->set_skipped(step.skipped);
+      status->set_error(step.error);
+    }
+    if (ok && plan->delta && !outcome.frontend_reset) {
+      msg += "\n\n[ALIGN_AFE] skipped (delta configure, no AFE reset)";
+    } else if (ok && auto_align_enabled()) {
       cmd_alignAFEs a_req;
       cmd_alignAFEs_response a_resp;
       std::string align_msg;
@@ -1394,7 +2310,7 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
     out = serialize_or_empty(resp);
   };
 
-  handlers[daphne::MT2_READ_TRIGGER_COUNTERS_REQ] = [](const std::string& in, std::string& out, Daphne&) {
+  handlers[daphne::MT2_READ_TRIGGER_COUNTERS_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
     ReadTriggerCountersRequest req;
     ReadTriggerCountersResponse resp;
     if (!req.ParseFromString(in)) {
@@ -1412,11 +2328,13 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
       chs.assign(req.channels().begin(), req.channels().end());
     }
 
-    uint32_t base = trigregs::PHYS_BASE;
-    if (req.base_addr() != 0) base = static_cast<uint32_t>(req.base_addr());
-
     std::string err;
-    const bool ok = read_counters_raw(base, chs, resp, err);
+    bool ok = true;
+    if (req.base_addr() == 0 || req.base_addr() == TriggerBlock::kThresholdBase) {
+      ok = read_counters_block(*d.getTriggerBlock(), chs, resp, err);
+    } else {
+      ok = read_counters_raw(static_cast<uint32_t>(req.base_addr()), chs, resp, err);
+    }
     resp.set_success(ok);
     resp.set_message(ok ? "OK" : (std::string("Counters read error: ") + err));
     out = serialize_or_empty(resp);
@@ -1438,14 +2356,219 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
     }
 
     GeneralInfo resp;
-    resp.set_v_bias_0(d._VBIAS_0_voltage.load());
-    resp.set_v_bias_1(d._VBIAS_1_voltage.load());
-    resp.set_v_bias_2(d._VBIAS_2_voltage.load());
-    resp.set_v_bias_3(d._VBIAS_3_voltage.load());
-    resp.set_v_bias_4(d._VBIAS_4_voltage.load());
-    resp.set_power_minus5v(d._n5VA_voltage.load());
-    resp.set_power_plus2p5v(d._3V3PDS_voltage.load());
-    resp.set_power_ce(d._1V8A_voltage.load());
+    const MonitoringSnapshot monitor = d.getMonitoringSnapshot();
+    resp.set_v_bias_0(monitor.vBias[0]);
+    resp.set_v_bias_1(monitor.vBias[1]);
+    resp.set_v_bias_2(monitor.vBias[2]);
+    resp.set_v_bias_3(monitor.vBias[3]);
+    resp.set_v_bias_4(monitor.vBias[4]);
+    resp.set_power_minus5v(monitor.vn5VA);
+    resp.set_power_plus2p5v(monitor.v3V3PDS);
+    resp.set_power_ce(monitor.v1V8A);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_READ_MONITORING_SNAPSHOT_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadMonitoringSnapshotRequest req;
+    ReadMonitoringSnapshotResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadMonitoringSnapshotRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readMonitoringSnapshot(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_READ_METRIC_SERIES_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadMetricSeriesRequest req;
+    ReadMetricSeriesResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadMetricSeriesRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readMetricSeries(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_READ_PEDESTAL_HISTORY_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadPedestalHistoryRequest req;
+    ReadPedestalHistoryResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadPedestalHistoryRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readPedestalHistory(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_READ_FRAME_CLOCK_STATUS_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadFrameClockStatusRequest req;
+    ReadFrameClockStatusResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadFrameClockStatusRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readFrameClockStatus(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_VERIFY_AFE_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    VerifyAfeRequest req;
+    VerifyAfeResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad VerifyAfeRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = verifyAfeShadow(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_READ_TRIGGER_RATES_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadTriggerRatesRequest req;
+    ReadTriggerRatesResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadTriggerRatesRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readTriggerRates(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_READ_TRIGGER_HISTORY_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadTriggerHistoryRequest req;
+    ReadTriggerHistoryResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadTriggerHistoryRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readTriggerHistory(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_CALIBRATE_THRESHOLDS_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    CalibrateThresholdsRequest req;
+    CalibrateThresholdsResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad CalibrateThresholdsRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = calibrateThresholds(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_WRITE_TRIGGER_CONFIG_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    WriteTriggerConfigRequest req;
+    WriteTriggerConfigResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad WriteTriggerConfigRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = writeTriggerConfig(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_SAVE_STATE_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    SaveStateRequest req;
+    SaveStateResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad SaveStateRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = saveBoardState(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_RESTORE_STATE_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    RestoreStateRequest req;
+    RestoreStateResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad RestoreStateRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = restoreBoardState(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_READ_BUS_WAIT_STATS_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadBusWaitStatsRequest req;
+    ReadBusWaitStatsResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadBusWaitStatsRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readBusWaitStats(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
     out = serialize_or_empty(resp);
   };
 
@@ -1619,6 +2742,23 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
     out = serialize_or_empty(resp);
   };
 
+  handlers[daphne::MT2_READ_FULL_FE_STATE_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    ReadFullFeStateRequest req;
+    ReadFullFeStateResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad ReadFullFeStateRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = readFullFeState(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
   handlers[daphne::MT2_WRITE_AFE_REG_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
     cmd_writeAFEReg req;
     cmd_writeAFEReg_response resp;
@@ -1721,10 +2861,12 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
 
     try {
       if (req.trimvalue() > 4095) throw std::invalid_argument("trimValue out of range (0..4095)");
-      for (uint32_t ch = 0; ch < 40; ++ch) {
-        const uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(ch / 8);
-        d.getDac()->setDacTrim(afe_block, ch % 8, req.trimvalue(), req.trimgain(), false);
-        d.setChTrimDictValue(ch, req.trimvalue());
+      std::array<uint32_t, 8> values;
+      values.fill(req.trimvalue());
+      for (uint32_t afe_board = 0; afe_board < 5; ++afe_board) {
+        const uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(afe_board);
+        d.getDac()->setTrims(afe_block, values, req.trimgain(), false);
+        for (uint32_t idx = 0; idx < 8; ++idx) d.setChTrimDictValue(afe_board * 8 + idx, req.trimvalue());
       }
       resp.set_success(true);
       resp.set_message("OK");
@@ -1750,10 +2892,10 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
       const uint32_t afe_board = req.afeblock();
       if (afe_board > 4) throw std::invalid_argument("afeBlock out of range (0..4)");
       const uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(afe_board);
-      for (uint32_t idx = 0; idx < 8; ++idx) {
-        d.getDac()->setDacTrim(afe_block, idx, req.trimvalue(), req.trimgain(), false);
-        d.setChTrimDictValue(afe_board * 8 + idx, req.trimvalue());
-      }
+      std::array<uint32_t, 8> values;
+      values.fill(req.trimvalue());
+      d.getDac()->setTrims(afe_block, values, req.trimgain(), false);
+      for (uint32_t idx = 0; idx < 8; ++idx) d.setChTrimDictValue(afe_board * 8 + idx, req.trimvalue());
       resp.set_success(true);
       resp.set_message("OK");
     } catch (const std::exception& e) {
@@ -1795,10 +2937,12 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
 
     try {
       if (req.offsetvalue() > 4095) throw std::invalid_argument("offsetValue out of range (0..4095)");
-      for (uint32_t ch = 0; ch < 40; ++ch) {
-        const uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(ch / 8);
-        d.getDac()->setDacOffset(afe_block, ch % 8, req.offsetvalue(), req.offsetgain(), false);
-        d.setChOffsetDictValue(ch, req.offsetvalue());
+      std::array<uint32_t, 8> values;
+      values.fill(req.offsetvalue());
+      for (uint32_t afe_board = 0; afe_board < 5; ++afe_board) {
+        const uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(afe_board);
+        d.getDac()->setOffsets(afe_block, values, req.offsetgain(), false);
+        for (uint32_t idx = 0; idx < 8; ++idx) d.setChOffsetDictValue(afe_board * 8 + idx, req.offsetvalue());
       }
       resp.set_success(true);
       resp.set_message("OK");
@@ -1824,10 +2968,10 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
       const uint32_t afe_board = req.afeblock();
       if (afe_board > 4) throw std::invalid_argument("afeBlock out of range (0..4)");
       const uint32_t afe_block = afe_definitions::AFE_board2PL_map.at(afe_board);
-      for (uint32_t idx = 0; idx < 8; ++idx) {
-        d.getDac()->setDacOffset(afe_block, idx, req.offsetvalue(), req.offsetgain(), false);
-        d.setChOffsetDictValue(afe_board * 8 + idx, req.offsetvalue());
-      }
+      std::array<uint32_t, 8> values;
+      values.fill(req.offsetvalue());
+      d.getDac()->setOffsets(afe_block, values, req.offsetgain(), false);
+      for (uint32_t idx = 0; idx < 8; ++idx) d.setChOffsetDictValue(afe_board * 8 + idx, req.offsetvalue());
       resp.set_success(true);
       resp.set_message("OK");
     } catch (const std::exception& e) {
@@ -1874,6 +3018,40 @@ std::unordered_map<daphne::MessageTypeV2, V2Handler> make_v2_handlers() {
     out = serialize_or_empty(resp);
   };
 
+  handlers[daphne::MT2_TUNE_PEDESTALS_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    TunePedestalsRequest req;
+    TunePedestalsResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad TunePedestalsRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = tunePedestals(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
+  handlers[daphne::MT2_COMMON_MODE_NOISE_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
+    CommonModeNoiseRequest req;
+    CommonModeNoiseResponse resp;
+    if (!req.ParseFromString(in)) {
+      resp.set_success(false);
+      resp.set_message("Bad CommonModeNoiseRequest payload");
+      out = serialize_or_empty(resp);
+      return;
+    }
+
+    std::string msg;
+    const bool ok = commonModeNoise(req, resp, d, msg);
+    resp.set_success(ok);
+    resp.set_message(msg);
+    out = serialize_or_empty(resp);
+  };
+
   handlers[daphne::MT2_ALIGN_AFE_REQ] = [](const std::string& in, std::string& out, Daphne& d) {
     cmd_alignAFEs req;
     cmd_alignAFEs_response resp;
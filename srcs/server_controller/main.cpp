@@ -1,5 +1,6 @@
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -7,10 +8,13 @@
 #include <zmq.hpp>
 
 #include "CLI/CLI.hpp"
+#include "BoardState.hpp"
 #include "Daphne.hpp"
+#include "server_controller/board_state.hpp"
 #include "server_controller/handlers.hpp"
 #include "server_controller/monitoring.hpp"
 #include "server_controller/router_server.hpp"
+#include "server_controller/telemetry.hpp"
 
 int main(int argc, char* argv[]) {
   CLI::App app{"daphneServer"};
@@ -18,13 +22,54 @@ int main(int argc, char* argv[]) {
   std::string bind_endpoint = "tcp://*:9876";
   bool disable_monitoring = false;
   int monitor_period_ms = 200;
+  int pedestal_period_s = 30;
+  uint32_t pedestal_waveforms = 4;
+  int fclk_watchdog_period_ms = 5000;
+  bool fclk_auto_realign = false;
+  uint32_t fclk_search_radius = 32;
+  int trigger_sample_period_ms = 1000;
+  std::string align_cache_path = "/var/tmp/daphne_alignment_cache.txt";
+  std::string state_file_path = daphne_sc::default_board_state_path();
+  std::string restore_state_path;
 
   daphne_sc::RouterServerOptions server_opts;
+  daphne_sc::TelemetryOptions telemetry_opts;
+  int telemetry_heartbeat_ms = static_cast<int>(telemetry_opts.heartbeat.count());
+  double telemetry_deadband_mv = telemetry_opts.voltage_deadband_v * 1000.0;
 
   app.add_option("--bind", bind_endpoint, "ZeroMQ bind endpoint")->default_val(bind_endpoint);
   app.add_flag("--disable-monitoring", disable_monitoring, "Disable background I2C monitoring threads");
   app.add_option("--monitor-period-ms", monitor_period_ms, "Monitoring period in milliseconds")
       ->default_val(monitor_period_ms);
+  app.add_option("--pedestal-period-s", pedestal_period_s,
+                 "Background pedestal snapshot period in seconds (0 disables)")
+      ->default_val(pedestal_period_s);
+  app.add_option("--pedestal-waveforms", pedestal_waveforms, "Waveforms per background pedestal snapshot")
+      ->default_val(pedestal_waveforms);
+  app.add_option("--fclk-watchdog-period-ms", fclk_watchdog_period_ms,
+                 "Frame-clock watchdog period in milliseconds (0 disables)")
+      ->default_val(fclk_watchdog_period_ms);
+  app.add_flag("--fclk-auto-realign", fclk_auto_realign,
+               "Let the frame-clock watchdog rewrite DELAY/BITSLIP of an AFE that lost lock");
+  app.add_option("--fclk-search-radius", fclk_search_radius, "Watchdog local delay search radius in taps")
+      ->default_val(fclk_search_radius);
+  app.add_option("--trigger-sample-period-ms", trigger_sample_period_ms,
+                 "Self-trigger counter sampling period in milliseconds (0 disables)")
+      ->default_val(trigger_sample_period_ms);
+  app.add_option("--align-cache", align_cache_path,
+                 "Alignment cache file (empty disables); cached DELAY/BITSLIP are verified before use")
+      ->default_val(align_cache_path);
+  app.add_option("--state-file", state_file_path, "Default board state file for save/restore requests")
+      ->default_val(state_file_path);
+  app.add_option("--restore-state", restore_state_path,
+                 "Restore a saved board state before serving requests (warm restart)");
+  app.add_option("--telemetry-bind", telemetry_opts.bind_endpoint,
+                 "ZeroMQ PUB endpoint for monitoring telemetry (empty disables)");
+  app.add_option("--telemetry-heartbeat-ms", telemetry_heartbeat_ms,
+                 "Republish unchanged telemetry topics after this many milliseconds (0: on change only)")
+      ->default_val(telemetry_heartbeat_ms);
+  app.add_option("--telemetry-deadband-mv", telemetry_deadband_mv, "Voltage change that triggers a publication")
+      ->default_val(telemetry_deadband_mv);
 
   app.add_option("--sndhwm", server_opts.sndhwm, "ZMQ SNDHWM")->default_val(server_opts.sndhwm);
   app.add_option("--rcvhwm", server_opts.rcvhwm, "ZMQ RCVHWM")->default_val(server_opts.rcvhwm);
@@ -40,20 +85,62 @@ int main(int argc, char* argv[]) {
 
   zmq::context_t context(1);
   Daphne daphne;
+  if (!align_cache_path.empty()) {
+    daphne.enableAlignmentCache(align_cache_path);
+  }
+  daphne_sc::set_default_board_state_path(state_file_path);
+  if (!restore_state_path.empty()) {
+    std::string error;
+    const auto snapshot = BoardStateFile::load(restore_state_path, error);
+    if (snapshot) {
+      const auto report = daphne_sc::restore_board_state(*snapshot, daphne);
+      std::cout << "Board state restore from " << restore_state_path << " (" << report.elapsed_us / 1000.0
+                << " ms, " << (report.ok ? "ok" : "with errors") << "):\n"
+                << report.text;
+    } else {
+      std::cerr << "Board state restore skipped: " << error << "\n";
+    }
+  }
+
+  std::unique_ptr<daphne_sc::TelemetryPublisher> telemetry;
+  if (!telemetry_opts.bind_endpoint.empty() && !disable_monitoring) {
+    telemetry_opts.heartbeat = std::chrono::milliseconds(telemetry_heartbeat_ms > 0 ? telemetry_heartbeat_ms : 0);
+    telemetry_opts.voltage_deadband_v = telemetry_deadband_mv / 1000.0;
+    telemetry = std::make_unique<daphne_sc::TelemetryPublisher>(context, telemetry_opts);
+  }
 
   std::vector<std::thread> monitor_threads;
   if (!disable_monitoring) {
     daphne_sc::MonitoringOptions opts;
     opts.period = std::chrono::milliseconds(monitor_period_ms);
+    opts.pedestal_period = std::chrono::seconds(pedestal_period_s > 0 ? pedestal_period_s : 0);
+    opts.pedestal_waveforms = pedestal_waveforms;
+    opts.fclk_watchdog_period = std::chrono::milliseconds(fclk_watchdog_period_ms > 0 ? fclk_watchdog_period_ms : 0);
+    opts.fclk_auto_realign = fclk_auto_realign;
+    opts.fclk_search_radius = fclk_search_radius;
+    opts.trigger_sample_period =
+        std::chrono::milliseconds(trigger_sample_period_ms > 0 ? trigger_sample_period_ms : 0);
+    opts.telemetry = telemetry.get();
     monitor_threads = daphne_sc::start_monitoring(daphne, opts);
   }
 
   std::cout << "Starting daphneServer\n";
   std::cout << "Bind: " << bind_endpoint << "\n";
+  std::cout << "Alignment cache: " << (align_cache_path.empty() ? "disabled" : align_cache_path) << "\n";
+  std::cout << "Board state file: " << state_file_path << "\n";
   if (disable_monitoring) {
     std::cout << "Monitoring: disabled\n";
   } else {
     std::cout << "Monitoring period: " << monitor_period_ms << " ms\n";
+    std::cout << "Pedestal monitor period: " << pedestal_period_s << " s\n";
+    std::cout << "Frame-clock watchdog period: " << fclk_watchdog_period_ms << " ms"
+              << (fclk_auto_realign ? ", auto re-align\n" : ", report only\n");
+    std::cout << "Trigger counter sampling period: " << trigger_sample_period_ms << " ms\n";
+  }
+  if (telemetry) {
+    std::cout << "Telemetry: " << telemetry_opts.bind_endpoint << "\n";
+  } else if (!telemetry_opts.bind_endpoint.empty()) {
+    std::cout << "Telemetry: disabled (monitoring is disabled)\n";
   }
 
   const auto handlers = daphne_sc::make_v2_handlers();
@@ -1,50 +1,101 @@
 #include "server_controller/monitoring.hpp"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <future>
 #include <iostream>
 #include <mutex>
+#include <sstream>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "Daphne.hpp"
+#include "I2CBusExecutor.hpp"
+#include "MonitoringHistory.hpp"
+#include "defines.hpp"
+#include "server_controller/telemetry.hpp"
 
 namespace daphne_sc {
 namespace {
 
-void i2c_2_monitor_thread(Daphne& daphne, std::chrono::milliseconds period) {
+// The closures refer to the caller's locals, so every future is waited for
+// before the first failure is rethrown.
+void wait_all(std::vector<std::future<void>>& futures) {
+  for (auto& f : futures) f.wait();
+  for (auto& f : futures) f.get();
+}
+
+void i2c_2_monitor_thread(Daphne& daphne, std::chrono::milliseconds period, TelemetryPublisher* telemetry) {
+  using Priority = I2CBusExecutor::Priority;
+  auto* bus = daphne.getI2C2Bus();
   while (true) {
     try {
-      std::unique_lock<std::mutex> i2c2_lock(daphne.i2c_2_mutex, std::try_to_lock);
-      if (!i2c2_lock.owns_lock()) {
-        std::this_thread::sleep_for(period);
-        continue;
-      }
-
       auto* hd = daphne.getHDMezzDriver();
       if (hd) {
-        for(size_t i = 0; i < 5; i++){
-          if(hd->isAfeBlockEnabled(i)){
-            daphne.HDMezz_5V_is_powered[i].store(hd->isPowerOn(i, "5V"));
-            daphne.HDMezz_3V3_is_powered[i].store(hd->isPowerOn(i, "3V3"));
-            daphne.HDMezz_5V_voltage[i].store(hd->readRailVoltage(i, "5V"));
-            daphne.HDMezz_5V_current[i].store(hd->readRailCurrent(i, "5V"));
-            daphne.HDMezz_3V3_voltage[i].store(hd->readRailVoltage(i, "3V3"));
-            daphne.HDMezz_3V3_current[i].store(hd->readRailCurrent(i, "3V3"));
-            daphne.HDMezz_5V_power[i].store(hd->readRailPower(i, "5V"));
-            daphne.HDMezz_3V3_power[i].store(hd->readRailPower(i, "3V3"));
-            // Check and latch the alert condition.
-            if(!daphne.HDMezz_5V_alert[i].load()) daphne.HDMezz_5V_alert[i].store(hd->checkAlertStatus(i, "5V"));
-            if(!daphne.HDMezz_3V3_alert[i].load()) daphne.HDMezz_3V3_alert[i].store(hd->checkAlertStatus(i, "3V3"));
-            if((daphne.HDMezz_5V_alert[i].load() || daphne.HDMezz_3V3_alert[i].load())
-               && (daphne.HDMezz_5V_is_powered[i].load() || daphne.HDMezz_3V3_is_powered[i].load())){ // If there's an alert and the rail is powered, power off the rails for safety
+        // Alerts stay latched; a latched rail is not polled for its alert again.
+        const MonitoringSnapshot previous = daphne.getMonitoringSnapshot();
+        std::array<HDMezzRails, 5> rails{};
+        std::vector<std::future<void>> pending;
+        // Alert checks and the power-off they trigger go to the safety queue;
+        // each block's readings are one telemetry transaction, so user commands
+        // are served between blocks rather than after the whole cycle.
+        for (size_t i = 0; i < rails.size(); ++i) {
+          pending.push_back(bus->submit(Priority::kSafety, [&, i] {
+            if (!hd->isAfeBlockEnabled(i)) return;
+            HDMezzRails& r = rails[i];
+            r.alert5V = !previous.hdmezz[i].alert5V && hd->checkAlertStatus(i, "5V");
+            r.alert3V3 = !previous.hdmezz[i].alert3V3 && hd->checkAlertStatus(i, "3V3");
+            const bool alert5V = previous.hdmezz[i].alert5V || r.alert5V;
+            const bool alert3V3 = previous.hdmezz[i].alert3V3 || r.alert3V3;
+            // If there's an alert and the rail is powered, power off the rails for safety
+            if ((alert5V || alert3V3) && (hd->isPowerOn(i, "5V") || hd->isPowerOn(i, "3V3"))) {
               hd->powerOn_HDMezzAfeBlock(i, false, "5V");
               hd->powerOn_HDMezzAfeBlock(i, false, "3V3");
-              std::cerr << "Alert on AFE block " << i << ": "
-                        << (daphne.HDMezz_5V_alert[i].load() ? "5V alert " : "")
-                        << (daphne.HDMezz_3V3_alert[i].load() ? "3V3 alert" : "")
-                        << std::endl;
+              std::cerr << "Alert on AFE block " << i << ": " << (alert5V ? "5V alert " : "")
+                        << (alert3V3 ? "3V3 alert" : "") << std::endl;
             }
-          }
+          }));
         }
+        for (size_t i = 0; i < rails.size(); ++i) {
+          pending.push_back(bus->submit(Priority::kTelemetry, [&, i] {
+            if (!hd->isAfeBlockEnabled(i)) return;
+            HDMezzRails& r = rails[i];
+            r.enabled = true;
+            r.powered5V = hd->isPowerOn(i, "5V");
+            r.powered3V3 = hd->isPowerOn(i, "3V3");
+            r.voltage5V = hd->readRailVoltage(i, "5V");
+            r.current5V = hd->readRailCurrent(i, "5V");
+            r.voltage3V3 = hd->readRailVoltage(i, "3V3");
+            r.current3V3 = hd->readRailCurrent(i, "3V3");
+            r.power5V = hd->readRailPower(i, "5V");
+            r.power3V3 = hd->readRailPower(i, "3V3");
+          }));
+        }
+        wait_all(pending);
+
+        const uint64_t now_ns = MonitoringHistory::nowNs();
+        MonitoringSnapshot published;
+        daphne.updateMonitoringSnapshot([&](MonitoringSnapshot& snapshot) {
+          for (size_t i = 0; i < rails.size(); ++i) {
+            if (rails[i].enabled) {
+              // Latch against the current value so a clear made during the cycle sticks.
+              HDMezzRails r = rails[i];
+              r.alert5V = r.alert5V || snapshot.hdmezz[i].alert5V;
+              r.alert3V3 = r.alert3V3 || snapshot.hdmezz[i].alert3V3;
+              snapshot.hdmezz[i] = r;
+            } else {
+              snapshot.hdmezz[i].enabled = false;
+            }
+          }
+          snapshot.hdmezzCycleNs = now_ns;
+          ++snapshot.hdmezzCycles;
+          published = snapshot;
+        });
+        daphne.getMonitoringSeries()->recordHDMezz(published);
+        if (telemetry) telemetry->publish_hdmezz(published);
       }
     } catch (const std::exception& e) {
       std::cerr << "I2C_2 monitor error: " << e.what() << std::endl;
@@ -54,45 +105,49 @@ void i2c_2_monitor_thread(Daphne& daphne, std::chrono::milliseconds period) {
   }
 }
 
-void i2c_1_monitor_thread(Daphne& daphne, std::chrono::milliseconds period) {
+void i2c_1_monitor_thread(Daphne& daphne, std::chrono::milliseconds period, TelemetryPublisher* telemetry) {
+  using Priority = I2CBusExecutor::Priority;
+  auto* bus = daphne.getI2C1Bus();
   bool warned_missing_adc = false;
   while (true) {
     try {
-      if (!daphne.isI2C_1_device_configuring.load() && !daphne.user_vbias_voltage_request.load()) {
-        auto* adc0x10 = daphne.getADS7138_Driver_addr_0x10();
-        auto* adc0x17 = daphne.getADS7138_Driver_addr_0x17();
-        if (!adc0x10 || !adc0x17) {
-          if (!warned_missing_adc) {
-            std::cerr << "ADS7138 drivers not available; skipping I2C_1 monitor." << std::endl;
-            warned_missing_adc = true;
-          }
-          std::this_thread::sleep_for(std::chrono::seconds(1));
-          continue;
+      auto* adc0x10 = daphne.getADS7138_Driver_addr_0x10();
+      auto* adc0x17 = daphne.getADS7138_Driver_addr_0x17();
+      if (!adc0x10 || !adc0x17) {
+        if (!warned_missing_adc) {
+          std::cerr << "ADS7138 drivers not available; skipping I2C_1 monitor." << std::endl;
+          warned_missing_adc = true;
         }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        continue;
+      }
 
-        daphne.is_vbias_voltage_monitor_reading.store(true);
-        std::vector<double> adc_values_0x10 = adc0x10->readData(7);
-        std::vector<double> adc_values_0x17 = adc0x17->readData(3);
-        daphne.is_vbias_voltage_monitor_reading.store(false);
+      // One transaction per ADC, so a user request waits for at most one.
+      const std::vector<double> adc_values_0x10 = bus->run(Priority::kTelemetry, [&] { return adc0x10->readData(7); });
+      const std::vector<double> adc_values_0x17 = bus->run(Priority::kTelemetry, [&] { return adc0x17->readData(3); });
 
+      const uint64_t now_ns = MonitoringHistory::nowNs();
+      MonitoringSnapshot published;
+      daphne.updateMonitoringSnapshot([&](MonitoringSnapshot& snapshot) {
         if (adc_values_0x10.size() >= 7) {
-          daphne._3V3PDS_voltage.store(adc_values_0x10[0] * 2.0);
-          daphne._1V8PDS_voltage.store(adc_values_0x10[1] * 2.0);
-          daphne._VBIAS_0_voltage.store(adc_values_0x10[2] * 39.314);
-          daphne._VBIAS_1_voltage.store(adc_values_0x10[3] * 39.314);
-          daphne._VBIAS_2_voltage.store(adc_values_0x10[4] * 39.314);
-          daphne._VBIAS_3_voltage.store(adc_values_0x10[5] * 39.314);
-          daphne._VBIAS_4_voltage.store(adc_values_0x10[6] * 39.314);
+          snapshot.v3V3PDS = adc_values_0x10[0] * 2.0;
+          snapshot.v1V8PDS = adc_values_0x10[1] * 2.0;
+          for (size_t afe = 0; afe < snapshot.vBias.size(); ++afe) {
+            snapshot.vBias[afe] = adc_values_0x10[2 + afe] * 39.314;
+          }
         }
-
         if (adc_values_0x17.size() >= 3) {
-          daphne._1V8A_voltage.store(adc_values_0x17[0] * 2.0);
-          daphne._3V3A_voltage.store(adc_values_0x17[1] * 2.0);
-          daphne._n5VA_voltage.store(adc_values_0x17[2] * (-2.0));
+          snapshot.v1V8A = adc_values_0x17[0] * 2.0;
+          snapshot.v3V3A = adc_values_0x17[1] * 2.0;
+          snapshot.vn5VA = adc_values_0x17[2] * (-2.0);
         }
-      }
+        snapshot.railsCycleNs = now_ns;
+        ++snapshot.railsCycles;
+        published = snapshot;
+      });
+      daphne.getMonitoringSeries()->recordRails(published);
+      if (telemetry) telemetry->publish_rails(published);
     } catch (const std::exception& e) {
-      daphne.is_vbias_voltage_monitor_reading.store(false);
       std::cerr << "I2C_1 monitor error: " << e.what() << std::endl;
     }
 
@@ -100,12 +155,275 @@ void i2c_1_monitor_thread(Daphne& daphne, std::chrono::milliseconds period) {
   }
 }
 
+void pedestal_monitor_thread(Daphne& daphne, MonitoringOptions options) {
+  constexpr uint32_t kChannels = 40;
+  const auto retry = std::min<std::chrono::milliseconds>(options.pedestal_period, std::chrono::seconds(1));
+  const uint64_t quiet_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options.pedestal_period).count();
+  const uint32_t n_samples = std::clamp<uint32_t>(options.pedestal_samples, 2, 2048);
+  const uint32_t n_waveforms = std::max<uint32_t>(options.pedestal_waveforms, 1);
+  std::vector<uint32_t> samples(n_samples);
+
+  std::array<uint32_t, kChannels> mapped_channels{};
+  for (uint32_t ch = 0; ch < kChannels; ++ch) {
+    mapped_channels[ch] = afe_definitions::AFE_board2PL_map.at(ch / 8) * 8 + ch % 8;
+  }
+
+  std::chrono::milliseconds wait = options.pedestal_period;
+  while (true) {
+    std::this_thread::sleep_for(wait);
+    wait = retry;
+    try {
+      // Stay out of the way of client dumps/configures, including the quiet
+      // period right after one so back-to-back client requests are not interleaved.
+      if (daphne.activeClientAcquisitions.load() > 0) continue;
+      if (MonitoringHistory::nowNs() - daphne.last_client_acquisition_ns.load() < quiet_ns) continue;
+      std::unique_lock<std::mutex> acquisition_lock(daphne.acquisition_mutex, std::try_to_lock);
+      if (!acquisition_lock.owns_lock()) continue;
+
+      auto* spy_buffer = daphne.getSpyBuffer();
+      auto* front_end = daphne.getFrontEnd();
+      std::array<double, kChannels> mean_sum{};
+      std::array<double, kChannels> var_sum{};
+      std::array<double, kChannels> p2p_sum{};
+      bool aborted = false;
+
+      for (uint32_t wf = 0; wf < n_waveforms && !aborted; ++wf) {
+        front_end->doTrigger();
+        for (uint32_t ch = 0; ch < kChannels; ++ch) {
+          if (daphne.activeClientAcquisitions.load() > 0) {
+            aborted = true;
+            break;
+          }
+          spy_buffer->extractMappedDataBulkSIMD(samples.data(), n_samples, mapped_channels[ch]);
+          double sum = 0.0;
+          double sum_sq = 0.0;
+          const auto [lo, hi] = std::minmax_element(samples.begin(), samples.end());
+          for (const auto v : samples) {
+            sum += v;
+            sum_sq += static_cast<double>(v) * v;
+          }
+          const double mean = sum / n_samples;
+          mean_sum[ch] += mean;
+          var_sum[ch] += std::max(0.0, sum_sq / n_samples - mean * mean);
+          p2p_sum[ch] += static_cast<double>(*hi - *lo);
+        }
+      }
+      acquisition_lock.unlock();
+      if (aborted) continue;
+
+      PedestalRecord record;
+      record.timestamp_ns = MonitoringHistory::nowNs();
+      for (uint32_t ch = 0; ch < kChannels; ++ch) {
+        record.mean[ch] = static_cast<float>(mean_sum[ch] / n_waveforms);
+        record.ac_rms[ch] = static_cast<float>(std::sqrt(var_sum[ch] / n_waveforms));
+        record.p2p[ch] = static_cast<float>(p2p_sum[ch] / n_waveforms);
+      }
+      daphne.getMonitoringHistory()->pushPedestal(record);
+      wait = options.pedestal_period;
+    } catch (const std::exception& e) {
+      std::cerr << "Pedestal monitor error: " << e.what() << std::endl;
+      wait = options.pedestal_period;
+    }
+  }
+}
+
+constexpr uint32_t kExpectedFclkWord = 0x00FF00FFu;
+
+// Local re-alignment of a single AFE, following docs/frontend-safety-contract.md:
+// DELAYCTRL_READY must be set, VTC is disabled while taps are loaded, and the
+// result is only accepted after a short verification sequence. On failure the
+// previous delay/bitslip are restored.
+bool realign_afe_locally(Daphne& daphne, uint32_t afe, uint32_t radius, std::string& report) {
+  constexpr uint32_t kVerificationReads = 4;
+  auto* front_end = daphne.getFrontEnd();
+  auto* spy_buffer = daphne.getSpyBuffer();
+
+  if (front_end->getDelayCtrlReady() == 0) {
+    report = "DELAYCTRL_READY low; full alignment required.";
+    return false;
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const uint32_t delay0 = front_end->getDelay(afe);
+  const uint32_t bitslip0 = front_end->getBitslip(afe);
+
+  front_end->setEnableDelayVtc(0);
+  std::string debug;
+  bool ok = daphne.setBestDelayLocal(afe, radius, &debug);
+  if (!ok) {
+    std::string bitslip_debug;
+    daphne.setBestBitslip(afe, 16, &bitslip_debug, &ok);
+    debug += bitslip_debug;
+  }
+  for (uint32_t i = 0; ok && i < kVerificationReads; ++i) {
+    front_end->doTrigger();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ok = spy_buffer->getFrameClock(afe, 0) == kExpectedFclkWord;
+  }
+  if (!ok) {
+    front_end->setDelay(afe, delay0);
+    front_end->setBitslip(afe, bitslip0);
+  }
+  front_end->setEnableDelayVtc(1);
+
+  const auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+  std::ostringstream os;
+  os << (ok ? "re-aligned" : "local re-align failed") << ": delay " << delay0 << "->" << front_end->getDelay(afe)
+     << ", bitslip " << bitslip0 << "->" << front_end->getBitslip(afe) << " in " << elapsed_ms << " ms.\n"
+     << debug;
+  report = os.str();
+  return ok;
+}
+
+void frame_clock_watchdog_thread(Daphne& daphne, MonitoringOptions options) {
+  constexpr uint32_t kAfes = 5;
+  constexpr uint32_t kMissesBeforeRealign = 2;
+  constexpr float kQualityAlpha = 0.05f;
+  const uint64_t quiet_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options.fclk_watchdog_period).count();
+  auto* history = daphne.getMonitoringHistory();
+
+  std::array<FrameClockStatus, kAfes> status{};
+  std::array<uint32_t, kAfes> consecutive_misses{};
+
+  while (true) {
+    std::this_thread::sleep_for(options.fclk_watchdog_period);
+    try {
+      if (daphne.activeClientAcquisitions.load() > 0) continue;
+      if (MonitoringHistory::nowNs() - daphne.last_client_acquisition_ns.load() < quiet_ns) continue;
+      std::unique_lock<std::mutex> acquisition_lock(daphne.acquisition_mutex, std::try_to_lock);
+      if (!acquisition_lock.owns_lock()) continue;
+
+      auto* front_end = daphne.getFrontEnd();
+      auto* spy_buffer = daphne.getSpyBuffer();
+
+      // One snapshot covers the frame clocks of all five AFEs.
+      front_end->doTrigger();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      std::array<uint32_t, kAfes> words{};
+      for (uint32_t afe = 0; afe < kAfes; ++afe) words[afe] = spy_buffer->getFrameClock(afe, 0);
+
+      const uint64_t now = MonitoringHistory::nowNs();
+      for (uint32_t afe = 0; afe < kAfes; ++afe) {
+        auto& st = status[afe];
+        const bool good = words[afe] == kExpectedFclkWord;
+        st.last_check_ns = now;
+        st.last_word = words[afe];
+        st.lock_quality = st.checks == 0 ? (good ? 1.0f : 0.0f)
+                                         : (1.0f - kQualityAlpha) * st.lock_quality + kQualityAlpha * (good ? 1.0f : 0.0f);
+        st.checks++;
+        st.delay = front_end->getDelay(afe);
+        st.bitslip = front_end->getBitslip(afe);
+
+        if (good) {
+          consecutive_misses[afe] = 0;
+          if (!st.armed) {
+            history->pushEvent("fclk", "AFE " + std::to_string(afe) + " locked (delay " + std::to_string(st.delay) +
+                                           ", bitslip " + std::to_string(st.bitslip) + "); watchdog armed.");
+          }
+          st.armed = true;
+          st.locked = true;
+          continue;
+        }
+
+        st.misses++;
+        if (st.locked) {
+          std::ostringstream os;
+          os << "AFE " << afe << " lost lock: frame clock 0x" << std::hex << words[afe] << ".";
+          history->pushEvent("fclk", os.str());
+        }
+        st.locked = false;
+        // Never-locked AFEs (unpowered, not yet aligned) are left to the operator.
+        if (!options.fclk_auto_realign || !st.armed || ++consecutive_misses[afe] < kMissesBeforeRealign) continue;
+        // A client acquisition started during this check: re-align on a later one.
+        if (daphne.activeClientAcquisitions.load() > 0) continue;
+
+        consecutive_misses[afe] = 0;
+        std::string report;
+        const bool ok = realign_afe_locally(daphne, afe, options.fclk_search_radius, report);
+        st.delay = front_end->getDelay(afe);
+        st.bitslip = front_end->getBitslip(afe);
+        if (ok) {
+          st.realigns++;
+          st.locked = true;
+        } else {
+          st.realign_failures++;
+          st.armed = false;
+        }
+        history->pushEvent("fclk", "AFE " + std::to_string(afe) + " " + report);
+      }
+      history->setFrameClockStatus(status);
+    } catch (const std::exception& e) {
+      std::cerr << "Frame-clock watchdog error: " << e.what() << std::endl;
+    }
+  }
+}
+
+// Counters are read through the persistent TriggerBlock mapping; rates use the
+// steady_clock interval between reads, so a late wake-up does not skew them.
+void trigger_counter_sampler_thread(Daphne& daphne, MonitoringOptions options) {
+  constexpr uint32_t kChannels = TriggerBlock::kNumChannels;
+  auto* block = daphne.getTriggerBlock();
+  auto* history = daphne.getMonitoringHistory();
+
+  TriggerCounterSample previous;
+  bool have_previous = false;
+  auto next = std::chrono::steady_clock::now();
+  while (true) {
+    next += options.trigger_sample_period;
+    const auto now = std::chrono::steady_clock::now();
+    if (next < now) next = now + options.trigger_sample_period;  // fell behind; skip missed ticks
+    std::this_thread::sleep_until(next);
+    try {
+      const auto counters = block->getAllCounters();
+      TriggerCounterSample sample;
+      sample.monotonic_ns = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+              .count());
+      sample.timestamp_ns = MonitoringHistory::nowNs();
+      for (uint32_t ch = 0; ch < kChannels; ++ch) {
+        sample.record[ch] = counters[ch].record;
+        sample.busy[ch] = counters[ch].busy;
+        sample.full[ch] = counters[ch].full;
+      }
+      if (have_previous && sample.monotonic_ns > previous.monotonic_ns) {
+        sample.interval_s = static_cast<double>(sample.monotonic_ns - previous.monotonic_ns) * 1e-9;
+        auto rate = [&](uint64_t current, uint64_t before) {
+          return current >= before ? static_cast<float>(static_cast<double>(current - before) / sample.interval_s)
+                                   : 0.0f;
+        };
+        for (uint32_t ch = 0; ch < kChannels; ++ch) {
+          sample.record_rate[ch] = rate(sample.record[ch], previous.record[ch]);
+          sample.busy_rate[ch] = rate(sample.busy[ch], previous.busy[ch]);
+          sample.full_rate[ch] = rate(sample.full[ch], previous.full[ch]);
+        }
+      }
+      history->pushTriggerSample(sample);
+      if (options.telemetry) options.telemetry->publish_triggers(sample);
+      previous = sample;
+      have_previous = true;
+    } catch (const std::exception& e) {
+      std::cerr << "Trigger counter sampler error: " << e.what() << std::endl;
+      have_previous = false;
+    }
+  }
+}
+
 }  // namespace
 
 std::vector<std::thread> start_monitoring(Daphne& daphne, const MonitoringOptions& options) {
   std::vector<std::thread> threads;
-  threads.emplace_back(i2c_1_monitor_thread, std::ref(daphne), options.period);
-  threads.emplace_back(i2c_2_monitor_thread, std::ref(daphne), options.period);
+  threads.emplace_back(i2c_1_monitor_thread, std::ref(daphne), options.period, options.telemetry);
+  threads.emplace_back(i2c_2_monitor_thread, std::ref(daphne), options.period, options.telemetry);
+  if (options.pedestal_period.count() > 0) {
+    threads.emplace_back(pedestal_monitor_thread, std::ref(daphne), options);
+  }
+  if (options.fclk_watchdog_period.count() > 0) {
+    threads.emplace_back(frame_clock_watchdog_thread, std::ref(daphne), options);
+  }
+  if (options.trigger_sample_period.count() > 0) {
+    threads.emplace_back(trigger_counter_sampler_thread, std::ref(daphne), options);
+  }
   return threads;
 }
 
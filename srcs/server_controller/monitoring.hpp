@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <thread>
 #include <vector>
 
@@ -8,8 +9,28 @@ class Daphne;
 
 namespace daphne_sc {
 
+class TelemetryPublisher;
+
 struct MonitoringOptions {
   std::chrono::milliseconds period{200};
+  // Background pedestal snapshots (software triggered, only while no client
+  // acquisition is active). A zero period disables them.
+  std::chrono::seconds pedestal_period{30};
+  uint32_t pedestal_waveforms = 4;
+  uint32_t pedestal_samples = 1024;
+  // Frame-clock watchdog: one trigger per period checks all five AFEs and
+  // reports their lock state. With fclk_auto_realign it also re-centres the
+  // delay of a drifted AFE within +/- fclk_search_radius taps. A zero period
+  // disables it.
+  std::chrono::milliseconds fclk_watchdog_period{5000};
+  bool fclk_auto_realign = false;
+  uint32_t fclk_search_radius = 32;
+  // Self-trigger counter sampler: reads the record/busy/full counters of all
+  // channels each period and stores them with rates in MonitoringHistory.
+  // A zero period disables it.
+  std::chrono::milliseconds trigger_sample_period{1000};
+  // Receives every monitor cycle when set (not owned; outlives the threads).
+  TelemetryPublisher* telemetry = nullptr;
 };
 
 std::vector<std::thread> start_monitoring(Daphne& daphne, const MonitoringOptions& options);
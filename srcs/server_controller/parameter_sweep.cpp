@@ -0,0 +1,489 @@
+#include "server_controller/parameter_sweep.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Daphne.hpp"
+#include "defines.hpp"
+#include "daphneV3_high_level_confs.pb.h"
+#include "server_controller/acquisition_guard.hpp"
+#include "server_controller/bounded_queue.hpp"
+
+namespace daphne_sc {
+
+namespace {
+
+constexpr uint32_t kChannels = 40;
+constexpr uint32_t kAfes = 5;
+constexpr uint32_t kChannelsPerAfe = 8;
+constexpr uint32_t kMaxDacValue = 4095;
+constexpr uint32_t kMaxSamples = 2048;
+constexpr uint32_t kDefaultWaveforms = 16;
+constexpr uint32_t kDefaultSamples = 1024;
+constexpr uint32_t kDefaultHistogramWidth = 64;
+constexpr uint32_t kDefaultHistogramBins = 256;
+constexpr uint32_t kMaxHistogramBins = 16384;
+constexpr uint64_t kMaxPoints = 100000;
+constexpr uint64_t kMaxRawBytes = 64ULL * 1024 * 1024;
+
+struct Axis {
+  daphne::SweepParameter parameter = daphne::SWEEP_VGAIN;
+  std::vector<uint32_t> targets;
+  std::vector<uint32_t> values;
+  std::chrono::milliseconds settle{0};
+};
+
+struct Acquisition {
+  std::vector<uint32_t> channels;
+  std::vector<uint32_t> mapped;  // spy buffer index (PL numbering)
+  uint32_t waveforms = 0;
+  uint32_t samples = 0;
+  bool software_trigger = false;
+  daphne::SweepReduction reduction = daphne::SWEEP_FEATURES;
+  uint32_t histogram_min = 0;
+  uint32_t histogram_width = 0;
+  uint32_t histogram_bins = 0;
+};
+
+struct PreviousValue {
+  daphne::SweepParameter parameter = daphne::SWEEP_VGAIN;
+  uint32_t target = 0;
+  std::optional<uint32_t> value;
+};
+
+bool targets_channels(daphne::SweepParameter parameter) {
+  return parameter == daphne::SWEEP_TRIM || parameter == daphne::SWEEP_OFFSET;
+}
+
+std::vector<Axis> compile_axes(const daphne::RunSweepRequest& request) {
+  if (request.axes().empty()) throw std::invalid_argument("sweep has no axes");
+  std::vector<Axis> axes;
+  std::set<std::pair<int, uint32_t>> seen;
+  uint64_t points = 1;
+  for (const auto& in : request.axes()) {
+    Axis axis;
+    axis.parameter = in.parameter();
+    axis.settle = std::chrono::milliseconds(in.settle_ms());
+    axis.targets.assign(in.targets().begin(), in.targets().end());
+    switch (axis.parameter) {
+      case daphne::SWEEP_VGAIN:
+      case daphne::SWEEP_BIAS:
+      case daphne::SWEEP_TRIM:
+      case daphne::SWEEP_OFFSET: {
+        const uint32_t limit = targets_channels(axis.parameter) ? kChannels : kAfes;
+        if (axis.targets.empty()) throw std::invalid_argument("sweep axis has no targets");
+        for (const uint32_t target : axis.targets) {
+          if (target >= limit) {
+            throw std::invalid_argument("sweep target " + std::to_string(target) + " out of range (0.." +
+                                        std::to_string(limit - 1) + ")");
+          }
+        }
+        break;
+      }
+      case daphne::SWEEP_BIASCTRL:
+        if (!axis.targets.empty()) throw std::invalid_argument("biasctrl sweep axis takes no targets");
+        axis.targets.push_back(0);
+        break;
+      default:
+        throw std::invalid_argument("unknown sweep parameter " + std::to_string(static_cast<int>(axis.parameter)));
+    }
+    for (const uint32_t target : axis.targets) {
+      if (!seen.emplace(static_cast<int>(axis.parameter), target).second) {
+        throw std::invalid_argument("sweep parameter/target appears twice");
+      }
+    }
+
+    if (!in.values().empty()) {
+      axis.values.assign(in.values().begin(), in.values().end());
+    } else {
+      const uint32_t step = in.step() == 0 ? 1 : in.step();
+      if (in.start() > in.stop()) throw std::invalid_argument("sweep axis start above stop");
+      if (in.stop() > kMaxDacValue) throw std::invalid_argument("sweep axis stop out of range (0..4095)");
+      for (uint64_t v = in.start(); v <= in.stop(); v += step) axis.values.push_back(static_cast<uint32_t>(v));
+    }
+    for (const uint32_t v : axis.values) {
+      if (v > kMaxDacValue) throw std::invalid_argument("sweep value " + std::to_string(v) + " out of range (0..4095)");
+    }
+    points *= axis.values.size();
+    if (points > kMaxPoints) throw std::invalid_argument("sweep grid above 100000 points");
+    axes.push_back(std::move(axis));
+  }
+  return axes;
+}
+
+Acquisition compile_acquisition(const daphne::RunSweepRequest& request) {
+  Acquisition acq;
+  acq.channels.assign(request.channels().begin(), request.channels().end());
+  if (acq.channels.empty()) {
+    acq.channels.resize(kChannels);
+    std::iota(acq.channels.begin(), acq.channels.end(), 0);
+  }
+  for (const uint32_t ch : acq.channels) {
+    if (ch >= kChannels) throw std::invalid_argument("channel out of range (0..39)");
+    acq.mapped.push_back(afe_definitions::AFE_board2PL_map.at(ch / kChannelsPerAfe) * kChannelsPerAfe +
+                         ch % kChannelsPerAfe);
+  }
+  acq.waveforms = request.waveforms() == 0 ? kDefaultWaveforms : request.waveforms();
+  acq.samples = request.samples() == 0 ? kDefaultSamples : request.samples();
+  if (acq.samples > kMaxSamples) throw std::invalid_argument("samples above 2048");
+  acq.software_trigger = request.software_trigger();
+  acq.reduction = request.reduction();
+  switch (acq.reduction) {
+    case daphne::SWEEP_FEATURES:
+      break;
+    case daphne::SWEEP_HISTOGRAM:
+      acq.histogram_min = request.histogram_min();
+      acq.histogram_width = request.histogram_width() == 0 ? kDefaultHistogramWidth : request.histogram_width();
+      acq.histogram_bins = request.histogram_bins() == 0 ? kDefaultHistogramBins : request.histogram_bins();
+      if (acq.histogram_bins > kMaxHistogramBins) throw std::invalid_argument("histogram above 16384 bins");
+      break;
+    case daphne::SWEEP_SPECTRUM:
+      if (acq.samples < 2 || (acq.samples & (acq.samples - 1)) != 0) {
+        throw std::invalid_argument("spectrum needs a power-of-two number of samples");
+      }
+      break;
+    case daphne::SWEEP_RAW:
+      if (static_cast<uint64_t>(acq.waveforms) * acq.samples * acq.channels.size() * sizeof(uint32_t) > kMaxRawBytes) {
+        throw std::invalid_argument("raw sweep point above 64 MiB; lower waveforms or samples");
+      }
+      break;
+    default:
+      throw std::invalid_argument("unknown sweep reduction " + std::to_string(static_cast<int>(acq.reduction)));
+  }
+  return acq;
+}
+
+std::optional<uint32_t> find_value(Daphne& daphne, daphne::SweepParameter parameter, uint32_t target) {
+  switch (parameter) {
+    case daphne::SWEEP_VGAIN:
+      return daphne.findAfeAttenuationDictValue(afe_definitions::AFE_board2PL_map.at(target));
+    case daphne::SWEEP_BIAS:
+      return daphne.findBiasVoltageDictValue(afe_definitions::AFE_board2PL_map.at(target));
+    case daphne::SWEEP_BIASCTRL:
+      return daphne.findBiasControlDictValue();
+    case daphne::SWEEP_TRIM:
+      return daphne.findChTrimDictValue(target);
+    case daphne::SWEEP_OFFSET:
+      return daphne.findChOffsetDictValue(target);
+    default:
+      return std::nullopt;
+  }
+}
+
+// Writes one value to every target; trims/offsets go out as one masked write per AFE.
+void apply(Daphne& daphne, daphne::SweepParameter parameter, const std::vector<uint32_t>& targets, uint32_t value) {
+  auto* dac = daphne.getDac();
+  if (targets_channels(parameter)) {
+    std::array<uint8_t, kAfes> masks{};
+    for (const uint32_t ch : targets) masks[ch / kChannelsPerAfe] |= 1u << (ch % kChannelsPerAfe);
+    std::array<uint32_t, kChannelsPerAfe> values;
+    values.fill(value);
+    for (uint32_t afe_board = 0; afe_board < kAfes; ++afe_board) {
+      if (masks[afe_board] == 0) continue;
+      const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+      if (parameter == daphne::SWEEP_TRIM) {
+        dac->setTrims(afe_pl, values, false, false, masks[afe_board]);
+      } else {
+        dac->setOffsets(afe_pl, values, false, false, masks[afe_board]);
+      }
+    }
+    for (const uint32_t ch : targets) {
+      if (parameter == daphne::SWEEP_TRIM) {
+        daphne.setChTrimDictValue(ch, value);
+      } else {
+        daphne.setChOffsetDictValue(ch, value);
+      }
+    }
+    return;
+  }
+  if (parameter == daphne::SWEEP_BIASCTRL) {
+    dac->setDacHvBias(value, false, false);
+    daphne.setBiasControlDictValue(value);
+    return;
+  }
+  for (const uint32_t afe_board : targets) {
+    const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+    if (parameter == daphne::SWEEP_VGAIN) {
+      dac->setDacGain(afe_pl, value);
+      daphne.setAfeAttenuationDictValue(afe_pl, value);
+    } else {
+      dac->setDacBias(afe_pl, value);
+      daphne.setBiasVoltageDictValue(afe_pl, value);
+    }
+  }
+}
+
+// In-place iterative radix-2 FFT; x.size() is a power of two.
+void fft(std::vector<std::complex<double>>& x) {
+  const size_t n = x.size();
+  for (size_t i = 1, j = 0; i < n; ++i) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap(x[i], x[j]);
+  }
+  const double pi = std::acos(-1.0);
+  for (size_t len = 2; len <= n; len <<= 1) {
+    const double angle = -2.0 * pi / static_cast<double>(len);
+    const std::complex<double> w_len(std::cos(angle), std::sin(angle));
+    for (size_t i = 0; i < n; i += len) {
+      std::complex<double> w(1.0, 0.0);
+      for (size_t k = 0; k < len / 2; ++k) {
+        const std::complex<double> u = x[i + k];
+        const std::complex<double> v = x[i + k + len / 2] * w;
+        x[i + k] = u + v;
+        x[i + k + len / 2] = u - v;
+        w *= w_len;
+      }
+    }
+  }
+}
+
+// Per-channel running reduction, fed one waveform at a time.
+struct ChannelAccumulator {
+  uint64_t sum = 0;
+  uint64_t sum_sq = 0;
+  uint32_t min = std::numeric_limits<uint32_t>::max();
+  uint32_t max = 0;
+  double amplitude_sum = 0.0;
+  std::vector<uint64_t> counts;
+  uint64_t underflow = 0;
+  uint64_t overflow = 0;
+  std::vector<double> power;
+  std::vector<std::complex<double>> scratch;
+
+  void add(const uint32_t* x, const Acquisition& acq) {
+    const uint32_t n = acq.samples;
+    switch (acq.reduction) {
+      case daphne::SWEEP_FEATURES: {
+        uint64_t s = 0;
+        uint32_t wf_max = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+          s += x[i];
+          sum_sq += static_cast<uint64_t>(x[i]) * x[i];
+          min = std::min(min, x[i]);
+          wf_max = std::max(wf_max, x[i]);
+        }
+        sum += s;
+        max = std::max(max, wf_max);
+        amplitude_sum += wf_max - static_cast<double>(s) / n;
+        break;
+      }
+      case daphne::SWEEP_HISTOGRAM:
+        counts.resize(acq.histogram_bins, 0);
+        for (uint32_t i = 0; i < n; ++i) {
+          if (x[i] < acq.histogram_min) {
+            ++underflow;
+            continue;
+          }
+          const uint32_t bin = (x[i] - acq.histogram_min) / acq.histogram_width;
+          if (bin >= acq.histogram_bins) {
+            ++overflow;
+          } else {
+            ++counts[bin];
+          }
+        }
+        break;
+      case daphne::SWEEP_SPECTRUM: {
+        const double mean = static_cast<double>(std::accumulate(x, x + n, uint64_t{0})) / n;
+        scratch.resize(n);
+        for (uint32_t i = 0; i < n; ++i) scratch[i] = std::complex<double>(x[i] - mean, 0.0);
+        fft(scratch);
+        power.resize(n / 2 + 1, 0.0);
+        for (uint32_t k = 0; k <= n / 2; ++k) power[k] += std::norm(scratch[k]) / n;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+};
+
+// Captures the point's waveforms and fills the reduction fields of 'resp'.
+void acquire(Daphne& daphne, const Acquisition& acq, daphne::RunSweepResponse& resp) {
+  const uint32_t n = static_cast<uint32_t>(acq.mapped.size());
+  const uint32_t samples = acq.samples;
+  std::vector<uint32_t> wave(static_cast<size_t>(n) * samples);
+  std::vector<ChannelAccumulator> acc(n);
+  auto* spy_buffer = daphne.getSpyBuffer();
+  auto* frontend = daphne.getFrontEnd();
+  auto* raw = acq.reduction == daphne::SWEEP_RAW ? resp.mutable_raw() : nullptr;
+  if (raw) raw->Reserve(static_cast<int>(wave.size() * acq.waveforms));
+
+  for (uint32_t wf = 0; wf < acq.waveforms; ++wf) {
+    if (acq.software_trigger) frontend->doTrigger();
+    #pragma omp parallel for
+    for (uint32_t i = 0; i < n; ++i) {
+      uint32_t* row = wave.data() + static_cast<size_t>(i) * samples;
+      spy_buffer->extractMappedDataBulkSIMD(row, samples, acq.mapped[i]);
+      acc[i].add(row, acq);
+    }
+    if (raw) raw->Add(wave.begin(), wave.end());
+  }
+
+  const double total = static_cast<double>(acq.waveforms) * samples;
+  for (uint32_t i = 0; i < n; ++i) {
+    const ChannelAccumulator& a = acc[i];
+    switch (acq.reduction) {
+      case daphne::SWEEP_FEATURES: {
+        auto* out = resp.add_features();
+        const double mean = static_cast<double>(a.sum) / total;
+        out->set_channel(acq.channels[i]);
+        out->set_mean(mean);
+        out->set_rms(std::sqrt(std::max(0.0, static_cast<double>(a.sum_sq) / total - mean * mean)));
+        out->set_min(a.min);
+        out->set_max(a.max);
+        out->set_amplitude(a.amplitude_sum / acq.waveforms);
+        break;
+      }
+      case daphne::SWEEP_HISTOGRAM: {
+        auto* out = resp.add_histograms();
+        out->set_channel(acq.channels[i]);
+        out->mutable_counts()->Add(a.counts.begin(), a.counts.end());
+        out->set_underflow(a.underflow);
+        out->set_overflow(a.overflow);
+        break;
+      }
+      case daphne::SWEEP_SPECTRUM: {
+        auto* out = resp.add_spectra();
+        out->set_channel(acq.channels[i]);
+        for (const double p : a.power) out->add_power(p / acq.waveforms);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+}  // namespace
+
+void for_each_sweep_point(const daphne::RunSweepRequest& request,
+                          Daphne& daphne,
+                          const std::function<void(const daphne::RunSweepResponse&)>& on_point) {
+  const std::vector<Axis> axes = compile_axes(request);
+  const Acquisition acq = compile_acquisition(request);
+  uint32_t point_count = 1;
+  for (const auto& axis : axes) point_count *= static_cast<uint32_t>(axis.values.size());
+
+  ClientAcquisitionGuard acquisition(daphne);
+
+  std::vector<PreviousValue> previous;
+  for (const auto& axis : axes) {
+    for (const uint32_t target : axis.targets) {
+      previous.push_back({axis.parameter, target, find_value(daphne, axis.parameter, target)});
+    }
+  }
+  auto restore = [&] {
+    for (const auto& p : previous) {
+      if (p.value) apply(daphne, p.parameter, {p.target}, *p.value);
+    }
+  };
+
+  BoundedQueue<daphne::RunSweepResponse> queue(2);
+  std::atomic<bool> stop(false);
+  std::string error;
+  const auto t0 = std::chrono::steady_clock::now();
+
+  std::thread producer([&] {
+    try {
+      std::vector<size_t> index(axes.size(), 0);
+      std::vector<size_t> programmed(axes.size(), std::numeric_limits<size_t>::max());
+      for (uint32_t point = 0; point < point_count && !stop.load(); ++point) {
+        const auto point_t0 = std::chrono::steady_clock::now();
+        std::chrono::milliseconds settle{0};
+        for (size_t a = 0; a < axes.size(); ++a) {
+          if (programmed[a] == index[a]) continue;
+          apply(daphne, axes[a].parameter, axes[a].targets, axes[a].values[index[a]]);
+          programmed[a] = index[a];
+          settle = std::max(settle, axes[a].settle);
+        }
+        std::this_thread::sleep_for(settle);
+
+        daphne::RunSweepResponse resp;
+        resp.set_success(true);
+        resp.set_request_id(request.request_id());
+        resp.set_point_index(point);
+        resp.set_point_count(point_count);
+        for (size_t a = 0; a < axes.size(); ++a) {
+          auto* setting = resp.add_settings();
+          setting->set_parameter(axes[a].parameter);
+          setting->set_value(axes[a].values[index[a]]);
+        }
+        resp.mutable_channels()->Add(acq.channels.begin(), acq.channels.end());
+        resp.set_samples(acq.samples);
+        resp.set_waveforms(acq.waveforms);
+        acquire(daphne, acq, resp);
+        resp.set_elapsed_s(std::chrono::duration<double>(std::chrono::steady_clock::now() - point_t0).count());
+
+        // Odometer step, last axis fastest.
+        for (size_t a = axes.size(); a-- > 0;) {
+          if (++index[a] < axes[a].values.size()) break;
+          index[a] = 0;
+        }
+
+        if (point + 1 == point_count) {
+          if (!request.keep_last()) restore();
+          std::ostringstream os;
+          os << point_count << " point(s) in "
+             << std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() << " s; "
+             << (request.keep_last() ? "last point kept." : "swept parameters restored where known.");
+          resp.set_message(os.str());
+          resp.set_is_final(true);
+        }
+        queue.push(std::move(resp));
+      }
+      if (stop.load() && !request.keep_last()) restore();
+    } catch (const std::exception& e) {
+      error = e.what();
+      try {
+        if (!request.keep_last()) restore();
+      } catch (const std::exception& restore_error) {
+        error += std::string("; restore failed: ") + restore_error.what();
+      }
+    }
+    queue.close();
+  });
+
+  bool final_sent = false;
+  try {
+    daphne::RunSweepResponse resp;
+    while (queue.pop(resp)) {
+      final_sent = resp.is_final();
+      on_point(resp);
+    }
+  } catch (...) {
+    stop.store(true);
+    queue.close();
+    producer.join();
+    throw;
+  }
+  producer.join();
+
+  if (!final_sent) {
+    daphne::RunSweepResponse resp;
+    resp.set_success(false);
+    resp.set_request_id(request.request_id());
+    resp.set_point_count(point_count);
+    resp.set_is_final(true);
+    resp.set_message("Sweep failed: " + (error.empty() ? std::string("aborted") : error));
+    on_point(resp);
+  }
+}
+
+}  // namespace daphne_sc
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+
+class Daphne;
+
+namespace daphne {
+class RunSweepRequest;
+class RunSweepResponse;
+}  // namespace daphne
+
+namespace daphne_sc {
+
+// Runs the sweep grid (first axis outermost) under the acquisition lock. A
+// worker thread programs, settles, acquires and reduces each point while
+// on_point sends the previous one, so the link does not pace the scan. Only
+// axes whose value changed are rewritten. Unless keep_last is set, the swept
+// parameters are restored before the final point is handed over. on_point
+// always sees exactly one response with is_final set; a failure mid-sweep ends
+// with an is_final response that has success = false. Throws
+// std::invalid_argument on malformed requests, before anything is written.
+void for_each_sweep_point(const daphne::RunSweepRequest& request,
+                          Daphne& daphne,
+                          const std::function<void(const daphne::RunSweepResponse&)>& on_point);
+
+}  // namespace daphne_sc
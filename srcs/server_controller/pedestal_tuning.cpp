@@ -0,0 +1,291 @@
+#include "server_controller/pedestal_tuning.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Daphne.hpp"
+#include "defines.hpp"
+#include "daphneV3_high_level_confs.pb.h"
+
+namespace daphne_sc {
+
+namespace {
+
+constexpr uint32_t kChannels = 40;
+constexpr uint32_t kChannelsPerAfe = 8;
+constexpr uint32_t kMaxDacValue = 4095;
+constexpr uint32_t kMaxSamples = 2048;
+constexpr double kDefaultTarget = 2000.0;
+constexpr double kDefaultTolerance = 5.0;
+constexpr uint32_t kDefaultMaxIterations = 16;
+constexpr uint32_t kDefaultWaveforms = 2;
+constexpr uint32_t kDefaultSamples = 1024;
+constexpr uint32_t kDefaultSettleMs = 2;
+
+struct ChannelSearch {
+  uint32_t channel = 0;
+  uint32_t mapped = 0;  // spy buffer index (PL numbering)
+  // Bracket: f = mean - target, with f(a) and f(b) of opposite sign.
+  uint32_t a = 0;
+  uint32_t b = 0;
+  double fa = 0.0;
+  double fb = 0.0;
+  int retained = 0;  // Illinois: -1/+1 when the same end was kept last step
+  uint32_t best_offset = 0;
+  double best_mean = 0.0;
+  uint32_t steps = 0;
+  bool done = false;
+};
+
+uint64_t sum_u32(const uint32_t* x, uint32_t n) {
+  uint64_t s = 0;
+  for (uint32_t i = 0; i < n; ++i) s += x[i];
+  return s;
+}
+
+// One trim/offset DAC write per touched channel pair; the Daphne offset values follow.
+void program_offsets(Daphne& daphne, const std::vector<ChannelSearch*>& searches, const std::vector<uint32_t>& offsets) {
+  std::array<std::array<uint32_t, kChannelsPerAfe>, 5> values{};
+  std::array<uint8_t, 5> masks{};
+  for (size_t i = 0; i < searches.size(); ++i) {
+    const uint32_t ch = searches[i]->channel;
+    values[ch / kChannelsPerAfe][ch % kChannelsPerAfe] = offsets[i];
+    masks[ch / kChannelsPerAfe] |= 1u << (ch % kChannelsPerAfe);
+  }
+  for (uint32_t afe_board = 0; afe_board < masks.size(); ++afe_board) {
+    if (masks[afe_board] == 0) continue;
+    const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+    daphne.getDac()->setOffsets(afe_pl, values[afe_board], false, false, masks[afe_board]);
+    for (uint32_t idx = 0; idx < kChannelsPerAfe; ++idx) {
+      if (masks[afe_board] & (1u << idx)) {
+        daphne.setChOffsetDictValue(afe_board * kChannelsPerAfe + idx, values[afe_board][idx]);
+      }
+    }
+  }
+}
+
+// Programs the offsets, then averages the baseline of every listed channel over the waveforms.
+std::vector<double> measure(Daphne& daphne,
+                            const std::vector<ChannelSearch*>& searches,
+                            const std::vector<uint32_t>& offsets,
+                            uint32_t waveforms,
+                            uint32_t samples,
+                            std::chrono::milliseconds settle) {
+  program_offsets(daphne, searches, offsets);
+  std::this_thread::sleep_for(settle);
+
+  const uint32_t n = static_cast<uint32_t>(searches.size());
+  std::vector<uint64_t> sums(n, 0);
+  std::vector<uint32_t> raw(static_cast<size_t>(n) * samples);
+  auto* spy_buffer = daphne.getSpyBuffer();
+  for (uint32_t wf = 0; wf < waveforms; ++wf) {
+    daphne.getFrontEnd()->doTrigger();
+    #pragma omp parallel for
+    for (uint32_t i = 0; i < n; ++i) {
+      uint32_t* row = raw.data() + static_cast<size_t>(i) * samples;
+      spy_buffer->extractMappedDataBulkSIMD(row, samples, searches[i]->mapped);
+      sums[i] += sum_u32(row, samples);
+    }
+  }
+  std::vector<double> means(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    means[i] = static_cast<double>(sums[i]) / (static_cast<double>(waveforms) * samples);
+  }
+  return means;
+}
+
+void record(ChannelSearch& search, uint32_t offset, double mean, double target) {
+  ++search.steps;
+  if (search.steps == 1 || std::fabs(mean - target) < std::fabs(search.best_mean - target)) {
+    search.best_offset = offset;
+    search.best_mean = mean;
+  }
+}
+
+}  // namespace
+
+std::string tune_pedestals(const daphne::TunePedestalsRequest& request,
+                           Daphne& daphne,
+                           daphne::TunePedestalsResponse& response) {
+  std::vector<uint32_t> chs(request.channels().begin(), request.channels().end());
+  if (chs.empty()) {
+    chs.resize(kChannels);
+    std::iota(chs.begin(), chs.end(), 0);
+  }
+  std::sort(chs.begin(), chs.end());
+  chs.erase(std::unique(chs.begin(), chs.end()), chs.end());
+  if (chs.back() >= kChannels) throw std::invalid_argument("channel out of range (0..39)");
+
+  const double target = request.target() == 0.0 ? kDefaultTarget : request.target();
+  const double tolerance = request.tolerance() == 0.0 ? kDefaultTolerance : request.tolerance();
+  if (!std::isfinite(target) || !std::isfinite(tolerance) || tolerance < 0.0) {
+    throw std::invalid_argument("bad target or tolerance");
+  }
+  const uint32_t min_offset = request.min_offset();
+  const uint32_t max_offset = request.max_offset() == 0 ? kMaxDacValue : request.max_offset();
+  if (max_offset > kMaxDacValue || min_offset >= max_offset) {
+    throw std::invalid_argument("offset bounds must satisfy min < max <= 4095");
+  }
+  if (request.vgain() > kMaxDacValue) throw std::invalid_argument("VGAIN out of range (0..4095)");
+  const uint32_t max_iterations = request.max_iterations() == 0 ? kDefaultMaxIterations : request.max_iterations();
+  const uint32_t waveforms = request.waveforms() == 0 ? kDefaultWaveforms : request.waveforms();
+  const uint32_t samples = request.samples() == 0 ? kDefaultSamples : request.samples();
+  if (samples > kMaxSamples) throw std::invalid_argument("samples above 2048");
+  const auto settle = std::chrono::milliseconds(request.settle_ms() == 0 ? kDefaultSettleMs : request.settle_ms());
+
+  const auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::optional<uint32_t>> previous;
+  std::vector<ChannelSearch> searches(chs.size());
+  for (size_t i = 0; i < chs.size(); ++i) {
+    searches[i].channel = chs[i];
+    searches[i].mapped =
+        afe_definitions::AFE_board2PL_map.at(chs[i] / kChannelsPerAfe) * kChannelsPerAfe + chs[i] % kChannelsPerAfe;
+    searches[i].a = min_offset;
+    searches[i].b = max_offset;
+    previous.push_back(daphne.findChOffsetDictValue(chs[i]));
+  }
+
+  std::vector<ChannelSearch*> all;
+  for (auto& search : searches) all.push_back(&search);
+
+  // VGAIN of the AFEs this request changed, by PL index.
+  std::vector<std::pair<uint32_t, std::optional<uint32_t>>> previous_vgain;
+  auto restore_vgain = [&] {
+    for (const auto& [afe_pl, vgain] : previous_vgain) {
+      if (!vgain) continue;
+      daphne.getDac()->setDacGain(afe_pl, *vgain);
+      daphne.setAfeAttenuationDictValue(afe_pl, *vgain);
+    }
+  };
+  auto restore_offsets = [&] {
+    std::vector<ChannelSearch*> known;
+    std::vector<uint32_t> offsets;
+    for (size_t i = 0; i < searches.size(); ++i) {
+      if (!previous[i]) continue;
+      known.push_back(&searches[i]);
+      offsets.push_back(*previous[i]);
+    }
+    if (!known.empty()) program_offsets(daphne, known, offsets);
+  };
+
+  uint32_t iterations = 0;
+  try {
+    if (request.vgain() != 0) {
+      std::array<bool, 5> touched{};
+      for (const uint32_t ch : chs) touched[ch / kChannelsPerAfe] = true;
+      for (uint32_t afe_board = 0; afe_board < touched.size(); ++afe_board) {
+        if (!touched[afe_board]) continue;
+        const uint32_t afe_pl = afe_definitions::AFE_board2PL_map.at(afe_board);
+        previous_vgain.emplace_back(afe_pl, daphne.findAfeAttenuationDictValue(afe_pl));
+        daphne.getDac()->setDacGain(afe_pl, request.vgain());
+        daphne.setAfeAttenuationDictValue(afe_pl, request.vgain());
+      }
+    }
+
+    // Both ends of the range first: they bracket the target or show it is out of reach.
+    const std::vector<double> at_min =
+        measure(daphne, all, std::vector<uint32_t>(all.size(), min_offset), waveforms, samples, settle);
+    const std::vector<double> at_max =
+        measure(daphne, all, std::vector<uint32_t>(all.size(), max_offset), waveforms, samples, settle);
+    iterations = 2;
+    for (size_t i = 0; i < searches.size(); ++i) {
+      ChannelSearch& search = searches[i];
+      search.fa = at_min[i] - target;
+      search.fb = at_max[i] - target;
+      record(search, min_offset, at_min[i], target);
+      record(search, max_offset, at_max[i], target);
+      search.done = std::fabs(search.best_mean - target) <= tolerance || (search.fa > 0.0) == (search.fb > 0.0);
+    }
+
+    while (iterations < max_iterations) {
+      std::vector<ChannelSearch*> active;
+      std::vector<uint32_t> offsets;
+      for (auto& search : searches) {
+        if (search.done) continue;
+        if (search.b - search.a <= 1) {
+          search.done = true;
+          continue;
+        }
+        // False position, kept strictly inside the bracket.
+        const double x = search.a - search.fa * (static_cast<double>(search.b) - search.a) / (search.fb - search.fa);
+        const uint32_t offset = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(x)), search.a + 1, search.b - 1);
+        active.push_back(&search);
+        offsets.push_back(offset);
+      }
+      if (active.empty()) break;
+      ++iterations;
+
+      const std::vector<double> means = measure(daphne, active, offsets, waveforms, samples, settle);
+      for (size_t k = 0; k < active.size(); ++k) {
+        ChannelSearch& search = *active[k];
+        const double f = means[k] - target;
+        record(search, offsets[k], means[k], target);
+        if (std::fabs(f) <= tolerance) {
+          search.done = true;
+        } else if ((f > 0.0) == (search.fa > 0.0)) {
+          search.a = offsets[k];
+          search.fa = f;
+          if (search.retained == 1) search.fb /= 2.0;
+          search.retained = 1;
+        } else {
+          search.b = offsets[k];
+          search.fb = f;
+          if (search.retained == -1) search.fa /= 2.0;
+          search.retained = -1;
+        }
+      }
+    }
+
+    // Leave the best offset (or the previous one) programmed.
+    std::vector<uint32_t> final_offsets;
+    for (size_t i = 0; i < searches.size(); ++i) {
+      final_offsets.push_back(!request.store() && previous[i] ? *previous[i] : searches[i].best_offset);
+    }
+    program_offsets(daphne, all, final_offsets);
+    if (!request.store()) restore_vgain();
+  } catch (...) {
+    try {
+      restore_offsets();
+      restore_vgain();
+    } catch (...) {
+    }
+    throw;
+  }
+
+  size_t converged = 0;
+  double worst = 0.0;
+  for (const auto& search : searches) {
+    auto* result = response.add_results();
+    const double residual = search.best_mean - target;
+    result->set_channel(search.channel);
+    result->set_offset(search.best_offset);
+    result->set_mean(search.best_mean);
+    result->set_residual(residual);
+    result->set_converged(std::fabs(residual) <= tolerance);
+    result->set_steps(search.steps);
+    if (result->converged()) ++converged;
+    worst = std::max(worst, std::fabs(residual));
+  }
+  const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  response.set_iterations(iterations);
+  response.set_elapsed_s(elapsed_s);
+
+  std::ostringstream os;
+  os << converged << "/" << searches.size() << " channel(s) within " << tolerance << " ADC of " << target << " in "
+     << iterations << " step(s), " << elapsed_s << " s; worst residual " << worst << " ADC"
+     << (request.store() ? "." : "; previous offsets and VGAIN restored where known.");
+  return os.str();
+}
+
+}  // namespace daphne_sc
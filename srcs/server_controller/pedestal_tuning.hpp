@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+class Daphne;
+
+namespace daphne {
+class TunePedestalsRequest;
+class TunePedestalsResponse;
+}  // namespace daphne
+
+namespace daphne_sc {
+
+// Searches the offset DAC of every requested channel for a baseline mean at the
+// target, all channels in lockstep. Each step writes the offsets, triggers the
+// spy buffers and takes the mean of every channel. The search brackets the
+// target between the offset bounds and then uses false position (Illinois),
+// so it needs no assumption about the sign of the offset-to-baseline slope.
+// The caller must hold the acquisition lock. Returns a one-line summary.
+// Throws std::invalid_argument on malformed requests.
+std::string tune_pedestals(const daphne::TunePedestalsRequest& request,
+                           Daphne& daphne,
+                           daphne::TunePedestalsResponse& response);
+
+}  // namespace daphne_sc
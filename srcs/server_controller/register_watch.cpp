@@ -0,0 +1,314 @@
+#include "server_controller/register_watch.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Daphne.hpp"
+#include "FrontEnd.hpp"
+#include "MonitoringHistory.hpp"
+#include "server_controller/v2_envelope.hpp"
+
+namespace daphne_sc {
+namespace {
+
+constexpr uint32_t kDefaultPeriodMs = 100;
+constexpr uint32_t kMinPeriodMs = 10;
+constexpr uint32_t kMaxPeriodMs = 60000;
+constexpr uint32_t kDefaultKeepaliveMs = 10000;
+constexpr uint32_t kMinKeepaliveMs = 1000;
+constexpr uint32_t kMaxKeepaliveMs = 3600000;
+
+bool moved(uint32_t value, uint32_t reported, uint32_t deadband) {
+  const uint32_t delta = value > reported ? value - reported : reported - value;
+  return delta > deadband;
+}
+
+}  // namespace
+
+RegisterWatcher::RegisterWatcher(zmq::context_t& ctx, Daphne& daphne)
+    : fpga_reg_(*daphne.getFrontEnd()->getFpgaReg()), thread_(&RegisterWatcher::run, this, std::ref(ctx)) {}
+
+RegisterWatcher::~RegisterWatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable()) thread_.join();
+}
+
+daphne::ControlEnvelopeV2 RegisterWatcher::handle(const std::string& client_id,
+                                                  const daphne::ControlEnvelopeV2& request) {
+  if (request.type() == daphne::MT2_WATCH_REGISTERS_REQ) {
+    daphne::WatchRegistersRequest watch;
+    daphne::WatchRegistersResponse response;
+    if (!watch.ParseFromString(request.payload())) {
+      response.set_success(false);
+      response.set_message("Bad WatchRegistersRequest payload");
+      response.set_is_final(true);
+    } else {
+      subscribe(client_id, request, watch, response);
+    }
+    return v2::make_response(request, daphne::MT2_WATCH_REGISTERS_RESP, response.SerializeAsString());
+  }
+
+  daphne::UnwatchRegistersRequest unwatch;
+  daphne::UnwatchRegistersResponse response;
+  if (!unwatch.ParseFromString(request.payload())) {
+    response.set_success(false);
+    response.set_message("Bad UnwatchRegistersRequest payload");
+  } else {
+    const uint32_t removed = unsubscribe(client_id, unwatch.subscription_id());
+    response.set_removed(removed);
+    if (unwatch.subscription_id() != 0 && removed == 0) {
+      response.set_success(false);
+      response.set_message("No subscription " + std::to_string(unwatch.subscription_id()) + " for this client.");
+    } else {
+      response.set_success(true);
+      response.set_message("Ended " + std::to_string(removed) + " subscription(s).");
+    }
+  }
+  return v2::make_response(request, daphne::MT2_UNWATCH_REGISTERS_RESP, response.SerializeAsString());
+}
+
+bool RegisterWatcher::subscribe(const std::string& client_id, const daphne::ControlEnvelopeV2& request,
+                                const daphne::WatchRegistersRequest& watch,
+                                daphne::WatchRegistersResponse& response) {
+  auto fail = [&](const std::string& message) {
+    response.set_success(false);
+    response.set_message(message);
+    response.set_is_final(true);
+    return false;
+  };
+
+  if (watch.fields().empty()) return fail("No fields to watch.");
+  if (static_cast<size_t>(watch.fields_size()) > kMaxFields) {
+    return fail("At most " + std::to_string(kMaxFields) + " fields per subscription.");
+  }
+  const uint32_t period_ms = watch.period_ms() == 0 ? kDefaultPeriodMs : watch.period_ms();
+  if (period_ms < kMinPeriodMs || period_ms > kMaxPeriodMs) {
+    return fail("period_ms must be within " + std::to_string(kMinPeriodMs) + ".." + std::to_string(kMaxPeriodMs) +
+                ".");
+  }
+  const uint32_t keepalive_ms = watch.keepalive_ms() == 0 ? kDefaultKeepaliveMs : watch.keepalive_ms();
+  if (keepalive_ms < kMinKeepaliveMs || keepalive_ms > kMaxKeepaliveMs) {
+    return fail("keepalive_ms must be within " + std::to_string(kMinKeepaliveMs) + ".." +
+                std::to_string(kMaxKeepaliveMs) + ".");
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (subscriptions_.size() >= kMaxSubscriptions) {
+    return fail("Too many register watch subscriptions (" + std::to_string(kMaxSubscriptions) + ").");
+  }
+
+  Subscription sub;
+  for (const auto& field : watch.fields()) {
+    std::string key;
+    std::string error;
+    if (!resolve(field, key, error)) {
+      release(sub);
+      return fail(error);
+    }
+    sub.keys.push_back(key);
+    sub.deadbands.push_back(field.deadband());
+  }
+
+  // Initial values of every field, so the client starts from a known state.
+  const uint64_t now_ns = MonitoringHistory::nowNs();
+  ++cycle_;
+  for (size_t i = 0; i < sub.keys.size(); ++i) {
+    const uint32_t value = read(fields_.at(sub.keys[i]));
+    sub.reported.push_back(value);
+    auto* out = response.add_values();
+    out->set_index(static_cast<uint32_t>(i));
+    out->set_value(value);
+    out->set_timestamp_ns(now_ns);
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  sub.id = next_id_++;
+  sub.client_id = client_id;
+  sub.request = request;
+  sub.request.clear_payload();
+  sub.period = std::chrono::milliseconds(period_ms);
+  sub.keepalive = std::chrono::milliseconds(keepalive_ms);
+  sub.next_poll = now + sub.period;
+  sub.last_sent = now;
+
+  response.set_success(true);
+  response.set_subscription_id(sub.id);
+  response.set_message("Watching " + std::to_string(sub.keys.size()) + " field(s) every " +
+                       std::to_string(period_ms) + " ms (subscription " + std::to_string(sub.id) + ").");
+  subscriptions_.push_back(std::move(sub));
+  wake_.notify_all();
+  return true;
+}
+
+uint32_t RegisterWatcher::unsubscribe(const std::string& client_id, uint64_t subscription_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t removed = 0;
+  auto it = subscriptions_.begin();
+  while (it != subscriptions_.end()) {
+    if (it->client_id != client_id || (subscription_id != 0 && it->id != subscription_id)) {
+      ++it;
+      continue;
+    }
+    daphne::WatchRegistersResponse last;
+    last.set_success(true);
+    last.set_subscription_id(it->id);
+    last.set_message("Subscription ended.");
+    last.set_is_final(true);
+    notify(*it, last);
+    release(*it);
+    it = subscriptions_.erase(it);
+    ++removed;
+  }
+  if (removed > 0) wake_.notify_all();
+  return removed;
+}
+
+void RegisterWatcher::drop_client(const std::string& client_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = subscriptions_.begin();
+  while (it != subscriptions_.end()) {
+    if (it->client_id != client_id) {
+      ++it;
+      continue;
+    }
+    release(*it);
+    it = subscriptions_.erase(it);
+  }
+  outbox_.erase(std::remove_if(outbox_.begin(), outbox_.end(),
+                               [&](const std::pair<std::string, std::string>& item) {
+                                 return item.first == client_id;
+                               }),
+                outbox_.end());
+}
+
+bool RegisterWatcher::resolve(const daphne::WatchedField& field, std::string& key, std::string& error) {
+  key = field.field().empty() ? field.reg() : field.reg() + "." + field.field();
+  const auto cached = fields_.find(key);
+  if (cached != fields_.end()) {
+    cached->second.users++;
+    return true;
+  }
+
+  const auto& registers = reg_dict_.getRegisterMap();
+  const auto reg = registers.find(field.reg());
+  if (reg == registers.end() || reg->second.second.empty()) {
+    error = "Unknown register '" + field.reg() + "'.";
+    return false;
+  }
+  const auto& bit_fields = reg->second.second;
+  WatchedField watched;
+  std::string pointer_field;
+  if (field.field().empty()) {
+    pointer_field = bit_fields.begin()->first;
+    watched.mask = 0xFFFFFFFFu;
+    watched.shift = 0;
+  } else {
+    const auto bits = bit_fields.find(field.field());
+    if (bits == bit_fields.end()) {
+      error = "Unknown field '" + key + "'.";
+      return false;
+    }
+    pointer_field = field.field();
+    const int low = bits->second.first;
+    const int high = bits->second.second;
+    const int width = high - low + 1;
+    watched.mask = width >= 32 ? 0xFFFFFFFFu : ((1u << width) - 1u);
+    watched.shift = static_cast<uint32_t>(low);
+  }
+  watched.address = fpga_reg_.getRegisterPointer(field.reg(), pointer_field, 0);
+  if (!watched.address) {
+    error = "Register '" + field.reg() + "' is not mapped.";
+    return false;
+  }
+  watched.users = 1;
+  fields_.emplace(key, watched);
+  return true;
+}
+
+void RegisterWatcher::release(const Subscription& subscription) {
+  for (const auto& key : subscription.keys) {
+    const auto it = fields_.find(key);
+    if (it != fields_.end() && --it->second.users == 0) fields_.erase(it);
+  }
+}
+
+uint32_t RegisterWatcher::read(WatchedField& field) {
+  if (field.read_cycle != cycle_) {
+    field.value = (*field.address >> field.shift) & field.mask;
+    field.read_cycle = cycle_;
+  }
+  return field.value;
+}
+
+void RegisterWatcher::notify(const Subscription& subscription, const daphne::WatchRegistersResponse& response) {
+  const auto env = v2::make_response(subscription.request, daphne::MT2_WATCH_REGISTERS_RESP, response.SerializeAsString());
+  outbox_.emplace_back(subscription.client_id, env.SerializeAsString());
+}
+
+void RegisterWatcher::run(zmq::context_t& ctx) {
+  zmq::socket_t events(ctx, ZMQ_PUSH);
+  events.set(zmq::sockopt::linger, 0);
+  events.connect(kEventsEndpoint);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    while (!outbox_.empty()) {
+      const auto item = std::move(outbox_.front());
+      outbox_.pop_front();
+      lock.unlock();
+      try {
+        events.send(zmq::buffer(item.first.data(), item.first.size()), zmq::send_flags::sndmore);
+        events.send(zmq::buffer(item.second.data(), item.second.size()), zmq::send_flags::none);
+      } catch (const zmq::error_t& e) {
+        std::cerr << "Register watch send error: " << e.what() << std::endl;
+      }
+      lock.lock();
+    }
+    if (stop_) break;
+
+    // Sleep until the next subscription is due; subscribe/unsubscribe wake us.
+    if (subscriptions_.empty()) {
+      wake_.wait(lock);
+      continue;
+    }
+    auto due = subscriptions_.front().next_poll;
+    for (const auto& sub : subscriptions_) due = std::min(due, sub.next_poll);
+    if (std::chrono::steady_clock::now() < due) {
+      wake_.wait_until(lock, due);
+      continue;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t now_ns = MonitoringHistory::nowNs();
+    ++cycle_;
+    for (auto& sub : subscriptions_) {
+      if (sub.next_poll > now) continue;
+      daphne::WatchRegistersResponse response;
+      for (size_t i = 0; i < sub.keys.size(); ++i) {
+        const uint32_t value = read(fields_.at(sub.keys[i]));
+        if (!moved(value, sub.reported[i], sub.deadbands[i])) continue;
+        sub.reported[i] = value;
+        auto* out = response.add_values();
+        out->set_index(static_cast<uint32_t>(i));
+        out->set_value(value);
+        out->set_timestamp_ns(now_ns);
+      }
+      // An empty message doubles as a keepalive: it tells the client the
+      // subscription is alive and lets the router notice a vanished client.
+      if (response.values_size() > 0 || now - sub.last_sent >= sub.keepalive) {
+        response.set_success(true);
+        response.set_subscription_id(sub.id);
+        notify(sub, response);
+        sub.last_sent = now;
+      }
+      sub.next_poll += sub.period;
+      if (sub.next_poll <= now) sub.next_poll = now + sub.period;
+    }
+  }
+}
+
+}  // namespace daphne_sc
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <zmq.hpp>
+
+#include "FpgaReg.hpp"
+#include "FpgaRegDict.hpp"
+#include "daphneV3_high_level_confs.pb.h"
+
+class Daphne;
+
+namespace daphne_sc {
+
+// Register watch subscriptions (MT2_WATCH_REGISTERS_REQ). One poller thread
+// reads the watched fields through the Daphne instance's frontend FpgaReg
+// mapping, so no second mapping of the window is opened; a field watched
+// by several subscriptions is read once per poll cycle. Each subscription gets
+// its changes (beyond its deadbands) as further MT2_WATCH_REGISTERS_RESP
+// messages on the request's task, plus an empty keepalive when nothing
+// changed for a while. Messages are handed to the router thread over an
+// inproc PUSH socket; the router owns the ROUTER socket and calls
+// drop_client() when a peer turns out to be gone.
+class RegisterWatcher {
+ public:
+  // The router binds a PULL socket here before constructing the watcher.
+  // Each message is two frames: client identity and a serialized envelope.
+  static constexpr const char* kEventsEndpoint = "inproc://daphne-register-watch";
+  static constexpr size_t kMaxSubscriptions = 64;
+  static constexpr size_t kMaxFields = 64;  // per subscription
+
+  // daphne must outlive the watcher (register pointers are cached).
+  RegisterWatcher(zmq::context_t& ctx, Daphne& daphne);
+  ~RegisterWatcher();
+
+  // Handles MT2_WATCH_REGISTERS_REQ and MT2_UNWATCH_REGISTERS_REQ from
+  // client_id and returns the response envelope.
+  daphne::ControlEnvelopeV2 handle(const std::string& client_id, const daphne::ControlEnvelopeV2& request);
+
+  // Ends every subscription of client_id without a final message.
+  void drop_client(const std::string& client_id);
+
+ private:
+  struct WatchedField {
+    const volatile uint32_t* address = nullptr;
+    uint32_t mask = 0;
+    uint32_t shift = 0;
+    uint32_t users = 0;
+    uint64_t read_cycle = 0;  // poll cycle of the cached value
+    uint32_t value = 0;
+  };
+
+  struct Subscription {
+    uint64_t id = 0;
+    std::string client_id;
+    daphne::ControlEnvelopeV2 request;  // payload cleared; used to address the notifications
+    std::vector<std::string> keys;      // into fields_
+    std::vector<uint32_t> deadbands;
+    std::vector<uint32_t> reported;
+    std::chrono::milliseconds period{100};
+    std::chrono::milliseconds keepalive{10000};
+    std::chrono::steady_clock::time_point next_poll;
+    std::chrono::steady_clock::time_point last_sent;
+  };
+
+  bool subscribe(const std::string& client_id, const daphne::ControlEnvelopeV2& request,
+                 const daphne::WatchRegistersRequest& watch, daphne::WatchRegistersResponse& response);
+  uint32_t unsubscribe(const std::string& client_id, uint64_t subscription_id);
+
+  // Caller holds mutex_.
+  bool resolve(const daphne::WatchedField& field, std::string& key, std::string& error);
+  void release(const Subscription& subscription);
+  uint32_t read(WatchedField& field);
+  void notify(const Subscription& subscription, const daphne::WatchRegistersResponse& response);
+
+  void run(zmq::context_t& ctx);
+
+  FpgaReg& fpga_reg_;
+  FpgaRegDict reg_dict_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+  uint64_t next_id_ = 1;
+  uint64_t cycle_ = 0;
+  std::unordered_map<std::string, WatchedField> fields_;
+  std::vector<Subscription> subscriptions_;
+  std::deque<std::pair<std::string, std::string>> outbox_;
+
+  std::thread thread_;
+};
+
+}  // namespace daphne_sc
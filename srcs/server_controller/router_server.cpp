@@ -1,5 +1,6 @@
 #include "server_controller/router_server.hpp"
 
+#include <cerrno>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -7,17 +8,20 @@
 
 #include "Daphne.hpp"
 #include "daphneV3_high_level_confs.pb.h"
+#include "server_controller/parameter_sweep.hpp"
+#include "server_controller/register_watch.hpp"
 #include "server_controller/spybuffer_chunker.hpp"
 #include "server_controller/v2_envelope.hpp"
 
 namespace daphne_sc {
 namespace {
 
-bool recv_multipart(zmq::socket_t& sock, std::vector<zmq::message_t>& frames) {
+bool recv_multipart(zmq::socket_t& sock, std::vector<zmq::message_t>& frames,
+                    zmq::recv_flags flags = zmq::recv_flags::none) {
   frames.clear();
   while (true) {
     zmq::message_t part;
-    if (!sock.recv(part, zmq::recv_flags::none)) return false;
+    if (!sock.recv(part, frames.empty() ? flags : zmq::recv_flags::none)) return false;
     frames.emplace_back(std::move(part));
     const bool more = sock.get(zmq::sockopt::rcvmore);
     if (!more) break;
@@ -25,9 +29,33 @@ bool recv_multipart(zmq::socket_t& sock, std::vector<zmq::message_t>& frames) {
   return true;
 }
 
-void send_to(zmq::socket_t& router, const std::string& client_id, const std::string& bytes) {
-  router.send(zmq::buffer(client_id.data(), client_id.size()), zmq::send_flags::sndmore);
-  router.send(zmq::buffer(bytes.data(), bytes.size()), zmq::send_flags::none);
+// ROUTER_MANDATORY is set, so a message to a peer that has disconnected
+// fails here instead of being dropped silently; false means the peer is gone.
+// Sends never wait: a client at its HWM loses the message instead of stalling
+// the loop for every other client.
+bool send_to(zmq::socket_t& router, const std::string& client_id, const std::string& bytes) {
+  try {
+    if (!router.send(zmq::buffer(client_id.data(), client_id.size()),
+                     zmq::send_flags::dontwait | zmq::send_flags::sndmore)) {
+      return true;  // EAGAIN at the HWM: this message is lost, the peer is not
+    }
+    router.send(zmq::buffer(bytes.data(), bytes.size()), zmq::send_flags::dontwait);
+    return true;
+  } catch (const zmq::error_t& e) {
+    if (e.num() == EHOSTUNREACH) return false;
+    throw;
+  }
+}
+
+// Forwards the register watch notifications queued on the inproc socket.
+void forward_watch_events(zmq::socket_t& events, zmq::socket_t& router, RegisterWatcher& watcher) {
+  std::vector<zmq::message_t> frames;
+  while (recv_multipart(events, frames, zmq::recv_flags::dontwait)) {
+    if (frames.size() != 2) continue;
+    const std::string client_id(static_cast<const char*>(frames[0].data()), frames[0].size());
+    const std::string bytes(static_cast<const char*>(frames[1].data()), frames[1].size());
+    if (!send_to(router, client_id, bytes)) watcher.drop_client(client_id);
+  }
 }
 
 }  // namespace
@@ -43,9 +71,23 @@ void run_router_server(zmq::context_t& ctx,
   router.set(zmq::sockopt::rcvhwm, options.rcvhwm);
   router.set(zmq::sockopt::sndbuf, options.sndbuf);
   router.set(zmq::sockopt::immediate, options.immediate ? 1 : 0);
+  router.set(zmq::sockopt::router_mandatory, 1);
   router.bind(bind_endpoint);
 
+  zmq::socket_t watch_events(ctx, ZMQ_PULL);
+  watch_events.bind(RegisterWatcher::kEventsEndpoint);
+  RegisterWatcher watcher(ctx, daphne);
+
+  zmq::pollitem_t items[] = {
+      {router.handle(), 0, ZMQ_POLLIN, 0},
+      {watch_events.handle(), 0, ZMQ_POLLIN, 0},
+  };
+
   while (true) {
+    zmq::poll(items, 2, std::chrono::milliseconds(-1));
+    if (items[1].revents & ZMQ_POLLIN) forward_watch_events(watch_events, router, watcher);
+    if (!(items[0].revents & ZMQ_POLLIN)) continue;
+
     std::vector<zmq::message_t> frames;
     if (!recv_multipart(router, frames)) continue;
     if (frames.size() < 2) continue;
@@ -85,10 +127,12 @@ void run_router_server(zmq::context_t& ctx,
         continue;
       }
 
+      bool connected = true;
       try {
         for_each_spybuffer_chunk(chunk_req, daphne, [&](const daphne::DumpSpyBuffersChunkResponse& resp) {
+          if (!connected) return;
           const auto env = v2::make_response(req, daphne::MT2_DUMP_SPYBUFFER_CHUNK_RESP, resp.SerializeAsString());
-          send_to(router, client_id, env.SerializeAsString());
+          connected = send_to(router, client_id, env.SerializeAsString());
         });
       } catch (const std::exception& e) {
         daphne::DumpSpyBuffersChunkResponse chunk_resp;
@@ -96,9 +140,46 @@ void run_router_server(zmq::context_t& ctx,
         chunk_resp.set_message(std::string("Chunked dump failed: ") + e.what());
         chunk_resp.set_isfinal(true);
         const auto env = v2::make_response(req, daphne::MT2_DUMP_SPYBUFFER_CHUNK_RESP, chunk_resp.SerializeAsString());
+        connected = connected && send_to(router, client_id, env.SerializeAsString());
+      }
+      if (!connected) watcher.drop_client(client_id);
+      continue;
+    }
+
+    if (req.type() == daphne::MT2_WATCH_REGISTERS_REQ || req.type() == daphne::MT2_UNWATCH_REGISTERS_REQ) {
+      send_to(router, client_id, watcher.handle(client_id, req).SerializeAsString());
+      continue;
+    }
+
+    if (req.type() == daphne::MT2_RUN_SWEEP_REQ) {
+      daphne::RunSweepRequest sweep_req;
+      if (!sweep_req.ParseFromString(req.payload())) {
+        daphne::RunSweepResponse sweep_resp;
+        sweep_resp.set_success(false);
+        sweep_resp.set_message("Bad RunSweepRequest payload");
+        sweep_resp.set_is_final(true);
+        const auto env = v2::make_response(req, daphne::MT2_RUN_SWEEP_RESP, sweep_resp.SerializeAsString());
         send_to(router, client_id, env.SerializeAsString());
+        continue;
       }
 
+      bool connected = true;
+      try {
+        for_each_sweep_point(sweep_req, daphne, [&](const daphne::RunSweepResponse& resp) {
+          if (!connected) return;
+          const auto env = v2::make_response(req, daphne::MT2_RUN_SWEEP_RESP, resp.SerializeAsString());
+          connected = send_to(router, client_id, env.SerializeAsString());
+        });
+      } catch (const std::exception& e) {
+        daphne::RunSweepResponse sweep_resp;
+        sweep_resp.set_success(false);
+        sweep_resp.set_request_id(sweep_req.request_id());
+        sweep_resp.set_message(std::string("Sweep failed: ") + e.what());
+        sweep_resp.set_is_final(true);
+        const auto env = v2::make_response(req, daphne::MT2_RUN_SWEEP_RESP, sweep_resp.SerializeAsString());
+        connected = connected && send_to(router, client_id, env.SerializeAsString());
+      }
+      if (!connected) watcher.drop_client(client_id);
       continue;
     }
 
@@ -121,7 +202,7 @@ void run_router_server(zmq::context_t& ctx,
     }
 
     const auto env = v2::make_response(req, v2::response_type(req.type()), std::move(resp_payload));
-    send_to(router, client_id, env.SerializeAsString());
+    if (!send_to(router, client_id, env.SerializeAsString())) watcher.drop_client(client_id);
   }
 }
 
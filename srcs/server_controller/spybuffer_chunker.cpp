@@ -12,6 +12,7 @@
 #include "Daphne.hpp"
 #include "defines.hpp"
 #include "daphneV3_high_level_confs.pb.h"
+#include "server_controller/acquisition_guard.hpp"
 #include "server_controller/bounded_queue.hpp"
 
 namespace daphne_sc {
@@ -65,6 +66,7 @@ void for_each_spybuffer_chunk(
     std::vector<uint32_t> data;
   };
 
+  ClientAcquisitionGuard acquisition(daphne);
   BoundedQueue<ChunkPacket> queue(2);
   std::atomic<bool> had_error(false);
 
@@ -0,0 +1,165 @@
+#include "server_controller/telemetry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "daphneV3_high_level_confs.pb.h"
+
+namespace daphne_sc {
+namespace {
+
+bool moved(double value, double last, double deadband) {
+  return std::fabs(value - last) > deadband;
+}
+
+bool rails_changed(const HDMezzRails& r, const HDMezzRails& last, const TelemetryOptions& options) {
+  if (r.enabled != last.enabled || r.powered5V != last.powered5V || r.powered3V3 != last.powered3V3 ||
+      r.alert5V != last.alert5V || r.alert3V3 != last.alert3V3) {
+    return true;
+  }
+  if (!r.enabled) return false;
+  return moved(r.voltage5V, last.voltage5V, options.voltage_deadband_v) ||
+         moved(r.voltage3V3, last.voltage3V3, options.voltage_deadband_v) ||
+         moved(r.current5V, last.current5V, options.current_deadband_a) ||
+         moved(r.current3V3, last.current3V3, options.current_deadband_a) ||
+         moved(r.power5V, last.power5V, options.power_deadband_w) ||
+         moved(r.power3V3, last.power3V3, options.power_deadband_w);
+}
+
+}  // namespace
+
+TelemetryPublisher::TelemetryPublisher(zmq::context_t& ctx, const TelemetryOptions& options)
+    : options_(options), socket_(ctx, ZMQ_PUB) {
+  socket_.set(zmq::sockopt::linger, 0);
+  socket_.set(zmq::sockopt::sndhwm, options_.sndhwm);
+  socket_.bind(options_.bind_endpoint);
+}
+
+bool TelemetryPublisher::due(Topic& topic, bool changed, uint64_t now_ns) const {
+  const uint64_t heartbeat_ns =
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(options_.heartbeat).count());
+  const bool first = topic.sequence == 0;
+  const bool stale = heartbeat_ns > 0 && now_ns - topic.last_ns >= heartbeat_ns;
+  if (!first && !changed && !stale) return false;
+  ++topic.sequence;
+  topic.last_ns = now_ns;
+  return true;
+}
+
+void TelemetryPublisher::send(const char* topic, const google::protobuf::MessageLite& message) {
+  std::string bytes;
+  if (!message.SerializeToString(&bytes)) return;
+  try {
+    // PUB drops at the HWM instead of blocking, so dontwait only guards
+    // against a full kernel buffer.
+    socket_.send(zmq::buffer(topic, std::strlen(topic)), zmq::send_flags::sndmore | zmq::send_flags::dontwait);
+    socket_.send(zmq::buffer(bytes.data(), bytes.size()), zmq::send_flags::dontwait);
+  } catch (const zmq::error_t& e) {
+    std::cerr << "Telemetry publish error (" << topic << "): " << e.what() << std::endl;
+  }
+}
+
+void TelemetryPublisher::publish_rails(const MonitoringSnapshot& snapshot) {
+  const std::array<double, 5> rails = {snapshot.v3V3PDS, snapshot.v1V8PDS, snapshot.v3V3A, snapshot.v1V8A,
+                                       snapshot.vn5VA};
+  const uint64_t now_ns = snapshot.railsCycleNs;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool changed = false;
+  for (size_t i = 0; i < rails.size(); ++i) {
+    changed = changed || moved(rails[i], rails_[i], options_.voltage_deadband_v);
+  }
+  if (due(rails_topic_, changed, now_ns)) {
+    rails_ = rails;
+    daphne::TelemetryRails message;
+    message.set_sequence(rails_topic_.sequence);
+    message.set_timestamp_ns(now_ns);
+    message.set_v_3v3pds(snapshot.v3V3PDS);
+    message.set_v_1v8pds(snapshot.v1V8PDS);
+    message.set_v_3v3a(snapshot.v3V3A);
+    message.set_v_1v8a(snapshot.v1V8A);
+    message.set_v_n5va(snapshot.vn5VA);
+    send("rails", message);
+  }
+
+  changed = false;
+  for (size_t afe = 0; afe < snapshot.vBias.size(); ++afe) {
+    changed = changed || moved(snapshot.vBias[afe], vbias_[afe], options_.voltage_deadband_v);
+  }
+  if (due(vbias_topic_, changed, now_ns)) {
+    vbias_ = snapshot.vBias;
+    daphne::TelemetryVbias message;
+    message.set_sequence(vbias_topic_.sequence);
+    message.set_timestamp_ns(now_ns);
+    for (const double v : snapshot.vBias) message.add_v_bias(v);
+    send("vbias", message);
+  }
+}
+
+void TelemetryPublisher::publish_hdmezz(const MonitoringSnapshot& snapshot) {
+  const uint64_t now_ns = snapshot.hdmezzCycleNs;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool changed = false;
+  for (size_t afe = 0; afe < snapshot.hdmezz.size(); ++afe) {
+    changed = changed || rails_changed(snapshot.hdmezz[afe], hdmezz_[afe], options_);
+  }
+  if (!due(hdmezz_topic_, changed, now_ns)) return;
+  hdmezz_ = snapshot.hdmezz;
+
+  daphne::TelemetryHDMezz message;
+  message.set_sequence(hdmezz_topic_.sequence);
+  message.set_timestamp_ns(now_ns);
+  for (uint32_t afe = 0; afe < snapshot.hdmezz.size(); ++afe) {
+    const HDMezzRails& rails = snapshot.hdmezz[afe];
+    auto* out = message.add_hdmezz();
+    out->set_afe(afe);
+    out->set_enabled(rails.enabled);
+    out->set_powered_5v(rails.powered5V);
+    out->set_powered_3v3(rails.powered3V3);
+    out->set_voltage_5v(rails.voltage5V);
+    out->set_current_5v(rails.current5V);
+    out->set_power_5v(rails.power5V);
+    out->set_voltage_3v3(rails.voltage3V3);
+    out->set_current_3v3(rails.current3V3);
+    out->set_power_3v3(rails.power3V3);
+    out->set_alert_5v(rails.alert5V);
+    out->set_alert_3v3(rails.alert3V3);
+  }
+  send("hdmezz", message);
+}
+
+void TelemetryPublisher::publish_triggers(const TriggerCounterSample& sample) {
+  // The first sample after a (re)start carries no rates.
+  if (sample.interval_s <= 0.0) return;
+  auto rate_moved = [&](float value, float last) {
+    const double deadband = std::max(options_.rate_deadband_hz, options_.rate_deadband * std::fabs(last));
+    return moved(value, last, deadband);
+  };
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool changed = false;
+  for (size_t ch = 0; ch < sample.record_rate.size() && !changed; ++ch) {
+    changed = rate_moved(sample.record_rate[ch], record_rate_[ch]) ||
+              rate_moved(sample.busy_rate[ch], busy_rate_[ch]) || rate_moved(sample.full_rate[ch], full_rate_[ch]);
+  }
+  if (!due(triggers_topic_, changed, sample.timestamp_ns)) return;
+  record_rate_ = sample.record_rate;
+  busy_rate_ = sample.busy_rate;
+  full_rate_ = sample.full_rate;
+
+  daphne::TelemetryTriggers message;
+  message.set_sequence(triggers_topic_.sequence);
+  message.set_timestamp_ns(sample.timestamp_ns);
+  message.set_interval_s(sample.interval_s);
+  for (size_t ch = 0; ch < sample.record_rate.size(); ++ch) {
+    message.add_record_rate_hz(sample.record_rate[ch]);
+    message.add_busy_rate_hz(sample.busy_rate[ch]);
+    message.add_full_rate_hz(sample.full_rate[ch]);
+  }
+  send("triggers", message);
+}
+
+}  // namespace daphne_sc
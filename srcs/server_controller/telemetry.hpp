@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <zmq.hpp>
+
+#include "MonitoringHistory.hpp"
+#include "MonitoringSnapshot.hpp"
+
+namespace google {
+namespace protobuf {
+class MessageLite;
+}  // namespace protobuf
+}  // namespace google
+
+namespace daphne_sc {
+
+struct TelemetryOptions {
+  std::string bind_endpoint;  // empty disables the publisher
+  // A topic is published when one of its values moved by more than its
+  // deadband since the last publication, or when a flag changed.
+  double voltage_deadband_v = 0.01;
+  double current_deadband_a = 0.005;
+  double power_deadband_w = 0.05;
+  double rate_deadband = 0.05;      // fraction of the last published rate
+  double rate_deadband_hz = 1.0;    // absolute floor of the rate deadband
+  // Unchanged topics are still published this often, so late subscribers get
+  // values. Zero publishes only on change.
+  std::chrono::milliseconds heartbeat{10000};
+  int sndhwm = 1000;
+};
+
+// PUB socket fed by the monitor threads. Each publication is two frames: the
+// topic ("rails", "vbias", "hdmezz", "triggers") and a Telemetry* protobuf.
+// Sends never block; a slow subscriber loses messages at its HWM.
+class TelemetryPublisher {
+ public:
+  TelemetryPublisher(zmq::context_t& ctx, const TelemetryOptions& options);
+
+  // Rails and bias come from the I2C_1 part of the snapshot, HD mezzanine
+  // rails from the I2C_2 part.
+  void publish_rails(const MonitoringSnapshot& snapshot);
+  void publish_hdmezz(const MonitoringSnapshot& snapshot);
+  void publish_triggers(const TriggerCounterSample& sample);
+
+ private:
+  struct Topic {
+    uint64_t sequence = 0;
+    uint64_t last_ns = 0;
+  };
+
+  // Caller holds mutex_. Bumps the topic when it is due.
+  bool due(Topic& topic, bool changed, uint64_t now_ns) const;
+  void send(const char* topic, const google::protobuf::MessageLite& message);
+
+  TelemetryOptions options_;
+  std::mutex mutex_;
+  zmq::socket_t socket_;
+
+  Topic rails_topic_;
+  Topic vbias_topic_;
+  Topic hdmezz_topic_;
+  Topic triggers_topic_;
+  std::array<double, 5> rails_{};
+  std::array<double, 5> vbias_{};
+  std::array<HDMezzRails, 5> hdmezz_{};
+  std::array<float, 40> record_rate_{};
+  std::array<float, 40> busy_rate_{};
+  std::array<float, 40> full_rate_{};
+};
+
+}  // namespace daphne_sc
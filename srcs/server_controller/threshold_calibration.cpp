@@ -0,0 +1,207 @@
+#include "server_controller/threshold_calibration.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Daphne.hpp"
+#include "TriggerBlock.hpp"
+#include "daphneV3_high_level_confs.pb.h"
+
+namespace daphne_sc {
+
+namespace {
+
+constexpr uint32_t kDefaultDwellMs = 200;
+constexpr uint32_t kMaxDwellMs = 10000;
+constexpr uint32_t kDefaultMaxIterations = 32;
+constexpr uint32_t kMaxIterations = 64;
+// The server loop is blocked for the whole run: cap the dwell time it can take.
+constexpr uint64_t kMaxRunMs = 60000;
+
+struct ChannelSearch {
+  uint32_t channel = 0;
+  double target = 0.0;
+  uint32_t lo = 0;  // rate known (or assumed) above target below lo
+  uint32_t hi = 0;  // rate known (or assumed) at or below target from hi up
+  daphne::ThresholdCalibrationResult* result = nullptr;
+};
+
+struct RateReading {
+  double rate_hz = 0.0;
+  uint64_t counts = 0;
+};
+
+// Programs the thresholds, then counts records over one dwell.
+std::vector<RateReading> measure(TriggerBlock& block,
+                                 const std::vector<std::pair<uint32_t, uint32_t>>& thresholds,
+                                 std::chrono::milliseconds dwell) {
+  const std::vector<uint32_t> mismatches = block.setThresholds(thresholds);
+  if (!mismatches.empty()) {
+    throw std::runtime_error("threshold read-back mismatch on channel " + std::to_string(mismatches.front()));
+  }
+  const auto before = block.getAllCounters();
+  const auto t0 = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(dwell);
+  const auto after = block.getAllCounters();
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  std::vector<RateReading> readings;
+  readings.reserve(thresholds.size());
+  for (const auto& threshold : thresholds) {
+    const uint32_t ch = threshold.first;
+    RateReading reading;
+    // A counter that went backwards was reset during the dwell: count from zero.
+    reading.counts = after[ch].record >= before[ch].record ? after[ch].record - before[ch].record : after[ch].record;
+    reading.rate_hz = seconds > 0.0 ? static_cast<double>(reading.counts) / seconds : 0.0;
+    readings.push_back(reading);
+  }
+  return readings;
+}
+
+void add_point(daphne::ThresholdCalibrationResult* result, uint32_t threshold, const RateReading& reading) {
+  auto* point = result->add_points();
+  point->set_threshold(threshold);
+  point->set_rate_hz(reading.rate_hz);
+  point->set_counts(reading.counts);
+}
+
+}  // namespace
+
+std::string calibrate_thresholds(const daphne::CalibrateThresholdsRequest& request,
+                                 Daphne& daphne,
+                                 daphne::CalibrateThresholdsResponse& response) {
+  if (request.targets_size() == 0) throw std::invalid_argument("no channels to calibrate");
+  const uint32_t dwell_ms = request.dwell_ms() == 0 ? kDefaultDwellMs : request.dwell_ms();
+  if (dwell_ms > kMaxDwellMs) throw std::invalid_argument("dwell_ms above 10000");
+  const uint32_t min_threshold = request.min_threshold();
+  const uint32_t max_threshold = request.max_threshold() == 0 ? TriggerBlock::kThresholdMask : request.max_threshold();
+  if (max_threshold > TriggerBlock::kThresholdMask || min_threshold > max_threshold) {
+    throw std::invalid_argument("threshold bounds must satisfy min <= max <= 0x0FFFFFFF");
+  }
+  const uint32_t tolerance = std::max<uint32_t>(request.tolerance(), 1);
+  const uint32_t max_iterations = request.max_iterations() == 0 ? kDefaultMaxIterations : request.max_iterations();
+  if (max_iterations > kMaxIterations) throw std::invalid_argument("max_iterations above 64");
+  // Each step at least halves the bracket, so the search ends before max_iterations on narrow ranges.
+  uint32_t steps = 0;
+  for (uint32_t width = max_threshold - min_threshold; width >= tolerance && steps < max_iterations; width /= 2) {
+    ++steps;
+  }
+  const uint64_t run_ms = static_cast<uint64_t>(steps + 1) * dwell_ms;  // plus the confirming dwell
+  if (run_ms > kMaxRunMs) {
+    throw std::invalid_argument("calibration would dwell " + std::to_string(run_ms) +
+                                " ms, above 60000; raise tolerance or lower dwell_ms/max_iterations");
+  }
+
+  std::vector<ChannelSearch> searches;
+  uint64_t channel_bits = 0;
+  for (const auto& target : request.targets()) {
+    if (target.channel() >= TriggerBlock::kNumChannels) {
+      throw std::invalid_argument("channel out of range (0..39): " + std::to_string(target.channel()));
+    }
+    if (channel_bits & (1ULL << target.channel())) {
+      throw std::invalid_argument("channel listed twice: " + std::to_string(target.channel()));
+    }
+    if (!std::isfinite(target.target_rate_hz()) || target.target_rate_hz() < 0.0) {
+      throw std::invalid_argument("bad target rate for channel " + std::to_string(target.channel()));
+    }
+    channel_bits |= 1ULL << target.channel();
+    ChannelSearch search;
+    search.channel = target.channel();
+    search.target = target.target_rate_hz();
+    search.lo = min_threshold;
+    search.hi = max_threshold;
+    searches.push_back(search);
+  }
+  for (auto& search : searches) {
+    search.result = response.add_results();
+    search.result->set_channel(search.channel);
+    search.result->set_target_rate_hz(search.target);
+  }
+
+  TriggerBlock& block = *daphne.getTriggerBlock();
+  const auto dwell = std::chrono::milliseconds(dwell_ms);
+  const auto t0 = std::chrono::steady_clock::now();
+  const std::array<uint32_t, TriggerBlock::kNumChannels> original_thresholds = block.getThresholds();
+  const uint64_t original_mask = block.getEnableMask();
+
+  auto restore = [&](bool thresholds) {
+    if (thresholds) {
+      std::vector<std::pair<uint32_t, uint32_t>> previous;
+      for (const auto& search : searches) previous.emplace_back(search.channel, original_thresholds[search.channel]);
+      block.setThresholds(previous);
+    }
+    block.setEnableMask(original_mask);
+  };
+
+  uint32_t iterations = 0;
+  try {
+    block.setEnableMask(original_mask | channel_bits);
+
+    while (iterations < max_iterations) {
+      std::vector<size_t> active;
+      std::vector<std::pair<uint32_t, uint32_t>> thresholds;
+      for (size_t i = 0; i < searches.size(); ++i) {
+        if (searches[i].hi - searches[i].lo < tolerance) continue;
+        active.push_back(i);
+        thresholds.emplace_back(searches[i].channel, searches[i].lo + (searches[i].hi - searches[i].lo) / 2);
+      }
+      if (active.empty()) break;
+      ++iterations;
+
+      const std::vector<RateReading> readings = measure(block, thresholds, dwell);
+      for (size_t k = 0; k < active.size(); ++k) {
+        ChannelSearch& search = searches[active[k]];
+        const uint32_t mid = thresholds[k].second;
+        add_point(search.result, mid, readings[k]);
+        if (readings[k].rate_hz > search.target) {
+          search.lo = mid + 1;
+        } else {
+          search.hi = mid;
+        }
+      }
+    }
+
+    // One final dwell at the chosen thresholds confirms the rates.
+    std::vector<std::pair<uint32_t, uint32_t>> final_thresholds;
+    for (const auto& search : searches) final_thresholds.emplace_back(search.channel, search.hi);
+    const std::vector<RateReading> readings = measure(block, final_thresholds, dwell);
+    for (size_t i = 0; i < searches.size(); ++i) {
+      ChannelSearch& search = searches[i];
+      add_point(search.result, search.hi, readings[i]);
+      search.result->set_threshold(search.hi);
+      search.result->set_rate_hz(readings[i].rate_hz);
+      search.result->set_converged(search.hi - search.lo < tolerance && readings[i].rate_hz <= search.target);
+    }
+    restore(request.dry_run());
+  } catch (...) {
+    try {
+      restore(true);
+    } catch (...) {
+    }
+    throw;
+  }
+
+  const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  response.set_iterations(iterations);
+  response.set_elapsed_s(elapsed_s);
+
+  size_t converged = 0;
+  for (const auto& result : response.results()) {
+    if (result.converged()) ++converged;
+  }
+  std::ostringstream os;
+  os << converged << "/" << searches.size() << " channel(s) converged in " << iterations << " step(s), "
+     << elapsed_s << " s" << (request.dry_run() ? "; previous thresholds restored (dry run)." : ".");
+  return os.str();
+}
+
+}  // namespace daphne_sc
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+class Daphne;
+
+namespace daphne {
+class CalibrateThresholdsRequest;
+class CalibrateThresholdsResponse;
+}  // namespace daphne
+
+namespace daphne_sc {
+
+// Bisects the self-trigger threshold of every requested channel towards its
+// target record rate. All channels step together: one dwell measures every
+// channel's record_count delta at its own midpoint. The rate is assumed not to
+// increase with the threshold. Requested channels are enabled in the trigger
+// mask during the run; the mask is restored afterwards, as are the thresholds
+// when dry_run is set or on error. Returns a one-line summary. Throws
+// std::invalid_argument on malformed requests, including ones whose dwells
+// (steps needed plus the confirming one, times dwell_ms) exceed 60 s.
+std::string calibrate_thresholds(const daphne::CalibrateThresholdsRequest& request,
+                                 Daphne& daphne,
+                                 daphne::CalibrateThresholdsResponse& response);
+
+}  // namespace daphne_sc